@@ -35,6 +35,22 @@ common:
 	# addon
 	# ADDON_CFLAGS =
 
+	# ofxSonyCameraJpegDecoder loads libturbojpeg at runtime and falls back to
+	# FreeImage without it; to link libturbojpeg instead, define
+	# OFX_SONY_CAMERA_USE_TURBOJPEG, e.g.
+	# ADDON_CFLAGS += -DOFX_SONY_CAMERA_USE_TURBOJPEG
+	# ADDON_LDFLAGS += -lturbojpeg
+	# or to always decode with FreeImage, define OFX_SONY_CAMERA_NO_TURBOJPEG
+	# ADDON_CFLAGS += -DOFX_SONY_CAMERA_NO_TURBOJPEG
+
+	# SDK calls are timed into ofxSonyCameraMetrics histograms; to compile
+	# the timing out entirely, define OFX_SONY_CAMERA_NO_METRICS
+	# ADDON_CFLAGS += -DOFX_SONY_CAMERA_NO_METRICS
+
+	# the addon logs through ofxSonyCameraLog; to compile out messages below
+	# a level, define OFX_SONY_CAMERA_LOG_LEVEL, e.g.
+	# ADDON_CFLAGS += -DOFX_SONY_CAMERA_LOG_LEVEL=OF_LOG_WARNING
+
 	# any special flag that should be passed to the linker when using this
 	# addon, also used for system libraries with -lname
 	# ADDON_LDFLAGS =
@@ -92,3 +108,8 @@ linux:
 
 linux64:
 	# 64-bit Linux-specific configurations would go here
+
+	# only the macOS SDK libraries are set up here; to run simulated or
+	# replayed cameras without any, e.g. for benchmarks on CI, define
+	# OFX_SONY_CAMERA_NO_SDK (the SDK's headers are still needed)
+	# ADDON_CFLAGS += -DOFX_SONY_CAMERA_NO_SDK
@@ -0,0 +1,103 @@
+#include "ofMain.h"
+#include "ofxSonyCameraRemote.h"
+#include "ofxSonyCameraSimulatedBackend.h"
+#include <algorithm>
+#include <chrono>
+
+// Times the calls an app makes every frame against a simulated camera with
+// no latency, so the numbers are the addon's own overhead. Needs no camera
+// and no SDK libraries: build it with OFX_SONY_CAMERA_NO_SDK on a machine
+// that has neither.
+//
+// usage: hotPaths [iterations]
+
+namespace {
+    const std::string kCameraId = "BENCH";
+
+    template<typename Function>
+    void measure(const std::string& label, int iterations, Function function) {
+        std::vector<double> micros;
+        micros.reserve(iterations);
+        for (int i = 0; i < iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            function(i);
+            micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        std::sort(micros.begin(), micros.end());
+        double mean = 0;
+        for (double sample : micros) {
+            mean += sample;
+        }
+        mean /= micros.size();
+        printf("%-32s mean %9.2f us  p50 %9.2f us  p99 %9.2f us\n", label.c_str(), mean,
+               micros[micros.size() / 2], micros[std::min(micros.size() - 1, micros.size() * 99 / 100)]);
+    }
+}
+
+//========================================================================
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::max(ofToInt(argv[1]), 1) : 10000;
+
+    ofxSonyCameraSimulatedBackend::Settings settings;
+    settings.propertyApplyMicros = 0;
+    auto simulator = std::make_shared<ofxSonyCameraSimulatedBackend>(settings);
+    simulator->addCamera(ofxSonyCameraSimulatedBackend::makeCamera(kCameraId));
+
+    ofxSonyCameraRemote camera;
+    camera.setBackend(simulator);
+    if (!camera.setup() || !camera.enumerateDevices() || !camera.connect(0)) {
+        printf("Failed to connect to the simulated camera\n");
+        return 1;
+    }
+
+    // Send every write instead of holding it back until the last one is confirmed
+    ofxSonyCameraWriteQueue::Settings writeSettings;
+    writeSettings.waitForConfirm = false;
+    camera.setWriteQueueSettings(writeSettings);
+
+    printf("%d iterations\n", iterations);
+
+    CrInt64u value;
+    measure("getProperty, cached", iterations, [&](int) {
+        camera.getProperty(SCRSDK::CrDeviceProperty_FNumber, value);
+    });
+
+    const std::vector<CrInt32u> codes = {
+        SCRSDK::CrDeviceProperty_FNumber,
+        SCRSDK::CrDeviceProperty_ShutterSpeed,
+        SCRSDK::CrDeviceProperty_IsoSensitivity
+    };
+    std::vector<CrInt64u> values;
+    measure("getProperties, 3 cached", iterations, [&](int) {
+        camera.getProperties(codes, values);
+    });
+
+    measure("pollEvents, nothing pending", iterations, [&](int) {
+        camera.pollEvents();
+    });
+
+    // Through the command thread and back, alternating so every write changes
+    // the value. Events queued meanwhile and not polled are dropped, which
+    // doesn't affect the cache
+    measure("setProperty", iterations, [&](int i) {
+        camera.setProperty(SCRSDK::CrDeviceProperty_IsoSensitivity, i % 2 ? 200 : 400);
+    });
+    camera.pollEvents();
+
+    // From the camera's notification until getProperty() returns the new value
+    measure("camera change until cached", iterations, [&](int i) {
+        CrInt64u target = i % 2 ? 560 : 800;
+        simulator->changeProperty(kCameraId, SCRSDK::CrDeviceProperty_FNumber, target);
+        while (!camera.getProperty(SCRSDK::CrDeviceProperty_FNumber, value) || value != target) {
+            std::this_thread::yield();
+        }
+    });
+
+    camera.exit();
+
+    auto stats = simulator->getStats();
+    printf("%llu simulated calls, %llu notifications\n",
+           (unsigned long long)stats.calls, (unsigned long long)stats.callbacks);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "ofMain.h"
+#include "ofxSonyCameraJpegDecoder.h"
+#include <chrono>
+
+// Decodes every JPEG in a directory, on the calling thread and on the worker
+// pool, at each scale, and prints the throughput.
+//
+// usage: jpegDecode <directory> [passes] [workers]
+
+namespace {
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void report(const std::string& label, size_t images, size_t bytes, double seconds) {
+        printf("%-24s %8.1f images/s %8.1f MB/s\n", label.c_str(),
+               images / seconds, bytes / seconds / (1024.0 * 1024.0));
+    }
+}
+
+//========================================================================
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("usage: %s <directory> [passes] [workers]\n", argv[0]);
+        return 1;
+    }
+    int passes = argc > 2 ? std::max(ofToInt(argv[2]), 1) : 10;
+    size_t workers = argc > 3 ? ofToInt(argv[3]) : 0;
+
+    // Read everything up front so the file system stays out of the numbers
+    ofDirectory directory(argv[1]);
+    directory.allowExt("jpg");
+    directory.allowExt("jpeg");
+    directory.listDir();
+
+    std::vector<ofBuffer> files;
+    size_t bytes = 0;
+    for (size_t i = 0; i < directory.size(); i++) {
+        files.push_back(ofBufferFromFile(directory.getPath(i), true));
+        bytes += files.back().size();
+    }
+    if (files.empty()) {
+        printf("No JPEG files in %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%zu files, %.1f MB, %d passes, decoding with %s\n", files.size(), bytes / (1024.0 * 1024.0), passes,
+           ofxSonyCameraJpegDecoder::isTurboJpegAvailable() ? "libjpeg-turbo" : "FreeImage");
+
+    const std::pair<ofxSonyCameraJpegDecoder::Scale, const char*> scales[] = {
+        { ofxSonyCameraJpegDecoder::SCALE_FULL, "full" },
+        { ofxSonyCameraJpegDecoder::SCALE_HALF, "half" },
+        { ofxSonyCameraJpegDecoder::SCALE_QUARTER, "quarter" },
+        { ofxSonyCameraJpegDecoder::SCALE_EIGHTH, "eighth" }
+    };
+
+    for (const auto& scale : scales) {
+        ofPixels pixels;
+        size_t failed = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            for (const ofBuffer& file : files) {
+                const unsigned char* data = reinterpret_cast<const unsigned char*>(file.getData());
+                if (!ofxSonyCameraJpegDecoder::decode(data, file.size(), pixels, scale.first)) {
+                    failed++;
+                }
+            }
+        }
+        report(std::string(scale.second) + ", 1 thread", files.size() * passes, bytes * passes, secondsSince(start));
+
+        // Keep the pool full: submit until every slot is busy, then collect
+        ofxSonyCameraJpegDecoder decoder;
+        decoder.setup(workers);
+        size_t total = files.size() * passes;
+        size_t submitted = 0;
+        size_t received = 0;
+        uint64_t id;
+        bool decoded;
+
+        start = std::chrono::steady_clock::now();
+        while (received < total) {
+            while (submitted < total) {
+                const ofBuffer& file = files[submitted % files.size()];
+                if (!decoder.submit(reinterpret_cast<const unsigned char*>(file.getData()), file.size(), scale.first, submitted)) {
+                    break;
+                }
+                submitted++;
+            }
+            if (decoder.receive(pixels, id, decoded)) {
+                received++;
+                if (!decoded) {
+                    failed++;
+                }
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        report(std::string(scale.second) + ", pool", total, bytes * passes, secondsSince(start));
+        decoder.close();
+
+        if (failed > 0) {
+            printf("%zu decodes failed\n", failed);
+        }
+    }
+    return 0;
+}
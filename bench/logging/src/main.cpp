@@ -0,0 +1,95 @@
+#include "ofMain.h"
+#include "ofxSonyCameraLog.h"
+#include <chrono>
+#include <thread>
+
+// Measures what logging one SDK notification costs the thread that logs it:
+// an ofLogNotice() stream against the ofxSonyCameraLog ring buffer. Messages
+// go to a logger channel that drops them, so printing stays out of the numbers.
+//
+// usage: logging [events] [threads]
+
+namespace {
+    class NullLoggerChannel : public ofBaseLoggerChannel {
+    public:
+        void log(ofLogLevel level, const std::string& module, const std::string& message) override {}
+        void log(ofLogLevel level, const std::string& module, const char* format, ...) override {}
+        void log(ofLogLevel level, const std::string& module, const char* format, va_list args) override {}
+    };
+
+    // Records each thread logs between flushes; the bursts of all threads
+    // together stay below the ring's capacity, so nothing is dropped
+    size_t burstSize = ofxSonyCameraLog::kCapacity / 2;
+
+    double logWithOfLog(size_t events) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < events; i++) {
+            ofLogNotice("ofxSonyCameraCallback") << "Camera property changed with " << (i & 7) + 1 << " code(s)";
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double logWithRing(size_t events) {
+        double nanos = 0;
+        for (size_t done = 0; done < events; done += burstSize) {
+            size_t burst = std::min(burstSize, events - done);
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < burst; i++) {
+                OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraCallback", "Camera property changed with {} code(s)", (i & 7) + 1);
+            }
+            nanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            // Let the formatter catch up outside the timed part
+            ofxSonyCameraLog::flush();
+        }
+        return nanos;
+    }
+
+    // Runs the same logger on several threads at once and returns the mean
+    // cost per event seen by each of them
+    double logConcurrently(double (*logger)(size_t), size_t events, size_t threads) {
+        std::vector<double> nanos(threads);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() { nanos[t] = logger(events / threads); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        double total = 0;
+        for (double n : nanos) {
+            total += n;
+        }
+        return total / (events / threads * threads);
+    }
+}
+
+//========================================================================
+int main(int argc, char* argv[]) {
+    size_t events = argc > 1 ? std::max(ofToInt(argv[1]), 1) : 100000;
+    size_t threads = argc > 2 ? std::max(ofToInt(argv[2]), 1) : 4;
+
+    ofSetLoggerChannel(std::make_shared<NullLoggerChannel>());
+    ofSetLogLevel(OF_LOG_NOTICE);
+
+    // Warm up both paths, including the ring's formatter thread
+    logWithOfLog(1000);
+    logWithRing(1000);
+
+    ofxSonyCameraLog::Stats before = ofxSonyCameraLog::getStats();
+
+    printf("%zu events\n", events);
+    printf("%-32s %8.1f ns/event\n", "ofLogNotice, 1 thread", logWithOfLog(events) / events);
+    printf("%-32s %8.1f ns/event\n", "ofxSonyCameraLog, 1 thread", logWithRing(events) / events);
+
+    std::string label = ", " + ofToString(threads) + " threads";
+    burstSize = std::max<size_t>(ofxSonyCameraLog::kCapacity / 2 / threads, 1);
+    printf("%-32s %8.1f ns/event\n", ("ofLogNotice" + label).c_str(), logConcurrently(logWithOfLog, events, threads));
+    printf("%-32s %8.1f ns/event\n", ("ofxSonyCameraLog" + label).c_str(), logConcurrently(logWithRing, events, threads));
+
+    ofxSonyCameraLog::Stats after = ofxSonyCameraLog::getStats();
+    printf("%llu records written, %llu dropped\n",
+           (unsigned long long)(after.written - before.written), (unsigned long long)(after.dropped - before.dropped));
+    return 0;
+}
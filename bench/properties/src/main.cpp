@@ -0,0 +1,181 @@
+#include "ofMain.h"
+#include "ofxSonyCameraRemote.h"
+#include "ofxSonyCameraSimulatedBackend.h"
+#include <algorithm>
+#include <chrono>
+
+// Compares reading and writing an exposure triplet one property at a time
+// with the batched calls, against a simulated camera whose property calls
+// take a log-normal latency.
+//
+// usage: properties [medianMicros] [p99Micros] [iterations]
+
+namespace {
+    const CrInt32u kCodes[] = {
+        SCRSDK::CrDeviceProperty_FNumber,
+        SCRSDK::CrDeviceProperty_ShutterSpeed,
+        SCRSDK::CrDeviceProperty_IsoSensitivity
+    };
+
+    // Receives the simulated camera's notifications when it is used directly
+    class NullCallback : public SCRSDK::IDeviceCallback {
+    public:
+        void OnConnected(SCRSDK::DeviceConnectionVersioin version) override {}
+        void OnDisconnected(CrInt32u error) override {}
+        void OnPropertyChanged() override {}
+        void OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes) override {}
+        void OnLvPropertyChanged() override {}
+        void OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes) override {}
+        void OnCompleteDownload(CrChar* filename, CrInt32u type) override {}
+        void OnNotifyContentsTransfer(CrInt32u notify, SCRSDK::CrContentHandle handle, CrChar* filename) override {}
+        void OnWarning(CrInt32u warning) override {}
+        void OnError(CrInt32u error) override {}
+    };
+
+    double microsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void report(const std::string& label, std::vector<double> micros) {
+        std::sort(micros.begin(), micros.end());
+        double mean = 0;
+        for (double sample : micros) {
+            mean += sample;
+        }
+        mean /= micros.size();
+        printf("%-28s mean %8.0f us  p50 %8.0f us  p99 %8.0f us\n", label.c_str(), mean,
+               micros[micros.size() / 2], micros[std::min(micros.size() - 1, micros.size() * 99 / 100)]);
+    }
+
+    // Backend level, since ofxSonyCameraRemote serves reads from its cache
+    void benchmarkReads(ofxSonyCameraSimulatedBackend& simulator, int iterations) {
+        std::vector<ofxSonyCameraBackend::CameraInfo> cameras;
+        simulator.enumerate(cameras);
+        NullCallback callback;
+        SCRSDK::CrDeviceHandle handle = 0;
+        if (cameras.empty() || simulator.connect(cameras[0], &callback, &handle) != SCRSDK::CrError_None) {
+            printf("Failed to connect to the simulated camera\n");
+            return;
+        }
+
+        std::vector<ofxSonyCameraBackend::Property> properties;
+        std::vector<double> looped;
+        std::vector<double> batched;
+        for (int i = 0; i < iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            for (CrInt32u code : kCodes) {
+                simulator.getSelectDeviceProperties(handle, 1, &code, properties);
+            }
+            looped.push_back(microsSince(start));
+
+            std::vector<CrInt32u> codes(std::begin(kCodes), std::end(kCodes));
+            start = std::chrono::steady_clock::now();
+            simulator.getSelectDeviceProperties(handle, static_cast<CrInt32u>(codes.size()), codes.data(), properties);
+            batched.push_back(microsSince(start));
+        }
+        report("read 3, looped", looped);
+        report("read 3, batched", batched);
+
+        simulator.disconnect(handle);
+        simulator.releaseDevice(handle);
+    }
+
+    // Waits until the camera has applied and confirmed the values, so every
+    // write starts from an idle queue
+    bool waitForValues(ofxSonyCameraRemote& camera, const std::vector<std::pair<CrInt32u, CrInt64u>>& values) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            auto stats = camera.getWriteQueueStats();
+            bool applied = stats.sent == stats.confirmed + stats.timedOut + stats.failed;
+            for (const auto& entry : values) {
+                CrInt64u value;
+                if (!camera.getProperty(entry.first, value) || value != entry.second) {
+                    applied = false;
+                }
+            }
+            if (applied) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        return false;
+    }
+
+    void benchmarkWrites(ofxSonyCameraRemote& camera, const ofxSonyCameraSimulatedBackend::Camera& description, int iterations) {
+        // The looped writes set the first value each property accepts and the
+        // batched ones the second, so every write changes what the camera holds
+        std::vector<std::pair<CrInt32u, CrInt64u>> values[2];
+        for (CrInt32u code : kCodes) {
+            for (const auto& property : description.properties) {
+                if (property.code == code && property.possible.size() >= 2) {
+                    values[0].push_back({ code, property.possible[0] });
+                    values[1].push_back({ code, property.possible[1] });
+                }
+            }
+        }
+
+        // Timed until the calls return, and until the camera reports the values
+        std::vector<double> looped, loopedApplied;
+        std::vector<double> batched, batchedApplied;
+        for (int i = 0; i < iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& entry : values[0]) {
+                camera.setProperty(entry.first, entry.second);
+            }
+            looped.push_back(microsSince(start));
+            if (!waitForValues(camera, values[0])) {
+                printf("Timed out waiting for the camera to apply the values\n");
+                return;
+            }
+            loopedApplied.push_back(microsSince(start));
+
+            start = std::chrono::steady_clock::now();
+            camera.setProperties(values[1]);
+            batched.push_back(microsSince(start));
+            if (!waitForValues(camera, values[1])) {
+                printf("Timed out waiting for the camera to apply the values\n");
+                return;
+            }
+            batchedApplied.push_back(microsSince(start));
+        }
+        report("write 3, looped", looped);
+        report("write 3, batched", batched);
+        report("write 3, looped, applied", loopedApplied);
+        report("write 3, batched, applied", batchedApplied);
+    }
+}
+
+//========================================================================
+int main(int argc, char* argv[]) {
+    ofxSonyCameraSimulatedBackend::Latency latency;
+    latency.medianMicros = argc > 1 ? ofToInt(argv[1]) : 2000;
+    latency.p99Micros = argc > 2 ? ofToInt(argv[2]) : latency.medianMicros * 4;
+    int iterations = argc > 3 ? std::max(ofToInt(argv[3]), 1) : 200;
+
+    ofxSonyCameraSimulatedBackend::Settings settings;
+    settings.propertyApplyMicros = 1000;
+    auto simulator = std::make_shared<ofxSonyCameraSimulatedBackend>(settings);
+    auto description = ofxSonyCameraSimulatedBackend::makeCamera("BENCH");
+    simulator->addCamera(description);
+    simulator->setLatency(ofxSonyCameraMetrics::CALL_GET_SELECT_DEVICE_PROPERTIES, latency);
+    simulator->setLatency(ofxSonyCameraMetrics::CALL_SET_DEVICE_PROPERTY, latency);
+
+    printf("property calls take %llu us median, %llu us p99; %d iterations\n",
+           (unsigned long long)latency.medianMicros, (unsigned long long)latency.p99Micros, iterations);
+
+    benchmarkReads(*simulator, iterations);
+
+    ofxSonyCameraRemote camera;
+    camera.setBackend(simulator);
+    if (!camera.setup() || !camera.enumerateDevices() || !camera.connect(0)) {
+        printf("Failed to connect to the simulated camera\n");
+        return 1;
+    }
+    benchmarkWrites(camera, description, iterations);
+    camera.exit();
+
+    auto stats = simulator->getStats();
+    printf("%llu simulated calls, %llu notifications\n",
+           (unsigned long long)stats.calls, (unsigned long long)stats.callbacks);
+    return 0;
+}
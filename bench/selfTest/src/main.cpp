@@ -0,0 +1,141 @@
+#include "ofMain.h"
+#include "ofxSonyCameraRemote.h"
+#include "ofxSonyCameraSimulatedBackend.h"
+#include <chrono>
+#include <thread>
+
+// Checks the addon end to end against a simulated camera and exits non-zero
+// if any check fails, so it can run on a CI machine. Needs no camera and no
+// SDK libraries: build it with OFX_SONY_CAMERA_NO_SDK on a machine that has
+// neither.
+//
+// usage: selfTest
+
+namespace {
+    const std::string kCameraId = "SELFTEST";
+    const std::chrono::milliseconds kTimeout(5000);
+
+    int failures = 0;
+
+    void check(bool passed, const char* what) {
+        printf("%s  %s\n", passed ? "PASS" : "FAIL", what);
+        if (!passed) {
+            failures++;
+        }
+    }
+
+    // Polls the camera's events until the condition holds or the timeout passes
+    template<typename Condition>
+    bool waitFor(ofxSonyCameraRemote& camera, Condition condition, std::chrono::milliseconds timeout = kTimeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            camera.pollEvents();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    bool holds(ofxSonyCameraRemote& camera, CrInt32u code, CrInt64u expected) {
+        CrInt64u value;
+        return camera.getProperty(code, value) && value == expected;
+    }
+
+    bool cameraHolds(ofxSonyCameraSimulatedBackend& simulator, CrInt32u code, CrInt64u expected) {
+        CrInt64u value;
+        return simulator.getPropertyValue(kCameraId, code, value) && value == expected;
+    }
+
+    // Every write sent has been confirmed, timed out or failed
+    bool writesSettled(ofxSonyCameraRemote& camera) {
+        ofxSonyCameraWriteQueue::Stats stats = camera.getWriteQueueStats();
+        return stats.sent == stats.confirmed + stats.timedOut + stats.failed;
+    }
+
+    // A dial turned on the camera reaches the cache and the subscribers
+    void checkRefreshOnChange(ofxSonyCameraRemote& camera, ofxSonyCameraSimulatedBackend& simulator) {
+        CrInt64u notified = 0;
+        camera.subscribe(SCRSDK::CrDeviceProperty_FNumber, [&notified](CrInt32u code, CrInt64u value) {
+            notified = value;
+        });
+
+        simulator.changeProperty(kCameraId, SCRSDK::CrDeviceProperty_FNumber, 560);
+        check(waitFor(camera, [&]() { return holds(camera, SCRSDK::CrDeviceProperty_FNumber, 560); }),
+              "a change on the camera refreshes the cache");
+        check(waitFor(camera, [&]() { return notified == 560; }),
+              "a change on the camera reaches its subscriber");
+    }
+
+    // Writes made faster than the camera applies them collapse to the last one
+    void checkLatestWins(ofxSonyCameraRemote& camera, ofxSonyCameraSimulatedBackend& simulator) {
+        const std::vector<CrInt64u> isos = { 100, 200, 400, 800, 1600, 3200, 6400 };
+        ofxSonyCameraWriteQueue::Stats before = camera.getWriteQueueStats();
+        bool accepted = true;
+        for (CrInt64u iso : isos) {
+            accepted = camera.setProperty(SCRSDK::CrDeviceProperty_IsoSensitivity, iso) && accepted;
+        }
+        check(accepted, "writes are accepted while one is in flight");
+
+        CrInt64u last = isos.back();
+        check(waitFor(camera, [&]() {
+            return cameraHolds(simulator, SCRSDK::CrDeviceProperty_IsoSensitivity, last) &&
+                   holds(camera, SCRSDK::CrDeviceProperty_IsoSensitivity, last) &&
+                   writesSettled(camera);
+        }), "the last write wins, on the camera and in the cache");
+
+        ofxSonyCameraWriteQueue::Stats after = camera.getWriteQueueStats();
+        check(after.dropped > before.dropped, "superseded writes are dropped rather than sent");
+        check(after.sent - before.sent < isos.size(), "fewer writes are sent than made");
+    }
+
+    // A pulled cable is followed by a reconnect that restores the values set
+    void checkReconnect(ofxSonyCameraRemote& camera, ofxSonyCameraSimulatedBackend& simulator) {
+        ofxSonyCameraRemote::ReconnectSettings settings;
+        settings.initialDelayMs = 100;
+        camera.setReconnectSettings(settings);
+
+        CrInt64u iso = 800;
+        camera.setProperty(SCRSDK::CrDeviceProperty_IsoSensitivity, iso);
+        waitFor(camera, [&]() { return cameraHolds(simulator, SCRSDK::CrDeviceProperty_IsoSensitivity, iso); });
+
+        simulator.injectDisconnect(kCameraId, SCRSDK::CrError_Connect, std::chrono::milliseconds(300));
+        check(waitFor(camera, [&]() { return !camera.isConnected(); }), "an injected disconnect is noticed");
+
+        // Changed while the camera was away; the addon sends its own value again
+        simulator.changeProperty(kCameraId, SCRSDK::CrDeviceProperty_IsoSensitivity, 100);
+
+        check(waitFor(camera, [&]() { return camera.getConnectionState() == ofxSonyCameraRemote::STATE_CONNECTED; }),
+              "the camera reconnects once it is back");
+        check(waitFor(camera, [&]() { return cameraHolds(simulator, SCRSDK::CrDeviceProperty_IsoSensitivity, iso); }),
+              "values set before the disconnect are sent again");
+
+        auto incidents = camera.getReconnectIncidents();
+        check(!incidents.empty() && incidents.back().recovered, "the incident is recorded as recovered");
+    }
+}
+
+//========================================================================
+int main(int argc, char* argv[]) {
+    ofxSonyCameraSimulatedBackend::Settings settings;
+    settings.propertyApplyMicros = 20000;
+    auto simulator = std::make_shared<ofxSonyCameraSimulatedBackend>(settings);
+    simulator->addCamera(ofxSonyCameraSimulatedBackend::makeCamera(kCameraId));
+
+    ofxSonyCameraRemote camera;
+    camera.setBackend(simulator);
+    if (!camera.setup() || !camera.enumerateDevices() || !camera.connect(0)) {
+        printf("FAIL  connect to the simulated camera\n");
+        return 1;
+    }
+
+    checkRefreshOnChange(camera, *simulator);
+    checkLatestWins(camera, *simulator);
+    checkReconnect(camera, *simulator);
+
+    camera.exit();
+
+    printf("%d check(s) failed\n", failures);
+    return failures > 0 ? 1 : 0;
+}
@@ -17,6 +17,7 @@ void ofApp::setup() {
     
     // Initialize camera variables
     connected = false;
+    connecting = false;
     cameraModel = "Not Connected";
     isoValue = "Unknown";
     apertureValue = "Unknown";
@@ -34,6 +35,17 @@ void ofApp::setup() {
     camera.registerDisconnectCallback([this](CrInt32u reason) { this->onCameraDisconnected(reason); });
     camera.registerErrorCallback([this](CrInt32u error) { this->onCameraError(error); });
     
+    // Keep the displayed values current; each handler only runs when its own property changes
+    camera.subscribe(CrDeviceProperty_IsoSensitivity, [this](CrInt32u code, CrInt64u value) {
+        isoValue = ofxSonyCameraProperty::format(code, value);
+    });
+    camera.subscribe(CrDeviceProperty_FNumber, [this](CrInt32u code, CrInt64u value) {
+        apertureValue = ofxSonyCameraProperty::format(code, value);
+    });
+    camera.subscribe(CrDeviceProperty_ShutterSpeed, [this](CrInt32u code, CrInt64u value) {
+        shutterSpeedValue = ofxSonyCameraProperty::format(code, value);
+    });
+    
     // Get SDK version
     CrInt32u sdkVersion = camera.getSDKVersion();
     sdkVersionString = "SDK Version: " + ofToString(sdkVersion);
@@ -52,18 +64,35 @@ void ofApp::setup() {
         }
     }
     
-    // Try to enumerate camera devices with Sony SDK
-    if (camera.enumerateDevices()) {
-        ofLogNotice("ofApp") << "Found " << camera.getDeviceCount() << " camera(s)";
-        camera.connect();
-    } else {
-        ofLogNotice("ofApp") << "No cameras found. Connect a camera and press 'c' to try again.";
+    // Connect as soon as a camera is plugged in; cameras already attached
+    // are reported right away. This runs from pollEvents() in update(), so
+    // connect in the background rather than hold up the frame
+    camera.registerDevicesChangedCallback([this](int count) {
+        ofLogNotice("ofApp") << "Found " << count << " camera(s)";
+        if (count > 0 && !connected && !connecting.exchange(true)) {
+            camera.connectAsync(0, [this](CrError err) {
+                if (err != SCRSDK::CrError_None) {
+                    ofLogError("ofApp") << "Failed to connect: " << ofxSonyCameraError::lookup(err).name;
+                }
+                connecting = false;
+            });
+        }
+    });
+    if (!camera.startHotplug()) {
+        // Without hotplug support, enumerate once now and on 'c'
+        if (camera.enumerateDevices()) {
+            ofLogNotice("ofApp") << "Found " << camera.getDeviceCount() << " camera(s)";
+            camera.connect();
+        } else {
+            ofLogNotice("ofApp") << "No cameras found. Connect a camera and press 'c' to try again.";
+        }
     }
 }
 
 //--------------------------------------------------------------
 void ofApp::update() {
-    // Update logic can be added here if needed
+    // Run camera callbacks on this thread, so they can update the strings draw() reads
+    camera.pollEvents();
 }
 
 //--------------------------------------------------------------
@@ -146,7 +175,12 @@ void ofApp::keyPressed(int key) {
             // Capture photo
             if (connected) {
                 ofLogNotice("ofApp") << "Capturing photo...";
-                camera.capturePhoto();
+                // Don't stall the frame while the camera handles the shutter
+                camera.capturePhotoAsync([](CrError err) {
+                    if (err != CrError_None) {
+                        ofLogError("ofApp") << "Capture failed, code: " << err;
+                    }
+                });
             }
             break;
             
@@ -212,23 +246,21 @@ void ofApp::onCameraError(CrInt32u error) {
 
 //--------------------------------------------------------------
 void ofApp::updateCameraProperties() {
-    // Get current property values
-    CrInt64u value;
-    
-    if (camera.getProperty(CrDeviceProperty_IsoSensitivity, value)) {
-        isoValue = ofToString(value); // In a real app, this would map to a human-readable ISO value
-    }
-    
-    if (camera.getProperty(CrDeviceProperty_FNumber, value)) {
-        // Convert to a more readable format (this is simplified)
-        double fNumber = value / 100.0;
-        apertureValue = "f/" + ofToString(fNumber, 1);
+    // Get current property values in a single request
+    std::vector<CrInt32u> codes = {
+        CrDeviceProperty_IsoSensitivity,
+        CrDeviceProperty_FNumber,
+        CrDeviceProperty_ShutterSpeed
+    };
+    std::vector<CrInt64u> values;
+    if (!camera.getProperties(codes, values)) {
+        return;
     }
     
-    if (camera.getProperty(CrDeviceProperty_ShutterSpeed, value)) {
-        // Convert to a more readable format (this is simplified)
-        shutterSpeedValue = "1/" + ofToString(value);
-    }
+    // Format with the property traits: "ISO 400", "f/2.8", "1/125"
+    isoValue = ofxSonyCameraProperty::format(codes[0], values[0]);
+    apertureValue = ofxSonyCameraProperty::format(codes[1], values[1]);
+    shutterSpeedValue = ofxSonyCameraProperty::format(codes[2], values[2]);
 }
 
 //--------------------------------------------------------------
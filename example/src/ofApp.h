@@ -29,6 +29,7 @@ public:
     
     // Camera status
     bool connected;
+    std::atomic<bool> connecting; // a connectAsync() is under way
     
     // Camera properties
     std::string cameraModel;
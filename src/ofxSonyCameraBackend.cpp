@@ -0,0 +1,218 @@
+#include "ofxSonyCameraBackend.h"
+#include "ofxSonyCameraLog.h"
+#include "ofxSonyCameraSdk.h"
+#include <cstring>
+
+ofxSonyCameraBackend::CameraInfo::CameraInfo(const SCRSDK::ICrCameraObjectInfo* info) {
+    if (!info) {
+        return;
+    }
+    model = info->GetModel() ? info->GetModel() : "";
+    id = ofxSonyCameraSdk::getCameraId(info);
+    handle = std::shared_ptr<const void>(info, [](const void*) {});
+}
+
+#ifndef OFX_SONY_CAMERA_NO_SDK
+
+namespace {
+    // Unpack the possible values of a property into plain integers; ranges
+    // (min, max, step), strings and free values have none
+    void unpackValues(SCRSDK::CrDeviceProperty& property, std::vector<CrInt64u>& values) {
+        values.clear();
+        CrInt8u* data = property.GetValues();
+        CrInt32u size = property.GetValueSize();
+        CrInt32u type = property.GetValueType();
+        if (!data || size == 0 || (type & SCRSDK::CrDataType_RangeBit) || type == SCRSDK::CrDataType_STR) {
+            return;
+        }
+
+        // The low bits encode the element width: 1 = 8-bit ... 4 = 64-bit
+        CrInt32u width = type & 0x0F;
+        if (width < 1 || width > 4) {
+            return;
+        }
+        size_t elementSize = size_t(1) << (width - 1);
+
+        values.reserve(size / elementSize);
+        for (size_t offset = 0; offset + elementSize <= size; offset += elementSize) {
+            CrInt64u value = 0;
+            switch (elementSize) {
+                case 1: value = data[offset]; break;
+                case 2: { CrInt16u v; memcpy(&v, data + offset, 2); value = v; break; }
+                case 4: { CrInt32u v; memcpy(&v, data + offset, 4); value = v; break; }
+                default: memcpy(&value, data + offset, 8); break;
+            }
+            values.push_back(value);
+        }
+    }
+
+    // Copy an SDK property array; resizing in place keeps the capacity of
+    // the possible value lists when the caller reuses the vector
+    void readProperties(SCRSDK::CrDeviceProperty* array, CrInt32 count, std::vector<ofxSonyCameraBackend::Property>& properties) {
+        properties.resize(array && count > 0 ? count : 0);
+        for (size_t i = 0; i < properties.size(); i++) {
+            SCRSDK::CrDeviceProperty& from = array[i];
+            ofxSonyCameraBackend::Property& to = properties[i];
+            to.code = from.GetCode();
+            to.type = from.GetValueType();
+            to.value = from.GetCurrentValue();
+            to.writable = from.IsSetEnableCurrentValue();
+            unpackValues(from, to.possible);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+bool ofxSonyCameraSdkBackend::init() {
+    return ofxSonyCameraSdk::acquire();
+}
+
+void ofxSonyCameraSdkBackend::release() {
+    ofxSonyCameraSdk::release();
+}
+
+CrInt32u ofxSonyCameraSdkBackend::getSdkVersion() {
+    return SCRSDK::GetSDKVersion();
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::enumerate(std::vector<CameraInfo>& cameras) {
+    cameras.clear();
+
+    SCRSDK::ICrEnumCameraObjectInfo* enumInfo = nullptr;
+    SCRSDK::CrError err = SCRSDK::EnumCameraObjects(&enumInfo);
+    if (err != SCRSDK::CrError_None || !enumInfo) {
+        return err != SCRSDK::CrError_None ? err : SCRSDK::CrError_Adaptor_EnumDevice;
+    }
+
+    // Every camera shares ownership of the enumeration, which is released
+    // once the last of them is gone
+    std::shared_ptr<SCRSDK::ICrEnumCameraObjectInfo> owner(enumInfo, [](SCRSDK::ICrEnumCameraObjectInfo* info) {
+        info->Release();
+    });
+
+    for (CrInt32u i = 0; i < enumInfo->GetCount(); i++) {
+        const SCRSDK::ICrCameraObjectInfo* info = enumInfo->GetCameraObjectInfo(i);
+        if (!info) {
+            continue;
+        }
+        CameraInfo camera(info);
+        camera.handle = std::shared_ptr<const void>(owner, info);
+        cameras.push_back(camera);
+    }
+    return SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) {
+    if (!camera.handle) {
+        return SCRSDK::CrError_Generic_InvalidParameter;
+    }
+
+    // The SDK takes a non-const pointer but doesn't modify the camera info
+    auto info = static_cast<const SCRSDK::ICrCameraObjectInfo*>(camera.handle.get());
+    return SCRSDK::Connect(const_cast<SCRSDK::ICrCameraObjectInfo*>(info), callback, deviceHandle,
+                           SCRSDK::CrSdkControlMode_Remote, SCRSDK::CrReconnecting_OFF);
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::disconnect(SCRSDK::CrDeviceHandle deviceHandle) {
+    return SCRSDK::Disconnect(deviceHandle);
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) {
+    return SCRSDK::ReleaseDevice(deviceHandle);
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) {
+    return SCRSDK::SendCommand(deviceHandle, commandId, commandParam);
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) {
+    SCRSDK::CrDeviceProperty* array = nullptr;
+    CrInt32 count = 0;
+    SCRSDK::CrError err = SCRSDK::GetDeviceProperties(deviceHandle, &array, &count);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+    readProperties(array, count, properties);
+    SCRSDK::ReleaseDeviceProperties(deviceHandle, array);
+    return SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) {
+    SCRSDK::CrDeviceProperty* array = nullptr;
+    CrInt32 count = 0;
+    SCRSDK::CrError err = SCRSDK::GetSelectDeviceProperties(deviceHandle, numOfCodes, codes, &array, &count);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+    readProperties(array, count, properties);
+    SCRSDK::ReleaseDeviceProperties(deviceHandle, array);
+    return SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) {
+    SCRSDK::CrDeviceProperty sdkProperty;
+    sdkProperty.SetCode(property.code);
+    sdkProperty.SetCurrentValue(property.value);
+    sdkProperty.SetValueType(property.type);
+    return SCRSDK::SetDeviceProperty(deviceHandle, &sdkProperty);
+}
+
+std::unique_ptr<ofxSonyCameraLiveViewSource> ofxSonyCameraSdkBackend::createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) {
+    return std::make_unique<ofxSonyCameraSdkLiveViewSource>(deviceHandle);
+}
+
+#else
+
+//--------------------------------------------------------------
+// Built without the SDK: every call fails, starting with init()
+
+bool ofxSonyCameraSdkBackend::init() {
+    OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraSdkBackend", "Built without the Camera Remote SDK (OFX_SONY_CAMERA_NO_SDK)");
+    return false;
+}
+
+void ofxSonyCameraSdkBackend::release() {
+}
+
+CrInt32u ofxSonyCameraSdkBackend::getSdkVersion() {
+    return 0;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::enumerate(std::vector<CameraInfo>& cameras) {
+    cameras.clear();
+    return SCRSDK::CrError_Generic_NotSupported;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) {
+    return SCRSDK::CrError_Generic_NotSupported;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::disconnect(SCRSDK::CrDeviceHandle deviceHandle) {
+    return SCRSDK::CrError_Generic_NotSupported;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) {
+    return SCRSDK::CrError_Generic_NotSupported;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) {
+    return SCRSDK::CrError_Generic_NotSupported;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) {
+    return SCRSDK::CrError_Generic_NotSupported;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) {
+    return SCRSDK::CrError_Generic_NotSupported;
+}
+
+SCRSDK::CrError ofxSonyCameraSdkBackend::setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) {
+    return SCRSDK::CrError_Generic_NotSupported;
+}
+
+std::unique_ptr<ofxSonyCameraLiveViewSource> ofxSonyCameraSdkBackend::createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) {
+    return nullptr;
+}
+
+#endif
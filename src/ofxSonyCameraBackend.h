@@ -0,0 +1,143 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CameraRemote_SDK.h"
+#include "ofxSonyCameraLiveView.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The Camera Remote SDK calls made by ofxSonyCameraRemote
+ *
+ * Every call the addon makes into the SDK goes through a backend, so the same
+ * remote can drive a real camera (ofxSonyCameraSdkBackend, the default) or a
+ * simulated one (ofxSonyCameraSimulatedBackend) or a recorded session
+ * (ofxSonyCameraReplayBackend). The methods follow the SDK
+ * functions of the same name and return SDK error codes, but properties
+ * travel as Property values rather than CrDeviceProperty arrays, so only
+ * ofxSonyCameraSdkBackend touches the SDK's property class.
+ *
+ * One backend may be shared by several remotes, as ofxSonyCameraRig does, so
+ * implementations must be safe to call from several threads.
+ */
+class ofxSonyCameraBackend {
+public:
+    /**
+     * @brief A camera found by enumerate()
+     */
+    struct CameraInfo {
+        std::string model;
+        std::string id;                     // serial number over USB
+        std::shared_ptr<const void> handle; // backend data; keeps the enumeration alive
+
+        CameraInfo() {}
+
+        /**
+         * @brief Describe a camera from an SDK enumeration
+         *
+         * Doesn't take ownership: the enumeration must outlive the connection.
+         */
+        CameraInfo(const SCRSDK::ICrCameraObjectInfo* info);
+    };
+
+    /**
+     * @brief A property read from or written to a camera
+     */
+    struct Property {
+        CrInt32u code = 0;
+        SCRSDK::CrDataType type = SCRSDK::CrDataType_UInt32;
+        CrInt64u value = 0;
+        bool writable = true;
+        std::vector<CrInt64u> possible; // empty for a free value, a range or a string
+    };
+
+    virtual ~ofxSonyCameraBackend() {}
+
+    /**
+     * @brief Take a reference to the backend; matched by release()
+     *
+     * @return true if the backend is ready, false otherwise
+     */
+    virtual bool init() = 0;
+    virtual void release() = 0;
+
+    virtual CrInt32u getSdkVersion() = 0;
+
+    /**
+     * @brief Find the cameras that can be connected
+     *
+     * @param cameras Receives the cameras, replacing its contents
+     */
+    virtual SCRSDK::CrError enumerate(std::vector<CameraInfo>& cameras) = 0;
+
+    /**
+     * @brief Open a remote control connection without SDK-side reconnection
+     *
+     * @param camera A camera from enumerate()
+     * @param callback Receives the camera's notifications until releaseDevice()
+     * @param deviceHandle Receives the handle of the connection
+     */
+    virtual SCRSDK::CrError connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) = 0;
+    virtual SCRSDK::CrError disconnect(SCRSDK::CrDeviceHandle deviceHandle) = 0;
+
+    /**
+     * @brief Free a connection's handle; no callback runs for it afterwards
+     */
+    virtual SCRSDK::CrError releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) = 0;
+
+    virtual SCRSDK::CrError sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) = 0;
+
+    /**
+     * @brief Read every property of a connection
+     *
+     * @param properties Receives the properties, replacing its contents
+     */
+    virtual SCRSDK::CrError getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) = 0;
+
+    /**
+     * @brief Read some properties of a connection in one call
+     *
+     * @param properties Receives the properties, replacing its contents;
+     *        codes the camera doesn't have are left out
+     */
+    virtual SCRSDK::CrError getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) = 0;
+
+    /**
+     * @brief Write a property; only its code, type and value are sent
+     */
+    virtual SCRSDK::CrError setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) = 0;
+
+    /**
+     * @brief Create the live view source of a connection
+     *
+     * @return The source, or nullptr if the connection has no live view
+     */
+    virtual std::unique_ptr<ofxSonyCameraLiveViewSource> createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) = 0;
+};
+
+/**
+ * @brief Backend calling the Camera Remote SDK
+ *
+ * init() and release() take and drop a reference on ofxSonyCameraSdk.
+ * Property arrays from the SDK are copied into Property values and released
+ * before each call returns.
+ *
+ * When the addon is built with OFX_SONY_CAMERA_NO_SDK defined, init() fails
+ * and no SDK function is referenced, so programs that only use simulated or
+ * replayed cameras link without the SDK's libraries.
+ */
+class ofxSonyCameraSdkBackend : public ofxSonyCameraBackend {
+public:
+    bool init() override;
+    void release() override;
+    CrInt32u getSdkVersion() override;
+    SCRSDK::CrError enumerate(std::vector<CameraInfo>& cameras) override;
+    SCRSDK::CrError connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) override;
+    SCRSDK::CrError disconnect(SCRSDK::CrDeviceHandle deviceHandle) override;
+    SCRSDK::CrError releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) override;
+    SCRSDK::CrError sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) override;
+    SCRSDK::CrError getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) override;
+    SCRSDK::CrError getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) override;
+    SCRSDK::CrError setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) override;
+    std::unique_ptr<ofxSonyCameraLiveViewSource> createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) override;
+};
@@ -1,11 +1,20 @@
 #include "ofxSonyCameraCallback.h"
-
-ofxSonyCameraCallback::ofxSonyCameraCallback() {
+#include "ofxSonyCameraErrorTable.h"
+#include "ofxSonyCameraLog.h"
+#include <cstring>
+#include <algorithm>
+
+ofxSonyCameraCallback::ofxSonyCameraCallback()
+    : mPropertyEventsHooked(false)
+    , mEventQueue(nullptr) {
     // Initialize callbacks to empty functions
     mConnectCallback = []() {};
     mDisconnectCallback = [](CrInt32u) {};
     mPropertyChangeCallback = []() {};
     mErrorCallback = [](CrInt32u) {};
+    mDownloadCallback = [](const std::string&, CrInt32u) {};
+    mContentsTransferCallback = [](CrInt32u) {};
+    mPropertyCodesCallback = [](CrInt32u, CrInt32u*) {};
 }
 
 ofxSonyCameraCallback::~ofxSonyCameraCallback() {
@@ -28,56 +37,113 @@ void ofxSonyCameraCallback::setErrorCallback(std::function<void(CrInt32u)> callb
     mErrorCallback = callback;
 }
 
+void ofxSonyCameraCallback::setDownloadCallback(std::function<void(const std::string&, CrInt32u)> callback) {
+    mDownloadCallback = callback;
+}
+
+void ofxSonyCameraCallback::setContentsTransferCallback(std::function<void(CrInt32u)> callback) {
+    mContentsTransferCallback = callback;
+}
+
+void ofxSonyCameraCallback::setPropertyCodesCallback(std::function<void(CrInt32u, CrInt32u*)> callback) {
+    mPropertyCodesCallback = callback;
+    mPropertyEventsHooked = static_cast<bool>(callback);
+}
+
+void ofxSonyCameraCallback::setEventQueue(ofxSonyCameraEventQueue* queue) {
+    mEventQueue = queue;
+}
+
+void ofxSonyCameraCallback::pushEvent(ofxSonyCameraEvent::Type type, CrInt32u value) {
+    if (!mEventQueue) {
+        return;
+    }
+    ofxSonyCameraEvent event;
+    event.type = type;
+    event.value = value;
+    event.numCodes = 0;
+    event.filename[0] = '\0';
+    mEventQueue->push(event);
+}
+
 // IDeviceCallback implementation
 void ofxSonyCameraCallback::OnConnected(DeviceConnectionVersioin version) {
-    ofLogNotice("ofxSonyCameraCallback") << "Camera connected, version: " << version;
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraCallback", "Camera connected, version: {}", version);
     mConnectCallback();
+    pushEvent(ofxSonyCameraEvent::EVENT_CONNECTED, version);
 }
 
 void ofxSonyCameraCallback::OnDisconnected(CrInt32u error) {
-    ofLogNotice("ofxSonyCameraCallback") << "Camera disconnected, error: " << error;
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraCallback", "Camera disconnected, error: {}", ofxSonyCameraError::lookup(error).name);
     mDisconnectCallback(error);
+    pushEvent(ofxSonyCameraEvent::EVENT_DISCONNECTED, error);
 }
 
 void ofxSonyCameraCallback::OnPropertyChanged() {
-    ofLogVerbose("ofxSonyCameraCallback") << "Camera property changed";
+    OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraCallback", "Camera property changed");
+    // No codes given, so every property may have changed
+    mPropertyCodesCallback(0, nullptr);
     mPropertyChangeCallback();
+    if (!mPropertyEventsHooked) {
+        pushEvent(ofxSonyCameraEvent::EVENT_PROPERTY_CHANGED, 0);
+    }
 }
 
 void ofxSonyCameraCallback::OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes) {
-    ofLogVerbose("ofxSonyCameraCallback") << "Camera property changed with " << num << " code(s)";
-    // Here you could add specific handling for different property codes
+    OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraCallback", "Camera property changed with {} code(s)", num);
+    mPropertyCodesCallback(num, codes);
     mPropertyChangeCallback();
+    
+    if (mEventQueue && !mPropertyEventsHooked) {
+        // Too many codes for one event: report every property as changed
+        ofxSonyCameraEvent event;
+        event.type = ofxSonyCameraEvent::EVENT_PROPERTY_CHANGED;
+        event.value = 0;
+        event.numCodes = (codes && num <= ofxSonyCameraEvent::kMaxCodes) ? num : 0;
+        std::copy(codes, codes + event.numCodes, event.codes);
+        event.filename[0] = '\0';
+        mEventQueue->push(event);
+    }
 }
 
 void ofxSonyCameraCallback::OnLvPropertyChanged() {
-    ofLogVerbose("ofxSonyCameraCallback") << "Live view property changed";
+    OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraCallback", "Live view property changed");
     // Handle live view property changes
 }
 
 void ofxSonyCameraCallback::OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes) {
-    ofLogVerbose("ofxSonyCameraCallback") << "Live view property changed with " << num << " code(s)";
+    OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraCallback", "Live view property changed with {} code(s)", num);
     // Here you could add specific handling for different live view property codes
 }
 
 void ofxSonyCameraCallback::OnCompleteDownload(CrChar* filename, CrInt32u type) {
-    ofLogNotice("ofxSonyCameraCallback") << "Download completed: " << filename << ", type: " << type;
-    // Handle download completion
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraCallback", "Download completed: {}, type: {}", filename, type);
+    mDownloadCallback(filename ? filename : "", type);
+    
+    if (mEventQueue) {
+        ofxSonyCameraEvent event;
+        event.type = ofxSonyCameraEvent::EVENT_DOWNLOAD_COMPLETE;
+        event.value = type;
+        event.numCodes = 0;
+        strncpy(event.filename, filename ? filename : "", ofxSonyCameraEvent::kMaxFilename - 1);
+        event.filename[ofxSonyCameraEvent::kMaxFilename - 1] = '\0';
+        mEventQueue->push(event);
+    }
 }
 
 void ofxSonyCameraCallback::OnNotifyContentsTransfer(CrInt32u notify, CrContentHandle handle, CrChar* filename) {
-    ofLogNotice("ofxSonyCameraCallback") << "Contents transfer notification: " << notify 
-                                         << ", handle: " << handle 
-                                         << ", filename: " << (filename ? filename : "null");
-    // Handle content transfer notification
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraCallback", "Contents transfer notification: {}, handle: {}, filename: {}",
+        notify, handle, (filename ? filename : "null"));
+    mContentsTransferCallback(notify);
 }
 
 void ofxSonyCameraCallback::OnWarning(CrInt32u warning) {
-    ofLogWarning("ofxSonyCameraCallback") << "Camera warning: " << warning;
-    // Handle warning
+    OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraCallback", "Camera warning: {} (0x{:x})", ofxSonyCameraError::lookup(warning).name, warning);
+    pushEvent(ofxSonyCameraEvent::EVENT_WARNING, warning);
 }
 
 void ofxSonyCameraCallback::OnError(CrInt32u error) {
-    ofLogError("ofxSonyCameraCallback") << "Camera error: " << error;
+    OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraCallback", "Camera error: {} (0x{:x})", ofxSonyCameraError::lookup(error).name, error);
     mErrorCallback(error);
+    pushEvent(ofxSonyCameraEvent::EVENT_ERROR, error);
 }
\ No newline at end of file
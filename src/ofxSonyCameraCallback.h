@@ -3,6 +3,7 @@
 #include "ofMain.h"
 #include "../libs/CRSDK/include/CameraRemote_SDK.h"
 #include "../libs/CRSDK/include/IDeviceCallback.h"
+#include "ofxSonyCameraEventQueue.h"
 
 // Note: CrInt32u, CrInt32, CrChar types are defined in the global namespace in CrTypes.h
 // Only types specifically defined in the SCRSDK namespace need to be qualified
@@ -15,6 +16,9 @@ using SCRSDK::CrContentHandle;
  * 
  * This class implements the SCRSDK::IDeviceCallback interface to receive
  * events from the Sony Camera Remote SDK and forward them to the application.
+ * 
+ * The registered functions run on the SDK's callback thread. Events are also
+ * pushed to an optional event queue, to be handled on the application thread.
  */
 class ofxSonyCameraCallback : public SCRSDK::IDeviceCallback {
 public:
@@ -26,6 +30,16 @@ public:
     void setDisconnectCallback(std::function<void(CrInt32u)> callback);
     void setPropertyChangeCallback(std::function<void()> callback);
     void setErrorCallback(std::function<void(CrInt32u)> callback);
+    void setDownloadCallback(std::function<void(const std::string&, CrInt32u)> callback);
+    void setContentsTransferCallback(std::function<void(CrInt32u)> callback);
+    
+    // Internal hook receiving the changed property codes (num == 0 means "all").
+    // Once set, the hook's owner queues the property change events itself,
+    // e.g. after reading the new values back
+    void setPropertyCodesCallback(std::function<void(CrInt32u, CrInt32u*)> callback);
+    
+    // Queue receiving a copy of every event; must outlive the connection
+    void setEventQueue(ofxSonyCameraEventQueue* queue);
     
     // IDeviceCallback implementation
     virtual void OnConnected(SCRSDK::DeviceConnectionVersioin version) override;
@@ -44,4 +58,11 @@ private:
     std::function<void(CrInt32u)> mDisconnectCallback;
     std::function<void()> mPropertyChangeCallback;
     std::function<void(CrInt32u)> mErrorCallback;
+    std::function<void(const std::string&, CrInt32u)> mDownloadCallback;
+    std::function<void(CrInt32u)> mContentsTransferCallback;
+    std::function<void(CrInt32u, CrInt32u*)> mPropertyCodesCallback;
+    bool mPropertyEventsHooked;
+    
+    void pushEvent(ofxSonyCameraEvent::Type type, CrInt32u value);
+    ofxSonyCameraEventQueue* mEventQueue;
 };
\ No newline at end of file
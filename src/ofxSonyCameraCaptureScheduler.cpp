@@ -0,0 +1,244 @@
+#include "ofxSonyCameraCaptureScheduler.h"
+#include "ofxSonyCameraLog.h"
+#include <cstdlib>
+
+namespace {
+    uint64_t steadyMicros(std::chrono::steady_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+    }
+
+    // Sleeping overshoots by up to a scheduler tick, so wake this much early
+    // and spin the rest of the way to the deadline
+    const std::chrono::microseconds kSpinMargin(2000);
+
+    const std::chrono::milliseconds kDownloadPollInterval(1);
+}
+
+//--------------------------------------------------------------
+ofxSonyCameraCaptureScheduler::Sequence ofxSonyCameraCaptureScheduler::Sequence::intervalometer(std::chrono::microseconds interval, size_t shots) {
+    Sequence sequence;
+    sequence.interval = interval;
+    sequence.triggers = shots;
+    return sequence;
+}
+
+ofxSonyCameraCaptureScheduler::Sequence ofxSonyCameraCaptureScheduler::Sequence::burst(size_t shots, std::chrono::microseconds spacing) {
+    Sequence sequence;
+    sequence.triggers = 1;
+    sequence.shotsPerTrigger = shots;
+    sequence.shotSpacing = spacing;
+    return sequence;
+}
+
+ofxSonyCameraCaptureScheduler::Sequence ofxSonyCameraCaptureScheduler::Sequence::bracketed(const std::vector<PropertyValues>& steps, std::chrono::microseconds spacing) {
+    Sequence sequence;
+    sequence.triggers = 1;
+    sequence.shotsPerTrigger = steps.size();
+    sequence.shotSpacing = spacing;
+    sequence.bracket = steps;
+    return sequence;
+}
+
+//--------------------------------------------------------------
+ofxSonyCameraCaptureScheduler::ofxSonyCameraCaptureScheduler()
+    : mCamera(nullptr)
+    , mRunning(false)
+    , mStopping(false)
+    , mTotalAbsJitter(0) {
+}
+
+ofxSonyCameraCaptureScheduler::~ofxSonyCameraCaptureScheduler() {
+    stop();
+}
+
+bool ofxSonyCameraCaptureScheduler::start(ofxSonyCameraRemote* camera, const Sequence& sequence) {
+    if (mRunning) {
+        OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraCaptureScheduler", "Sequence already running");
+        return false;
+    }
+    if (!camera || sequence.shotsPerTrigger == 0 || sequence.interval.count() <= 0) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraCaptureScheduler", "Cannot start: no camera or empty sequence");
+        return false;
+    }
+
+    // Reap the thread of a sequence that ended by itself
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+
+    mCamera = camera;
+    mSequence = sequence;
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mHistory.clear();
+        mStats = Stats();
+        mTotalAbsJitter = 0;
+    }
+
+    mStopping = false;
+    mRunning = true;
+    mThread = std::thread(&ofxSonyCameraCaptureScheduler::threadedFunction, this);
+    return true;
+}
+
+void ofxSonyCameraCaptureScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mWaitMutex);
+        mStopping = true;
+    }
+    mWaitCondition.notify_all();
+
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+bool ofxSonyCameraCaptureScheduler::isRunning() const {
+    return mRunning;
+}
+
+void ofxSonyCameraCaptureScheduler::setShotCallback(std::function<void(const ShotRecord&)> callback) {
+    mShotCallback = callback;
+}
+
+std::vector<ofxSonyCameraCaptureScheduler::ShotRecord> ofxSonyCameraCaptureScheduler::getRecentShots() const {
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    return std::vector<ShotRecord>(mHistory.begin(), mHistory.end());
+}
+
+ofxSonyCameraCaptureScheduler::Stats ofxSonyCameraCaptureScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    return mStats;
+}
+
+void ofxSonyCameraCaptureScheduler::threadedFunction() {
+    const Sequence& sequence = mSequence;
+    uint64_t shotNumber = 0;
+
+    applyBracket(0);
+    Clock::time_point start = Clock::now();
+
+    for (size_t trigger = 0; sequence.triggers == 0 || trigger < sequence.triggers; trigger++) {
+        // Deadlines are offsets from the start, never from the previous shot
+        Clock::time_point triggerDeadline = start + sequence.interval * trigger;
+
+        for (size_t index = 0; index < sequence.shotsPerTrigger; index++) {
+            Clock::time_point deadline = triggerDeadline + sequence.shotSpacing * index;
+            if (!waitUntil(deadline)) {
+                mRunning = false;
+                return;
+            }
+
+            ShotRecord shot;
+            shot.shotNumber = ++shotNumber;
+            shot.trigger = trigger;
+            shot.shot = index;
+            shot.scheduledMicros = steadyMicros(deadline);
+
+            // A whole interval behind: drop the shot rather than bunching up
+            bool missed = index == 0 && Clock::now() >= triggerDeadline + sequence.interval;
+
+            if (!missed && sequence.overrun != OVERRUN_IGNORE && mCamera->getNumPendingDownloads() > 0) {
+                if (sequence.overrun == OVERRUN_SKIP) {
+                    missed = true;
+                } else if (!waitForDownload(deadline + sequence.downloadTimeout)) {
+                    if (mStopping) {
+                        mRunning = false;
+                        return;
+                    }
+                    OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraCaptureScheduler", "Download not completed after {} ms, firing anyway",
+                        sequence.downloadTimeout.count());
+                }
+            }
+
+            if (missed) {
+                shot.skipped = true;
+            } else {
+                Clock::time_point fired = Clock::now();
+                shot.error = mCamera->releaseShutter();
+                shot.firedMicros = steadyMicros(fired);
+                shot.jitterMicros = static_cast<int64_t>(shot.firedMicros) - static_cast<int64_t>(shot.scheduledMicros);
+            }
+            record(shot);
+
+            // Get the next bracket step in place before its deadline
+            if (sequence.bracket.size() > 1) {
+                applyBracket(index + 1 < sequence.shotsPerTrigger ? index + 1 : 0);
+            }
+        }
+    }
+
+    mRunning = false;
+}
+
+bool ofxSonyCameraCaptureScheduler::waitUntil(Clock::time_point deadline) {
+    {
+        std::unique_lock<std::mutex> lock(mWaitMutex);
+        mWaitCondition.wait_until(lock, deadline - kSpinMargin, [this]() { return mStopping.load(); });
+        if (mStopping) {
+            return false;
+        }
+    }
+
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    return !mStopping;
+}
+
+bool ofxSonyCameraCaptureScheduler::waitForDownload(Clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(mWaitMutex);
+    while (mCamera->getNumPendingDownloads() > 0) {
+        if (mStopping || Clock::now() >= deadline) {
+            return false;
+        }
+        mWaitCondition.wait_for(lock, kDownloadPollInterval);
+    }
+    return !mStopping;
+}
+
+void ofxSonyCameraCaptureScheduler::applyBracket(size_t shot) {
+    if (mSequence.bracket.empty()) {
+        return;
+    }
+    // Wait for the camera to report the values, so the shot isn't taken
+    // with the previous step's settings
+    const PropertyValues& values = mSequence.bracket[shot % mSequence.bracket.size()];
+    if (!mCamera->setPropertiesAndWait(values)) {
+        OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraCaptureScheduler", "Failed to apply bracket step {}", shot);
+    }
+}
+
+void ofxSonyCameraCaptureScheduler::record(ShotRecord& shot) {
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        if (shot.skipped) {
+            mStats.skipped++;
+        } else {
+            if (shot.error != CrError_None) {
+                mStats.failed++;
+            }
+            if (mStats.fired == 0) {
+                mStats.minJitterMicros = shot.jitterMicros;
+                mStats.maxJitterMicros = shot.jitterMicros;
+            }
+            mStats.minJitterMicros = std::min(mStats.minJitterMicros, shot.jitterMicros);
+            mStats.maxJitterMicros = std::max(mStats.maxJitterMicros, shot.jitterMicros);
+            mTotalAbsJitter += std::abs(shot.jitterMicros);
+            mStats.fired++;
+            mStats.avgAbsJitterMicros = mTotalAbsJitter / mStats.fired;
+        }
+
+        mHistory.push_back(shot);
+        if (mHistory.size() > kHistorySize) {
+            mHistory.pop_front();
+        }
+    }
+
+    if (shot.skipped) {
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraCaptureScheduler", "Skipped shot {}", shot.shotNumber);
+    }
+    if (mShotCallback) {
+        mShotCallback(shot);
+    }
+}
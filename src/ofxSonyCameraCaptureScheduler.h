@@ -0,0 +1,154 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxSonyCameraRemote.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+/**
+ * @brief Timelapse, burst and bracketing scheduler on its own thread
+ *
+ * Every shot has an absolute deadline on the steady clock, computed from the
+ * start of the sequence rather than from the previous shot, so timing errors
+ * never accumulate and the schedule keeps running when the application's
+ * frame rate drops or its window is hidden.
+ *
+ * A sequence is a series of triggers spaced by an interval, each firing one or
+ * more shots. Bracketed sequences apply a set of property values before each
+ * shot of a trigger, and wait for the camera to report them. The time every shot actually fired is recorded against
+ * its deadline.
+ */
+class ofxSonyCameraCaptureScheduler {
+public:
+    typedef std::vector<std::pair<CrInt32u, CrInt64u>> PropertyValues;
+
+    /**
+     * @brief What to do when a shot is due while the previous capture is still downloading
+     *
+     * Relies on ofxSonyCameraRemote::getNumPendingDownloads(), which only
+     * counts captures saved to the host; when the camera saves to its memory
+     * card only, every policy fires on time.
+     */
+    enum OverrunPolicy {
+        OVERRUN_IGNORE, // fire anyway
+        OVERRUN_SKIP,   // drop the shot
+        OVERRUN_QUEUE   // fire as soon as the download completes
+    };
+
+    struct Sequence {
+        std::chrono::microseconds interval = std::chrono::seconds(1); // between triggers
+        size_t triggers = 0;          // 0 runs until stop()
+        size_t shotsPerTrigger = 1;
+        std::chrono::microseconds shotSpacing = std::chrono::microseconds(0); // between shots of a trigger
+        std::vector<PropertyValues> bracket; // applied to successive shots of each trigger
+        OverrunPolicy overrun = OVERRUN_SKIP;
+        std::chrono::milliseconds downloadTimeout = std::chrono::seconds(30); // longest OVERRUN_QUEUE wait
+
+        /**
+         * @brief One shot every interval
+         */
+        static Sequence intervalometer(std::chrono::microseconds interval, size_t shots = 0);
+
+        /**
+         * @brief A single trigger of several shots
+         */
+        static Sequence burst(size_t shots, std::chrono::microseconds spacing);
+
+        /**
+         * @brief A single trigger with one shot per set of property values
+         */
+        static Sequence bracketed(const std::vector<PropertyValues>& steps, std::chrono::microseconds spacing);
+    };
+
+    struct ShotRecord {
+        uint64_t shotNumber = 0;
+        size_t trigger = 0;         // index of the trigger in the sequence
+        size_t shot = 0;            // index of the shot in its trigger
+        uint64_t scheduledMicros = 0; // deadline, in steady clock microseconds
+        uint64_t firedMicros = 0;     // just before SendCommand
+        int64_t jitterMicros = 0;     // fired minus scheduled
+        CrError error = CrError_None;
+        bool skipped = false;
+    };
+
+    struct Stats {
+        uint64_t fired = 0;
+        uint64_t skipped = 0;
+        uint64_t failed = 0;
+        int64_t minJitterMicros = 0;
+        int64_t maxJitterMicros = 0;
+        uint64_t avgAbsJitterMicros = 0;
+    };
+
+    static constexpr size_t kHistorySize = 1000;
+
+    ofxSonyCameraCaptureScheduler();
+    ~ofxSonyCameraCaptureScheduler();
+
+    /**
+     * @brief Start running a sequence
+     *
+     * The first trigger fires immediately.
+     *
+     * @param camera The connected camera to fire
+     * @param sequence The sequence to run
+     * @return false if already running or the sequence is empty
+     */
+    bool start(ofxSonyCameraRemote* camera, const Sequence& sequence);
+
+    /**
+     * @brief Stop the sequence and wait for the scheduler thread
+     */
+    void stop();
+
+    /**
+     * @brief Check if a sequence is running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Set a function called on the scheduler thread after every shot
+     *
+     * Must be called while stopped.
+     */
+    void setShotCallback(std::function<void(const ShotRecord&)> callback);
+
+    /**
+     * @brief Get the records of the last kHistorySize shots
+     */
+    std::vector<ShotRecord> getRecentShots() const;
+
+    Stats getStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void threadedFunction();
+
+    // Sleep until the deadline, then spin the last stretch; false if stopped
+    bool waitUntil(Clock::time_point deadline);
+
+    // Wait for pending downloads to drain; false if it timed out or stopped
+    bool waitForDownload(Clock::time_point deadline);
+
+    void applyBracket(size_t shot);
+    void record(ShotRecord& shot);
+
+    ofxSonyCameraRemote* mCamera;
+    Sequence mSequence;
+    std::function<void(const ShotRecord&)> mShotCallback;
+
+    std::thread mThread;
+    std::atomic<bool> mRunning;  // cleared by the thread when the sequence ends
+    std::atomic<bool> mStopping;
+    std::mutex mWaitMutex;
+    std::condition_variable mWaitCondition;
+
+    std::deque<ShotRecord> mHistory;
+    Stats mStats;
+    uint64_t mTotalAbsJitter;
+    mutable std::mutex mStatsMutex;
+};
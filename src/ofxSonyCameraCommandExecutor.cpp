@@ -0,0 +1,171 @@
+#include "ofxSonyCameraCommandExecutor.h"
+#include <algorithm>
+
+ofxSonyCameraCommandExecutor::ofxSonyCameraCommandExecutor()
+    : mHead(&mStub)
+    , mTail(&mStub)
+    , mPending(0)
+    , mSubmitting(0)
+    , mSleeping(false)
+    , mRunning(false)
+    , mIdlePeriod(100)
+    , mWakeAt(std::chrono::steady_clock::time_point::max()) {
+    mStub.next.store(nullptr, std::memory_order_relaxed);
+}
+
+ofxSonyCameraCommandExecutor::~ofxSonyCameraCommandExecutor() {
+    stop();
+}
+
+void ofxSonyCameraCommandExecutor::start() {
+    if (mRunning.exchange(true)) {
+        return;
+    }
+    mThread = std::thread(&ofxSonyCameraCommandExecutor::threadedFunction, this);
+}
+
+void ofxSonyCameraCommandExecutor::stop() {
+    if (!mRunning.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+    }
+    mWakeCondition.notify_one();
+
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+
+    // Run anything submitted while the thread was shutting down, including
+    // the commands of submitters that saw it running but haven't pushed yet
+    while (mPending.load() > 0 || mSubmitting.load() > 0) {
+        Node* node = pop();
+        if (!node) {
+            std::this_thread::yield();
+            continue;
+        }
+        mPending.fetch_sub(1);
+        node->command();
+        delete node;
+    }
+}
+
+bool ofxSonyCameraCommandExecutor::isRunning() const {
+    return mRunning.load();
+}
+
+bool ofxSonyCameraCommandExecutor::isCommandThread() const {
+    return std::this_thread::get_id() == mThread.get_id();
+}
+
+bool ofxSonyCameraCommandExecutor::submit(std::function<void()> command) {
+    // Announce the submission before checking the flag, so stop() either
+    // sees it and waits for the command, or this sees the thread stopped
+    mSubmitting.fetch_add(1);
+    if (!mRunning.load()) {
+        mSubmitting.fetch_sub(1);
+        return false;
+    }
+
+    // Counted before the push: the consumer waits out a half-done push
+    Node* node = new Node();
+    node->command = std::move(command);
+    mPending.fetch_add(1);
+    push(node);
+    mSubmitting.fetch_sub(1);
+
+    // Only take the lock when the thread might be waiting on it
+    if (mSleeping.load()) {
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+        }
+        mWakeCondition.notify_one();
+    }
+    return true;
+}
+
+void ofxSonyCameraCommandExecutor::setIdleTask(std::function<void()> task, std::chrono::milliseconds period) {
+    mIdleTask = task;
+    mIdlePeriod = period;
+}
+
+void ofxSonyCameraCommandExecutor::wakeAt(std::chrono::steady_clock::time_point time) {
+    mWakeAt = std::min(mWakeAt, time);
+}
+
+void ofxSonyCameraCommandExecutor::threadedFunction() {
+    while (true) {
+        // Run everything that is queued
+        while (mPending.load() > 0) {
+            Node* node = pop();
+            if (!node) {
+                // A producer is halfway through a push
+                std::this_thread::yield();
+                continue;
+            }
+            mPending.fetch_sub(1);
+            node->command();
+            delete node;
+        }
+
+        if (mIdleTask) {
+            mIdleTask();
+        }
+
+        if (!mRunning.load() && mPending.load() == 0) {
+            break;
+        }
+
+        // Sleep until a command arrives, the idle period expires or the idle
+        // task asked to run sooner
+        auto wake = std::min(std::chrono::steady_clock::now() + mIdlePeriod, mWakeAt);
+        mWakeAt = std::chrono::steady_clock::time_point::max();
+        std::unique_lock<std::mutex> lock(mWakeMutex);
+        mSleeping.store(true);
+        mWakeCondition.wait_until(lock, wake, [this]() {
+            return mPending.load() > 0 || !mRunning.load();
+        });
+        mSleeping.store(false);
+    }
+}
+
+void ofxSonyCameraCommandExecutor::push(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = mHead.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+ofxSonyCameraCommandExecutor::Node* ofxSonyCameraCommandExecutor::pop() {
+    Node* tail = mTail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+
+    // Skip over the stub node
+    if (tail == &mStub) {
+        if (!next) {
+            return nullptr;
+        }
+        mTail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next) {
+        mTail = next;
+        return tail;
+    }
+
+    // tail is the last node; only take it once no push is in progress
+    if (tail != mHead.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    push(&mStub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+        mTail = next;
+        return tail;
+    }
+    return nullptr;
+}
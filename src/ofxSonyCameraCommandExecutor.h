@@ -0,0 +1,102 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * @brief Dedicated thread that runs camera commands in submission order
+ *
+ * Commands are pushed onto a lock-free multi-producer single-consumer queue,
+ * so submitting from the application thread never waits on a command that is
+ * talking to the camera. The thread only takes a lock to go to sleep when the
+ * queue is empty, and producers only take it to wake a sleeping thread.
+ *
+ * An optional idle task runs whenever the thread wakes up, at least once per
+ * idle period, for housekeeping such as flushing queued property writes.
+ */
+class ofxSonyCameraCommandExecutor {
+public:
+    ofxSonyCameraCommandExecutor();
+    ~ofxSonyCameraCommandExecutor();
+
+    /**
+     * @brief Start the command thread
+     */
+    void start();
+
+    /**
+     * @brief Run the remaining commands and stop the command thread
+     */
+    void stop();
+
+    /**
+     * @brief Check if the command thread is running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Check if the caller is running on the command thread
+     */
+    bool isCommandThread() const;
+
+    /**
+     * @brief Queue a command to run on the command thread
+     *
+     * @param command The function to run
+     * @return false if the thread is not running and the command was dropped
+     */
+    bool submit(std::function<void()> command);
+
+    /**
+     * @brief Set a task to run on the command thread between commands
+     *
+     * Must be called while the thread is stopped.
+     *
+     * @param task The function to run
+     * @param period The longest time the thread sleeps before running it
+     */
+    void setIdleTask(std::function<void()> task, std::chrono::milliseconds period);
+
+    /**
+     * @brief Run the idle task again by a deadline sooner than its period
+     *
+     * Only from the command thread, e.g. by a command or the idle task
+     * itself; the deadline is forgotten once the thread has woken up.
+     *
+     * @param time When the idle task should run at the latest
+     */
+    void wakeAt(std::chrono::steady_clock::time_point time);
+
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        std::function<void()> command;
+    };
+
+    void threadedFunction();
+
+    // Vyukov intrusive MPSC queue; mTail and mStub belong to the consumer
+    void push(Node* node);
+    Node* pop();
+
+    std::atomic<Node*> mHead;
+    Node* mTail;
+    Node mStub;
+
+    std::atomic<size_t> mPending;
+    std::atomic<size_t> mSubmitting; // submit() calls past the running check
+    std::atomic<bool> mSleeping;
+    std::atomic<bool> mRunning;
+
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCondition;
+    std::thread mThread;
+
+    std::function<void()> mIdleTask;
+    std::chrono::milliseconds mIdlePeriod;
+    std::chrono::steady_clock::time_point mWakeAt; // command thread only
+};
@@ -0,0 +1,43 @@
+#include "ofxSonyCameraErrorTable.h"
+
+namespace ofxSonyCameraError {
+
+    const Info& lookup(CrInt32u code) {
+        static const Info kUnknown = { 0, "Unknown", CATEGORY_UNKNOWN, false, "" };
+
+        if (const Info* info = find(code)) {
+            return *info;
+        }
+
+        // Errors are grouped in blocks of 0x100 from CrError_Generic; every
+        // code from CrError_Application up belongs to the application
+        const Info* category = nullptr;
+        if (code >= SCRSDK::CrError_Application && code <= 0xFFFF) {
+            category = find(SCRSDK::CrError_Application);
+        } else if (code >= SCRSDK::CrError_Generic && code < SCRSDK::CrError_Application) {
+            category = find(code & 0xFF00);
+        } else if ((code & 0xFFFF0000) == SCRSDK::CrWarning_Unknown) {
+            category = find(SCRSDK::CrWarning_Unknown);
+        }
+        return category ? *category : kUnknown;
+    }
+
+    const char* getCategoryName(Category category) {
+        switch (category) {
+            case CATEGORY_NONE: return "None";
+            case CATEGORY_GENERIC: return "Generic";
+            case CATEGORY_FILE: return "File";
+            case CATEGORY_CONNECTION: return "Connection";
+            case CATEGORY_MEMORY: return "Memory";
+            case CATEGORY_API: return "API";
+            case CATEGORY_INIT: return "Initialization";
+            case CATEGORY_POLLING: return "Polling";
+            case CATEGORY_ADAPTOR: return "Adaptor";
+            case CATEGORY_DEVICE: return "Device";
+            case CATEGORY_APPLICATION: return "Application";
+            case CATEGORY_WARNING: return "Warning";
+            case CATEGORY_UNKNOWN: return "Unknown";
+        }
+        return "Unknown";
+    }
+}
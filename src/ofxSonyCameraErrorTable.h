@@ -0,0 +1,211 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CrTypes.h"
+#include "../libs/CRSDK/include/CrError.h"
+#include <cstddef>
+
+/**
+ * @brief Compile-time description of SDK error and warning codes
+ *
+ * A constexpr table, sorted by code, records for every known CrError and
+ * CrWarning its name, category, whether it is worth retrying and what to do
+ * about it. lookup() finds a code by binary search, so code that has to
+ * decide quickly, such as the reconnection loop, can ask whether an error is
+ * transient without range checks or string formatting.
+ */
+namespace ofxSonyCameraError {
+
+    enum Category {
+        CATEGORY_NONE,        // CrError_None
+        CATEGORY_GENERIC,
+        CATEGORY_FILE,
+        CATEGORY_CONNECTION,
+        CATEGORY_MEMORY,
+        CATEGORY_API,
+        CATEGORY_INIT,
+        CATEGORY_POLLING,
+        CATEGORY_ADAPTOR,     // USB or network adaptor, including enumeration
+        CATEGORY_DEVICE,
+        CATEGORY_APPLICATION,
+        CATEGORY_WARNING,     // a CrWarning, reported through OnWarning
+        CATEGORY_UNKNOWN
+    };
+
+    struct Info {
+        CrInt32u code;
+        const char* name;
+        Category category;
+        bool retryable; // the same call may succeed later without user action
+        const char* action;
+    };
+
+    // In the SDK's order. Most codes are numbered implicitly by their position
+    // in the SDK's enums, so the table is sorted below rather than by hand
+    constexpr Info kEntries[] = {
+        { SCRSDK::CrError_None, "CrError_None", CATEGORY_NONE, false, "" },
+
+        { SCRSDK::CrError_Generic,                          "CrError_Generic_Unknown",                  CATEGORY_GENERIC, true,  "Retry; if it persists, restart the camera" },
+        { SCRSDK::CrError_Generic_Notimpl,                  "CrError_Generic_Notimpl",                  CATEGORY_GENERIC, false, "This SDK build doesn't implement the call" },
+        { SCRSDK::CrError_Generic_Abort,                    "CrError_Generic_Abort",                    CATEGORY_GENERIC, true,  "The operation was aborted; retry it" },
+        { SCRSDK::CrError_Generic_NotSupported,             "CrError_Generic_NotSupported",             CATEGORY_GENERIC, false, "The camera doesn't support this; check its model and firmware" },
+        { SCRSDK::CrError_Generic_SeriousErrorNotSupported, "CrError_Generic_SeriousErrorNotSupported", CATEGORY_GENERIC, false, "Restart the camera" },
+        { SCRSDK::CrError_Generic_InvalidHandle,            "CrError_Generic_InvalidHandle",            CATEGORY_GENERIC, false, "The device handle is stale; connect again" },
+        { SCRSDK::CrError_Generic_InvalidParameter,         "CrError_Generic_InvalidParameter",         CATEGORY_GENERIC, false, "Invalid parameter; this could be an SDK compatibility issue" },
+
+        { SCRSDK::CrError_File,                         "CrError_File_Unknown",                CATEGORY_FILE, false, "Check the save folder" },
+        { SCRSDK::CrError_File_IllegalOperation,        "CrError_File_IllegalOperation",       CATEGORY_FILE, false, "Check the save folder" },
+        { SCRSDK::CrError_File_IllegalParameter,        "CrError_File_IllegalParameter",       CATEGORY_FILE, false, "Check the save path and file name prefix" },
+        { SCRSDK::CrError_File_EOF,                     "CrError_File_EOF",                    CATEGORY_FILE, false, "The file ended early; download it again" },
+        { SCRSDK::CrError_File_OutOfRange,              "CrError_File_OutOfRange",             CATEGORY_FILE, false, "Check the save folder" },
+        { SCRSDK::CrError_File_NotFound,                "CrError_File_NotFound",               CATEGORY_FILE, false, "The file no longer exists" },
+        { SCRSDK::CrError_File_DirNotFound,             "CrError_File_DirNotFound",            CATEGORY_FILE, false, "Create the save folder" },
+        { SCRSDK::CrError_File_AlreadyOpened,           "CrError_File_AlreadyOpened",          CATEGORY_FILE, true,  "Close the file in other applications" },
+        { SCRSDK::CrError_File_PermissionDenied,        "CrError_File_PermissionDenied",       CATEGORY_FILE, false, "Allow writing to the save folder" },
+        { SCRSDK::CrError_File_StorageFull,             "CrError_File_StorageFull",            CATEGORY_FILE, false, "Free space on the computer's disk" },
+        { SCRSDK::CrError_File_AlreadyExists,           "CrError_File_AlreadyExists",          CATEGORY_FILE, false, "Change the file name prefix or save folder" },
+        { SCRSDK::CrError_File_TooManyOpenedFiles,      "CrError_File_TooManyOpenedFiles",     CATEGORY_FILE, true,  "Close files, or raise the open file limit" },
+        { SCRSDK::CrError_File_ReadOnly,                "CrError_File_ReadOnly",               CATEGORY_FILE, false, "Allow writing to the save folder" },
+        { SCRSDK::CrError_File_CantOpen,                "CrError_File_CantOpen",               CATEGORY_FILE, false, "Check the save folder" },
+        { SCRSDK::CrError_File_CantClose,               "CrError_File_CantClose",              CATEGORY_FILE, false, "Check the save folder" },
+        { SCRSDK::CrError_File_CantDelete,              "CrError_File_CantDelete",             CATEGORY_FILE, false, "Check the save folder" },
+        { SCRSDK::CrError_File_CantRead,                "CrError_File_CantRead",               CATEGORY_FILE, false, "Check the save folder" },
+        { SCRSDK::CrError_File_CantWrite,               "CrError_File_CantWrite",              CATEGORY_FILE, false, "Check the disk and the save folder's permissions" },
+        { SCRSDK::CrError_File_CantCreateDir,           "CrError_File_CantCreateDir",          CATEGORY_FILE, false, "Allow writing to the save folder's parent" },
+        { SCRSDK::CrError_File_OperationAbortedByUser,  "CrError_File_OperationAbortedByUser", CATEGORY_FILE, false, "" },
+        { SCRSDK::CrError_File_UnsupportedOperation,    "CrError_File_UnsupportedOperation",   CATEGORY_FILE, false, "The file system doesn't support this" },
+        { SCRSDK::CrError_File_NotYetCompleted,         "CrError_File_NotYetCompleted",        CATEGORY_FILE, true,  "Wait for the current transfer to finish" },
+        { SCRSDK::CrError_File_Invalid,                 "CrError_File_Invalid",                CATEGORY_FILE, false, "Check the save path" },
+        { SCRSDK::CrError_File_StorageNotExist,         "CrError_File_StorageNotExist",        CATEGORY_FILE, false, "Insert a memory card or pick another save destination" },
+        { SCRSDK::CrError_File_SharingViolation,        "CrError_File_SharingViolation",       CATEGORY_FILE, true,  "Close the file in other applications" },
+        { SCRSDK::CrError_File_Rotation,                "CrError_File_Rotation",               CATEGORY_FILE, false, "Check the save folder" },
+        { SCRSDK::CrError_File_SameNameFull,            "CrError_File_SameNameFull",           CATEGORY_FILE, false, "Too many files with the same name; change the prefix" },
+
+        { SCRSDK::CrError_Connect,                 "CrError_Connect_Unknown",         CATEGORY_CONNECTION, true,  "Check the cable or network" },
+        { SCRSDK::CrError_Connect_Connect,         "CrError_Connect_Connect",         CATEGORY_CONNECTION, true,  "Check the cable or network" },
+        { SCRSDK::CrError_Connect_Release,         "CrError_Connect_Release",         CATEGORY_CONNECTION, true,  "" },
+        { SCRSDK::CrError_Connect_GetProperty,     "CrError_Connect_GetProperty",     CATEGORY_CONNECTION, true,  "Retry once the camera is idle" },
+        { SCRSDK::CrError_Connect_SendCommand,     "CrError_Connect_SendCommand",     CATEGORY_CONNECTION, true,  "Retry once the camera is idle" },
+        { SCRSDK::CrError_Connect_HandlePlugin,    "CrError_Connect_HandlePlugin",    CATEGORY_CONNECTION, false, "Check that the SDK's adapter libraries are installed next to the app" },
+        { SCRSDK::CrError_Connect_Disconnected,    "CrError_Connect_Disconnected",    CATEGORY_CONNECTION, true,  "Check the cable or network" },
+        { SCRSDK::CrError_Connect_TimeOut,         "CrError_Connect_TimeOut",         CATEGORY_CONNECTION, true,  "Check the cable or network" },
+        { SCRSDK::CrError_Reconnect_TimeOut,       "CrError_Reconnect_TimeOut",       CATEGORY_CONNECTION, true,  "Check the cable or network" },
+        { SCRSDK::CrError_Connect_FailRejected,    "CrError_Connect_FailRejected",    CATEGORY_CONNECTION, false, "Connection rejected by camera; set it to PC Remote mode" },
+        { SCRSDK::CrError_Connect_FailBusy,        "CrError_Connect_FailBusy",        CATEGORY_CONNECTION, true,  "Camera is busy; close other applications connected to it" },
+        { SCRSDK::CrError_Connect_FailUnspecified, "CrError_Connect_FailUnspecified", CATEGORY_CONNECTION, true,  "Restart the camera if it keeps failing" },
+        { SCRSDK::CrError_Connect_Cancel,          "CrError_Connect_Cancel",          CATEGORY_CONNECTION, false, "" },
+
+        { SCRSDK::CrError_Memory,                "CrError_Memory_Unknown",        CATEGORY_MEMORY, false, "Free memory on the computer" },
+        { SCRSDK::CrError_Memory_OutOfMemory,    "CrError_Memory_OutOfMemory",    CATEGORY_MEMORY, false, "Free memory on the computer" },
+        { SCRSDK::CrError_Memory_InvalidPointer, "CrError_Memory_InvalidPointer", CATEGORY_MEMORY, false, "An addon bug; please report it" },
+        { SCRSDK::CrError_Memory_Insufficient,   "CrError_Memory_Insufficient",   CATEGORY_MEMORY, true,  "The buffer was too small; retry" },
+
+        { SCRSDK::CrError_Api,               "CrError_Api_Unknown",       CATEGORY_API, false, "" },
+        { SCRSDK::CrError_Api_Insufficient,  "CrError_Api_Insufficient",  CATEGORY_API, false, "An addon bug; please report it" },
+        { SCRSDK::CrError_Api_InvalidCalled, "CrError_Api_InvalidCalled", CATEGORY_API, false, "Called in the wrong state, e.g. before connecting" },
+
+        { SCRSDK::CrError_Init, "CrError_Init_Unknown", CATEGORY_INIT, false, "Check that the SDK libraries load (see setup() messages)" },
+
+        { SCRSDK::CrError_Polling,                      "CrError_Polling_Unknown",              CATEGORY_POLLING, false, "" },
+        { SCRSDK::CrError_Polling_InvalidVal_Intervals, "CrError_Polling_InvalidVal_Intervals", CATEGORY_POLLING, false, "" },
+
+        { SCRSDK::CrError_Adaptor,                 "CrError_Adaptor_Unknown",         CATEGORY_ADAPTOR, true,  "Check that the camera is in PC Remote mode" },
+        { SCRSDK::CrError_Adaptor_InvaildProperty, "CrError_Adaptor_InvaildProperty", CATEGORY_ADAPTOR, false, "" },
+        { SCRSDK::CrError_Adaptor_GetInfo,         "CrError_Adaptor_GetInfo",         CATEGORY_ADAPTOR, true,  "Reconnect the cable" },
+        { SCRSDK::CrError_Adaptor_Create,          "CrError_Adaptor_Create",          CATEGORY_ADAPTOR, true,
+            "USB enumeration failed: set the camera to PC Remote, try another port, and check no other app (e.g. Image Capture) holds it" },
+        { SCRSDK::CrError_Adaptor_SendCommand,     "CrError_Adaptor_SendCommand",     CATEGORY_ADAPTOR, true,  "Reconnect the cable" },
+        { SCRSDK::CrError_Adaptor_HandlePlugin,    "CrError_Adaptor_HandlePlugin",    CATEGORY_ADAPTOR, false, "Check that the SDK's adapter libraries are installed next to the app" },
+        { SCRSDK::CrError_Adaptor_CreateDevice,    "CrError_Adaptor_CreateDevice",    CATEGORY_ADAPTOR, true,  "Reconnect the cable" },
+        { SCRSDK::CrError_Adaptor_EnumDevice,      "CrError_Adaptor_EnumDevice",      CATEGORY_ADAPTOR, true,  "Connect the camera and set it to PC Remote mode" },
+        { SCRSDK::CrError_Adaptor_Reset,           "CrError_Adaptor_Reset",           CATEGORY_ADAPTOR, true,  "Reconnect the cable" },
+        { SCRSDK::CrError_Adaptor_Read,            "CrError_Adaptor_Read",            CATEGORY_ADAPTOR, true,  "Reconnect the cable" },
+        { SCRSDK::CrError_Adaptor_Phase,           "CrError_Adaptor_Phase",           CATEGORY_ADAPTOR, true,  "" },
+        { SCRSDK::CrError_Adaptor_DataToWiaItem,   "CrError_Adaptor_DataToWiaItem",   CATEGORY_ADAPTOR, false, "" },
+        { SCRSDK::CrError_Adaptor_DeviceBusy,      "CrError_Adaptor_DeviceBusy",      CATEGORY_ADAPTOR, true,  "Camera is busy; close other applications connected to it" },
+        { SCRSDK::CrError_Adaptor_Escape,          "CrError_Adaptor_Escape",          CATEGORY_ADAPTOR, false, "" },
+
+        { SCRSDK::CrError_Device, "CrError_Device_Unknown", CATEGORY_DEVICE, true, "Check the camera's screen for a message" },
+
+        { SCRSDK::CrError_Application, "CrError_Application_Unknown", CATEGORY_APPLICATION, false, "" },
+
+        { SCRSDK::CrWarning_Unknown,               "CrWarning_Unknown",               CATEGORY_WARNING, true,  "" },
+        { SCRSDK::CrWarning_Connect_Reconnected,   "CrWarning_Connect_Reconnected",   CATEGORY_WARNING, true,  "" },
+        { SCRSDK::CrWarning_Connect_Reconnecting,  "CrWarning_Connect_Reconnecting",  CATEGORY_WARNING, true,  "" },
+        { SCRSDK::CrWarning_File_StorageFull,      "CrWarning_File_StorageFull",      CATEGORY_WARNING, false, "Free space on the computer's disk" },
+        { SCRSDK::CrWarning_SetFileName_Failed,    "CrWarning_SetFileName_Failed",    CATEGORY_WARNING, false, "Check the file name prefix" },
+        { SCRSDK::CrWarning_GetImage_Failed,       "CrWarning_GetImage_Failed",       CATEGORY_WARNING, true,  "" },
+        { SCRSDK::CrWarning_FailedToSetCWB,        "CrWarning_FailedToSetCWB",        CATEGORY_WARNING, true,  "Point the camera at a white target and retry" },
+        { SCRSDK::CrWarning_NetworkErrorOccurred,  "CrWarning_NetworkErrorOccurred",  CATEGORY_WARNING, true,  "Check the network" },
+        { SCRSDK::CrWarning_NetworkErrorRecovered, "CrWarning_NetworkErrorRecovered", CATEGORY_WARNING, true,  "" },
+        { SCRSDK::CrWarning_Format_Failed,         "CrWarning_Format_Failed",         CATEGORY_WARNING, false, "Check the memory card" },
+        { SCRSDK::CrWarning_Format_Invalid,        "CrWarning_Format_Invalid",        CATEGORY_WARNING, false, "Check the memory card" },
+        { SCRSDK::CrWarning_Format_Complete,       "CrWarning_Format_Complete",       CATEGORY_WARNING, false, "" },
+        { SCRSDK::CrWarning_Frame_NotUpdated,      "CrWarning_Frame_NotUpdated",      CATEGORY_WARNING, true,  "" },
+        { SCRSDK::CrWarning_Exposure_Started,      "CrWarning_Exposure_Started",      CATEGORY_WARNING, false, "" },
+    };
+
+    constexpr size_t kTableSize = sizeof(kEntries) / sizeof(kEntries[0]);
+
+    struct Table {
+        Info entries[kTableSize];
+    };
+
+    constexpr Table sortByCode() {
+        Table table{};
+        for (size_t i = 0; i < kTableSize; i++) {
+            size_t j = i;
+            for (; j > 0 && table.entries[j - 1].code > kEntries[i].code; j--) {
+                table.entries[j] = table.entries[j - 1];
+            }
+            table.entries[j] = kEntries[i];
+        }
+        return table;
+    }
+
+    constexpr Table kTable = sortByCode();
+
+    constexpr bool isUnique(size_t index = 1) {
+        return index >= kTableSize || (kTable.entries[index - 1].code < kTable.entries[index].code && isUnique(index + 1));
+    }
+    static_assert(isUnique(), "ofxSonyCameraError::kEntries lists a code twice");
+
+    /**
+     * @brief Look up a code by binary search
+     *
+     * @return The table entry, or nullptr for codes not in the table
+     */
+    constexpr const Info* find(CrInt32u code) {
+        size_t first = 0;
+        size_t last = kTableSize;
+        while (first < last) {
+            size_t middle = first + (last - first) / 2;
+            if (kTable.entries[middle].code == code) {
+                return &kTable.entries[middle];
+            }
+            if (kTable.entries[middle].code < code) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Look up a code, falling back to its category
+     *
+     * Codes missing from the table, e.g. ones added by a newer SDK, resolve to
+     * their category's "Unknown" entry, whose code then differs from the one
+     * asked for. Codes outside every category resolve to CATEGORY_UNKNOWN.
+     */
+    const Info& lookup(CrInt32u code);
+
+    /**
+     * @brief Whether retrying the same call may succeed, e.g. after a disconnect
+     */
+    inline bool isRetryable(CrInt32u code) {
+        return lookup(code).retryable;
+    }
+
+    const char* getCategoryName(Category category);
+}
@@ -0,0 +1,30 @@
+#include "ofxSonyCameraEventQueue.h"
+
+ofxSonyCameraEventQueue::ofxSonyCameraEventQueue()
+    : mDropped(0)
+    , mPropertyOverflow(false) {
+}
+
+bool ofxSonyCameraEventQueue::push(const ofxSonyCameraEvent& event) {
+    if (mRing.push([&event](ofxSonyCameraEvent& slot) { slot = event; })) {
+        return true;
+    }
+
+    mDropped.fetch_add(1, std::memory_order_relaxed);
+    if (event.type == ofxSonyCameraEvent::EVENT_PROPERTY_CHANGED) {
+        mPropertyOverflow.store(true, std::memory_order_release);
+    }
+    return false;
+}
+
+bool ofxSonyCameraEventQueue::pop(ofxSonyCameraEvent& event) {
+    return mRing.pop([&event](const ofxSonyCameraEvent& slot) { event = slot; });
+}
+
+uint64_t ofxSonyCameraEventQueue::getNumDropped() const {
+    return mDropped.load(std::memory_order_relaxed);
+}
+
+bool ofxSonyCameraEventQueue::takePropertyOverflow() {
+    return mPropertyOverflow.exchange(false, std::memory_order_acq_rel);
+}
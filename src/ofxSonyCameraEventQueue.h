@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CrTypes.h"
+#include "ofxSonyCameraRing.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Camera event, as pushed from the SDK's callback thread
+ *
+ * Plain data with fixed-size storage, so pushing one never allocates.
+ */
+struct ofxSonyCameraEvent {
+    enum Type {
+        EVENT_CONNECTED,
+        EVENT_DISCONNECTED,
+        EVENT_PROPERTY_CHANGED,
+        EVENT_DOWNLOAD_COMPLETE,
+        EVENT_WARNING,
+        EVENT_ERROR,
+        EVENT_DEVICE_ARRIVED,
+        EVENT_DEVICE_LEFT,
+        EVENT_STATE_CHANGED
+    };
+
+    static constexpr size_t kMaxCodes = 32;
+    static constexpr size_t kMaxFilename = 256;
+
+    Type type;
+
+    // Connection version, disconnect/warning/error code, download type,
+    // USB vendor and product id (vendor << 16 | product) for device events,
+    // or the new connection state
+    CrInt32u value;
+
+    // EVENT_PROPERTY_CHANGED: the changed codes; 0 means every property may have changed
+    CrInt32u numCodes;
+    CrInt32u codes[kMaxCodes];
+
+    // EVENT_DOWNLOAD_COMPLETE: null-terminated, truncated to fit
+    char filename[kMaxFilename];
+};
+
+/**
+ * @brief Bounded lock-free queue carrying events from SDK threads to the app
+ *
+ * Any number of threads can push; one thread pops. Built on
+ * ofxSonyCameraRing, so a push is a compare-and-swap plus a copy into
+ * preallocated storage, without locks or allocation. When the queue is full
+ * the event is dropped and counted.
+ */
+class ofxSonyCameraEventQueue {
+public:
+    static constexpr size_t kCapacity = 256; // must be a power of two
+
+    ofxSonyCameraEventQueue();
+
+    /**
+     * @brief Push an event from any thread
+     *
+     * @return false if the queue was full and the event was dropped
+     */
+    bool push(const ofxSonyCameraEvent& event);
+
+    /**
+     * @brief Pop the oldest event; only call from the consuming thread
+     *
+     * @return false if the queue is empty
+     */
+    bool pop(ofxSonyCameraEvent& event);
+
+    /**
+     * @brief Get the number of events dropped because the queue was full
+     */
+    uint64_t getNumDropped() const;
+
+    /**
+     * @brief Check and clear whether a property event was dropped since the last call
+     *
+     * Lets the consumer treat every property as changed after an overflow.
+     */
+    bool takePropertyOverflow();
+
+private:
+    ofxSonyCameraRing<ofxSonyCameraEvent, kCapacity> mRing;
+    std::atomic<uint64_t> mDropped;
+    std::atomic<bool> mPropertyOverflow;
+};
@@ -0,0 +1,433 @@
+#include "ofxSonyCameraJpegDecoder.h"
+#include "ofxSonyCameraLog.h"
+#include "FreeImage.h"
+#include <chrono>
+#include <cstring>
+
+#if defined(OFX_SONY_CAMERA_USE_TURBOJPEG) && !defined(OFX_SONY_CAMERA_NO_TURBOJPEG)
+#include <turbojpeg.h>
+#elif !defined(OFX_SONY_CAMERA_NO_TURBOJPEG)
+#include "ofxSonyCameraSdk.h"
+#include <dlfcn.h>
+#endif
+
+namespace {
+#ifndef OFX_SONY_CAMERA_NO_TURBOJPEG
+#ifndef OFX_SONY_CAMERA_USE_TURBOJPEG
+    // The parts of turbojpeg.h used here, so libturbojpeg can be loaded at runtime
+    typedef void* tjhandle;
+    const int TJPF_RGB = 0;
+    const int TJPF_GRAY = 6;
+    const int TJCS_GRAY = 2;
+    const int TJFLAG_FASTDCT = 2048;
+#endif
+
+    struct TurboJpegApi {
+        tjhandle (*initDecompress)() = nullptr;
+        int (*decompressHeader3)(tjhandle, const unsigned char*, unsigned long, int*, int*, int*, int*) = nullptr;
+        int (*decompress2)(tjhandle, const unsigned char*, unsigned long, unsigned char*, int, int, int, int, int) = nullptr;
+        int (*destroy)(tjhandle) = nullptr;
+        bool loaded = false;
+    };
+
+    TurboJpegApi loadTurboJpeg() {
+        TurboJpegApi api;
+#ifdef OFX_SONY_CAMERA_USE_TURBOJPEG
+        api.initDecompress = tjInitDecompress;
+        api.decompressHeader3 = tjDecompressHeader3;
+        api.decompress2 = tjDecompress2;
+        api.destroy = tjDestroy;
+        api.loaded = true;
+#else
+        std::string path;
+        void* handle = nullptr;
+        for (const char* name : { "libturbojpeg.dylib", "libturbojpeg.0.dylib", "libturbojpeg.so.0", "libturbojpeg.so" }) {
+            path = ofxSonyCameraSdk::findLibrary(name);
+            if (!path.empty()) {
+                handle = dlopen(path.c_str(), RTLD_LAZY);
+            }
+            if (handle) {
+                break;
+            }
+        }
+        if (!handle) {
+            OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraJpegDecoder", "libturbojpeg not found, decoding with FreeImage");
+            return api;
+        }
+
+        api.initDecompress = (decltype(api.initDecompress))dlsym(handle, "tjInitDecompress");
+        api.decompressHeader3 = (decltype(api.decompressHeader3))dlsym(handle, "tjDecompressHeader3");
+        api.decompress2 = (decltype(api.decompress2))dlsym(handle, "tjDecompress2");
+        api.destroy = (decltype(api.destroy))dlsym(handle, "tjDestroy");
+        api.loaded = api.initDecompress && api.decompressHeader3 && api.decompress2 && api.destroy;
+        if (!api.loaded) {
+            OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraJpegDecoder", "{} lacks the TurboJPEG API, decoding with FreeImage", path);
+            dlclose(handle);
+            return api;
+        }
+
+        // Kept loaded for the rest of the process, like the thread handles using it
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraJpegDecoder", "Decoding with libjpeg-turbo from {}", path);
+#endif
+        return api;
+    }
+
+    const TurboJpegApi& getTurboJpeg() {
+        static const TurboJpegApi api = loadTurboJpeg();
+        return api;
+    }
+
+    // One decompressor per thread, created on first use
+    struct TurboJpegHandle {
+        tjhandle handle = getTurboJpeg().initDecompress();
+        ~TurboJpegHandle() {
+            if (handle) {
+                getTurboJpeg().destroy(handle);
+            }
+        }
+    };
+
+    bool decodeTurboJpeg(const unsigned char* data, size_t size, ofPixels& pixels, int scale) {
+        thread_local TurboJpegHandle decompressor;
+        const TurboJpegApi& api = getTurboJpeg();
+        if (!decompressor.handle) {
+            return false;
+        }
+
+        int width, height, subsampling, colorspace;
+        if (api.decompressHeader3(decompressor.handle, data, size, &width, &height, &subsampling, &colorspace) != 0) {
+            return false;
+        }
+
+        // Same rounding as TJSCALED()
+        int scaledWidth = (width + scale - 1) / scale;
+        int scaledHeight = (height + scale - 1) / scale;
+        bool gray = colorspace == TJCS_GRAY;
+
+        // No-op when the buffer already has this size and format
+        pixels.allocate(scaledWidth, scaledHeight, gray ? OF_PIXELS_GRAY : OF_PIXELS_RGB);
+
+        return api.decompress2(decompressor.handle, data, size, pixels.getData(),
+                               scaledWidth, 0, scaledHeight,
+                               gray ? TJPF_GRAY : TJPF_RGB, TJFLAG_FASTDCT) == 0;
+    }
+#endif
+
+    bool decodeFreeImage(const unsigned char* data, size_t size, ofPixels& pixels, int scale) {
+        int width, height;
+        if (!ofxSonyCameraJpegDecoder::readSize(data, size, width, height)) {
+            return false;
+        }
+
+        // FreeImage picks the DCT scale from the requested size in the upper flag bits
+        int flags = JPEG_FAST;
+        if (scale != 1) {
+            int requested = (std::max(width, height) + scale - 1) / scale;
+            flags |= requested << 16;
+        }
+
+        FIMEMORY* memory = FreeImage_OpenMemory(const_cast<BYTE*>(data), static_cast<DWORD>(size));
+        FIBITMAP* bitmap = FreeImage_LoadFromMemory(FIF_JPEG, memory, flags);
+        FreeImage_CloseMemory(memory);
+        if (!bitmap) {
+            return false;
+        }
+
+        bool gray = FreeImage_GetBPP(bitmap) == 8 && FreeImage_GetColorType(bitmap) == FIC_MINISBLACK;
+        if (!gray && FreeImage_GetBPP(bitmap) != 24) {
+            FIBITMAP* converted = FreeImage_ConvertTo24Bits(bitmap);
+            FreeImage_Unload(bitmap);
+            bitmap = converted;
+            if (!bitmap) {
+                return false;
+            }
+        }
+
+        int outWidth = FreeImage_GetWidth(bitmap);
+        int outHeight = FreeImage_GetHeight(bitmap);
+        size_t channels = gray ? 1 : 3;
+
+        // No-op when the buffer already has this size and format
+        pixels.allocate(outWidth, outHeight, gray ? OF_PIXELS_GRAY : OF_PIXELS_RGB);
+
+        // FreeImage stores rows bottom-up, and BGR on little-endian hosts
+        unsigned char* dst = pixels.getData();
+        for (int y = 0; y < outHeight; y++) {
+            const BYTE* src = FreeImage_GetScanLine(bitmap, outHeight - 1 - y);
+            unsigned char* row = dst + y * outWidth * channels;
+            if (gray) {
+                memcpy(row, src, outWidth);
+                continue;
+            }
+            for (int x = 0; x < outWidth; x++) {
+                row[x * 3 + 0] = src[x * 3 + FI_RGBA_RED];
+                row[x * 3 + 1] = src[x * 3 + FI_RGBA_GREEN];
+                row[x * 3 + 2] = src[x * 3 + FI_RGBA_BLUE];
+            }
+        }
+
+        FreeImage_Unload(bitmap);
+        return true;
+    }
+}
+
+ofxSonyCameraJpegDecoder::ofxSonyCameraJpegDecoder()
+    : mRunning(false) {
+}
+
+ofxSonyCameraJpegDecoder::~ofxSonyCameraJpegDecoder() {
+    close();
+}
+
+void ofxSonyCameraJpegDecoder::setup(size_t numWorkers, size_t maxJobs) {
+    close();
+
+    if (numWorkers == 0) {
+        numWorkers = std::min<size_t>(std::max<unsigned>(std::thread::hardware_concurrency(), 1), 4);
+    }
+    maxJobs = std::max(maxJobs, numWorkers);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.clear();
+        mJobs.resize(maxJobs);
+        mQueue.clear();
+        mDelivery.clear();
+        mStats = Stats();
+        mRunning = true;
+    }
+
+    for (size_t i = 0; i < numWorkers; i++) {
+        mWorkers.emplace_back(&ofxSonyCameraJpegDecoder::threadedFunction, this);
+    }
+
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraJpegDecoder", "Started {} decode threads with {} job slots", numWorkers, maxJobs);
+}
+
+void ofxSonyCameraJpegDecoder::close() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mRunning) {
+            return;
+        }
+        mRunning = false;
+    }
+    mCondition.notify_all();
+
+    for (auto& worker : mWorkers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    mWorkers.clear();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mQueue.clear();
+    mDelivery.clear();
+    for (auto& job : mJobs) {
+        job.state = JOB_FREE;
+    }
+}
+
+bool ofxSonyCameraJpegDecoder::submit(const unsigned char* data, size_t size, Scale scale, uint64_t id) {
+    if (!data || size == 0) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    Job* job = acquireJob();
+    if (!job) {
+        return false;
+    }
+
+    // Keep the slot's capacity between jobs
+    if (job->input.size() < size) {
+        job->input.resize(size);
+    }
+    memcpy(job->input.data(), data, size);
+    job->inputSize = size;
+    job->path.clear();
+    job->scale = scale;
+    job->id = id;
+
+    lock.unlock();
+    mCondition.notify_one();
+    return true;
+}
+
+bool ofxSonyCameraJpegDecoder::submit(const std::string& path, Scale scale, uint64_t id) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    Job* job = acquireJob();
+    if (!job) {
+        return false;
+    }
+
+    job->inputSize = 0;
+    job->path = path;
+    job->scale = scale;
+    job->id = id;
+
+    lock.unlock();
+    mCondition.notify_one();
+    return true;
+}
+
+bool ofxSonyCameraJpegDecoder::receive(ofPixels& pixels, uint64_t& id, bool& decoded) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Hand out results in submission order
+    if (mDelivery.empty()) {
+        return false;
+    }
+    Job& job = mJobs[mDelivery.front()];
+    if (job.state != JOB_DONE) {
+        return false;
+    }
+
+    mDelivery.pop_front();
+    job.state = JOB_FREE;
+    if (job.success) {
+        pixels.swap(job.pixels);
+    }
+    id = job.id;
+    decoded = job.success;
+    return true;
+}
+
+size_t ofxSonyCameraJpegDecoder::getNumPending() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDelivery.size();
+}
+
+ofxSonyCameraJpegDecoder::Stats ofxSonyCameraJpegDecoder::getStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+ofxSonyCameraJpegDecoder::Job* ofxSonyCameraJpegDecoder::acquireJob() {
+    if (!mRunning) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraJpegDecoder", "Cannot submit: decoder not set up");
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < mJobs.size(); i++) {
+        if (mJobs[i].state == JOB_FREE) {
+            mJobs[i].state = JOB_QUEUED;
+            mQueue.push_back(i);
+            mDelivery.push_back(i);
+            mStats.submitted++;
+            return &mJobs[i];
+        }
+    }
+
+    mStats.rejected++;
+    return nullptr;
+}
+
+void ofxSonyCameraJpegDecoder::threadedFunction() {
+    while (true) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return !mRunning || !mQueue.empty(); });
+            if (!mRunning) {
+                return;
+            }
+            index = mQueue.front();
+            mQueue.pop_front();
+            mJobs[index].state = JOB_DECODING;
+        }
+
+        // The slot belongs to this worker until it is marked done
+        Job& job = mJobs[index];
+        auto start = std::chrono::steady_clock::now();
+
+        if (!job.path.empty()) {
+            ofBuffer file = ofBufferFromFile(job.path, true);
+            if (job.input.size() < file.size()) {
+                job.input.resize(file.size());
+            }
+            memcpy(job.input.data(), file.getData(), file.size());
+            job.inputSize = file.size();
+            if (file.size() == 0) {
+                OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraJpegDecoder", "Failed to read {}", job.path);
+            }
+        }
+
+        job.success = decode(job.input.data(), job.inputSize, job.pixels, job.scale);
+        if (!job.success) {
+            OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraJpegDecoder", "Failed to decode job {}", job.id);
+        }
+
+        uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        job.state = JOB_DONE;
+        if (job.success) {
+            mStats.decoded++;
+            mStats.avgDecodeMicros = mStats.avgDecodeMicros == 0 ? micros : (mStats.avgDecodeMicros * 7 + micros) / 8;
+        } else {
+            mStats.failed++;
+        }
+    }
+}
+
+bool ofxSonyCameraJpegDecoder::readSize(const unsigned char* data, size_t size, int& width, int& height) {
+    if (!data || size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+
+    size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        unsigned char marker = data[pos + 1];
+        if (marker == 0xFF) {
+            pos++; // Fill byte
+            continue;
+        }
+
+        size_t length = (data[pos + 2] << 8) | data[pos + 3];
+
+        // Start of frame markers, excluding DHT, JPG and DAC
+        bool isStartOfFrame = marker >= 0xC0 && marker <= 0xCF &&
+                              marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (isStartOfFrame) {
+            if (pos + 9 > size) {
+                return false;
+            }
+            height = (data[pos + 5] << 8) | data[pos + 6];
+            width = (data[pos + 7] << 8) | data[pos + 8];
+            return width > 0 && height > 0;
+        }
+
+        // Start of scan: no frame header found before the image data
+        if (marker == 0xDA) {
+            return false;
+        }
+        pos += 2 + length;
+    }
+    return false;
+}
+
+bool ofxSonyCameraJpegDecoder::isTurboJpegAvailable() {
+#ifdef OFX_SONY_CAMERA_NO_TURBOJPEG
+    return false;
+#else
+    return getTurboJpeg().loaded;
+#endif
+}
+
+bool ofxSonyCameraJpegDecoder::decode(const unsigned char* data, size_t size, ofPixels& pixels, Scale scale) {
+    if (!data || size == 0) {
+        return false;
+    }
+#ifndef OFX_SONY_CAMERA_NO_TURBOJPEG
+    if (getTurboJpeg().loaded) {
+        return decodeTurboJpeg(data, size, pixels, scale);
+    }
+#endif
+    return decodeFreeImage(data, size, pixels, scale);
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "ofMain.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+/**
+ * @brief Parallel JPEG decoder for live view frames and downloaded captures
+ *
+ * A bounded pool of worker threads decodes JPEG data into reusable ofPixels
+ * buffers. Jobs live in a fixed set of slots whose input and output buffers
+ * are kept between jobs, so a steady stream of same-sized frames decodes
+ * without allocating. Results are delivered in submission order.
+ *
+ * Decoding uses libjpeg-turbo's SIMD decoder, loaded at runtime from the
+ * library search paths, and falls back to the FreeImage library bundled with
+ * openFrameworks when libturbojpeg isn't installed. Define
+ * OFX_SONY_CAMERA_USE_TURBOJPEG to link libturbojpeg instead, or
+ * OFX_SONY_CAMERA_NO_TURBOJPEG to always use FreeImage. Both use the JPEG DCT
+ * scaling, so scaled decodes for previews are cheaper than full ones rather
+ * than resized after the fact.
+ */
+class ofxSonyCameraJpegDecoder {
+public:
+    /**
+     * @brief Decode scale, as the denominator of the output size
+     */
+    enum Scale {
+        SCALE_FULL = 1,
+        SCALE_HALF = 2,
+        SCALE_QUARTER = 4,
+        SCALE_EIGHTH = 8
+    };
+
+    struct Stats {
+        uint64_t submitted = 0;    // jobs accepted
+        uint64_t rejected = 0;     // jobs refused because every slot was busy
+        uint64_t decoded = 0;      // jobs decoded successfully
+        uint64_t failed = 0;       // jobs that could not be decoded
+        uint64_t avgDecodeMicros = 0; // smoothed decode time per job
+    };
+
+    ofxSonyCameraJpegDecoder();
+    ~ofxSonyCameraJpegDecoder();
+
+    /**
+     * @brief Start the worker pool
+     *
+     * @param numWorkers Number of decode threads (0 picks one per core, up to 4)
+     * @param maxJobs Number of job slots, which bounds queued plus undelivered jobs
+     */
+    void setup(size_t numWorkers = 0, size_t maxJobs = 8);
+
+    /**
+     * @brief Stop the worker pool and drop undelivered results
+     */
+    void close();
+
+    /**
+     * @brief Queue JPEG data for decoding
+     *
+     * The data is copied into the job slot, so the caller's buffer can be
+     * reused as soon as this returns.
+     *
+     * @param data The JPEG data
+     * @param size The size of the JPEG data in bytes
+     * @param scale The output scale
+     * @param id Caller-defined identifier returned with the result
+     * @return false if every job slot is busy
+     */
+    bool submit(const unsigned char* data, size_t size, Scale scale = SCALE_FULL, uint64_t id = 0);
+
+    /**
+     * @brief Queue a JPEG file for decoding
+     *
+     * The file is read on a worker thread.
+     *
+     * @return false if every job slot is busy
+     */
+    bool submit(const std::string& path, Scale scale = SCALE_FULL, uint64_t id = 0);
+
+    /**
+     * @brief Take the next finished job, in submission order
+     *
+     * Failed jobs are returned too, so every submitted id comes back exactly
+     * once. The pixels are swapped with the job slot's buffer, so passing the
+     * same ofPixels on every call recycles both allocations.
+     *
+     * @param pixels Receives the decoded image; left untouched if the job failed
+     * @param id Receives the identifier given to submit()
+     * @param decoded Receives false if the data could not be read or decoded
+     * @return true if a job was returned, false if the next one isn't ready
+     */
+    bool receive(ofPixels& pixels, uint64_t& id, bool& decoded);
+
+    /**
+     * @brief Get the number of jobs queued, decoding or waiting to be received
+     */
+    size_t getNumPending() const;
+
+    Stats getStats() const;
+
+    /**
+     * @brief Decode JPEG data on the calling thread
+     *
+     * @param data The JPEG data
+     * @param size The size of the JPEG data in bytes
+     * @param pixels Receives the decoded image; reused if already the right size
+     * @param scale The output scale
+     * @return true if the image was decoded, false otherwise
+     */
+    static bool decode(const unsigned char* data, size_t size, ofPixels& pixels, Scale scale = SCALE_FULL);
+
+    /**
+     * @brief Check if decoding goes through libjpeg-turbo
+     *
+     * The first call loads libturbojpeg, unless the addon was built with
+     * OFX_SONY_CAMERA_USE_TURBOJPEG or OFX_SONY_CAMERA_NO_TURBOJPEG.
+     *
+     * @return true if libjpeg-turbo is used, false if FreeImage is
+     */
+    static bool isTurboJpegAvailable();
+
+    /**
+     * @brief Read the dimensions from a JPEG header without decoding
+     */
+    static bool readSize(const unsigned char* data, size_t size, int& width, int& height);
+
+private:
+    enum JobState {
+        JOB_FREE,
+        JOB_QUEUED,
+        JOB_DECODING,
+        JOB_DONE
+    };
+
+    struct Job {
+        JobState state = JOB_FREE;
+        std::vector<unsigned char> input;
+        size_t inputSize = 0;
+        std::string path;
+        Scale scale = SCALE_FULL;
+        uint64_t id = 0;
+        bool success = false;
+        ofPixels pixels;
+    };
+
+    void threadedFunction();
+
+    // Must be called with mMutex held; returns nullptr when all slots are busy
+    Job* acquireJob();
+
+    std::vector<Job> mJobs;
+    std::deque<size_t> mQueue;     // jobs waiting for a worker
+    std::deque<size_t> mDelivery;  // jobs in submission order, for receive()
+
+    std::vector<std::thread> mWorkers;
+    bool mRunning;
+    Stats mStats;
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+};
@@ -0,0 +1,337 @@
+#include "ofxSonyCameraLiveView.h"
+#include "ofxSonyCameraLog.h"
+#include <cstring>
+
+using SCRSDK::CrError;
+using SCRSDK::CrError_None;
+using SCRSDK::CrWarning_Frame_NotUpdated;
+
+namespace {
+    uint64_t steadyMicros(std::chrono::steady_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+    }
+
+    // Used when the camera cannot tell us its live view buffer size
+    const size_t kDefaultFrameSize = 1024 * 1024;
+}
+
+//--------------------------------------------------------------
+ofxSonyCameraSdkLiveViewSource::ofxSonyCameraSdkLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle)
+    : mDeviceHandle(deviceHandle) {
+}
+
+size_t ofxSonyCameraSdkLiveViewSource::getMaxFrameSize() {
+#ifdef OFX_SONY_CAMERA_NO_SDK
+    return kDefaultFrameSize;
+#else
+    SCRSDK::CrImageInfo info;
+    CrError err = SCRSDK::GetLiveViewImageInfo(mDeviceHandle, &info);
+    if (err != CrError_None || info.GetBufferSize() == 0) {
+        OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraLiveView", "Failed to get live view image info: {}", err);
+        return kDefaultFrameSize;
+    }
+
+    // Leave headroom for live view quality changes while streaming
+    return info.GetBufferSize() * 2;
+#endif
+}
+
+CrInt32u ofxSonyCameraSdkLiveViewSource::readFrame(CrInt8u* buffer, size_t capacity, size_t& offset, size_t& size) {
+#ifdef OFX_SONY_CAMERA_NO_SDK
+    return SCRSDK::CrError_Generic_NotSupported;
+#else
+    mImageData.SetSize(static_cast<CrInt32u>(capacity));
+    mImageData.SetData(buffer);
+
+    CrError err = SCRSDK::GetLiveViewImage(mDeviceHandle, &mImageData);
+    if (err != CrError_None) {
+        return err;
+    }
+
+    CrInt8u* image = mImageData.GetImageData();
+    size = mImageData.GetImageSize();
+    if (!image || size == 0) {
+        return CrWarning_Frame_NotUpdated;
+    }
+    offset = image - buffer;
+    return CrError_None;
+#endif
+}
+
+//--------------------------------------------------------------
+ofxSonyCameraSyntheticLiveViewSource::ofxSonyCameraSyntheticLiveViewSource(const std::vector<ofBuffer>& frames, double fps)
+    : mFrames(frames)
+    , mNextFrame(0) {
+    mInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / (fps > 0 ? fps : 30.0)));
+    mNextDeadline = std::chrono::steady_clock::now();
+}
+
+size_t ofxSonyCameraSyntheticLiveViewSource::getMaxFrameSize() {
+    size_t maxSize = 0;
+    for (const auto& frame : mFrames) {
+        maxSize = std::max(maxSize, frame.size());
+    }
+    return maxSize;
+}
+
+CrInt32u ofxSonyCameraSyntheticLiveViewSource::readFrame(CrInt8u* buffer, size_t capacity, size_t& offset, size_t& size) {
+    auto now = std::chrono::steady_clock::now();
+    if (mFrames.empty() || now < mNextDeadline) {
+        return CrWarning_Frame_NotUpdated;
+    }
+    // Don't burst to catch up after a stall
+    mNextDeadline = std::max(mNextDeadline + mInterval, now);
+
+    const ofBuffer& frame = mFrames[mNextFrame];
+    mNextFrame = (mNextFrame + 1) % mFrames.size();
+
+    if (frame.size() > capacity) {
+        return SCRSDK::CrError_Memory;
+    }
+    memcpy(buffer, frame.getData(), frame.size());
+    offset = 0;
+    size = frame.size();
+    return CrError_None;
+}
+
+//--------------------------------------------------------------
+ofxSonyCameraLiveView::ofxSonyCameraLiveView()
+    : mRunning(false)
+    , mPollInterval(2000)
+    , mBack(0)
+    , mFront(1)
+    , mMiddle(2)
+    , mFrameNew(false)
+    , mFramesAcquired(0)
+    , mFramesDelivered(0)
+    , mFramesDropped(0)
+    , mErrors(0)
+    , mFps(0)
+    , mLastLatency(0)
+    , mAvgLatency(0)
+    , mMaxLatency(0)
+    , mDecodeScale(ofxSonyCameraJpegDecoder::SCALE_FULL)
+    , mDecodeEnabled(false)
+    , mPixelsFrameNumber(0)
+    , mPixelsNew(false) {
+}
+
+ofxSonyCameraLiveView::~ofxSonyCameraLiveView() {
+    stop();
+}
+
+bool ofxSonyCameraLiveView::start(std::unique_ptr<ofxSonyCameraLiveViewSource> source) {
+    if (mRunning) {
+        OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraLiveView", "Live view already running");
+        return false;
+    }
+    if (!source) {
+        return false;
+    }
+
+    mSource = std::move(source);
+
+    // Allocate the whole pool up front
+    size_t frameSize = mSource->getMaxFrameSize();
+    for (auto& frame : mFrames) {
+        frame.buffer.assign(frameSize, 0);
+        frame.offset = 0;
+        frame.size = 0;
+        frame.frameNumber = 0;
+    }
+    mBack = 0;
+    mFront = 1;
+    mMiddle = 2;
+    mFrameNew = false;
+
+    mFramesAcquired = 0;
+    mFramesDelivered = 0;
+    mFramesDropped = 0;
+    mErrors = 0;
+    mFps = 0;
+    mLastLatency = 0;
+    mAvgLatency = 0;
+    mMaxLatency = 0;
+    mLastFrameTime = std::chrono::steady_clock::time_point();
+
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraLiveView", "Starting live view with {} byte frame buffers", frameSize);
+
+    mRunning = true;
+    mThread = std::thread(&ofxSonyCameraLiveView::threadedFunction, this);
+    return true;
+}
+
+void ofxSonyCameraLiveView::stop() {
+    if (!mRunning.exchange(false)) {
+        return;
+    }
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+    mSource.reset();
+}
+
+bool ofxSonyCameraLiveView::isRunning() const {
+    return mRunning;
+}
+
+void ofxSonyCameraLiveView::setPollInterval(std::chrono::microseconds interval) {
+    mPollInterval = interval;
+}
+
+bool ofxSonyCameraLiveView::update() {
+    mFrameNew = false;
+    if (mDecodeEnabled) {
+        receiveDecoded();
+    }
+    if (!(mMiddle.load(std::memory_order_relaxed) & kNewFlag)) {
+        return false;
+    }
+
+    // Swap our buffer with the freshly published one
+    uint8_t previous = mMiddle.exchange(mFront, std::memory_order_acq_rel);
+    mFront = previous & kIndexMask;
+    mFrameNew = true;
+    mFramesDelivered++;
+
+    // The decoder copies the frame, and counts it as rejected when every slot is busy
+    if (mDecodeEnabled) {
+        const Frame& frame = mFrames[mFront];
+        mDecoder.submit(frame.getData(), frame.size, mDecodeScale, frame.frameNumber);
+    }
+    return true;
+}
+
+bool ofxSonyCameraLiveView::isFrameNew() const {
+    return mFrameNew;
+}
+
+const ofxSonyCameraLiveView::Frame& ofxSonyCameraLiveView::getFrame() const {
+    return mFrames[mFront];
+}
+
+void ofxSonyCameraLiveView::setDecodeEnabled(bool enabled, ofxSonyCameraJpegDecoder::Scale scale, size_t numWorkers) {
+    mDecodeScale = scale;
+    if (enabled == mDecodeEnabled) {
+        return;
+    }
+    mDecodeEnabled = enabled;
+    mPixelsNew = false;
+    if (enabled) {
+        // One slot per worker: a frame that finds every worker busy is skipped
+        // rather than queued, so the pixels never fall further behind
+        mDecoder.setup(numWorkers, 0);
+    } else {
+        mDecoder.close();
+    }
+}
+
+bool ofxSonyCameraLiveView::isDecodeEnabled() const {
+    return mDecodeEnabled;
+}
+
+bool ofxSonyCameraLiveView::isPixelsNew() const {
+    return mPixelsNew;
+}
+
+const ofPixels& ofxSonyCameraLiveView::getPixels() const {
+    return mPixels;
+}
+
+uint64_t ofxSonyCameraLiveView::getPixelsFrameNumber() const {
+    return mPixelsFrameNumber;
+}
+
+void ofxSonyCameraLiveView::receiveDecoded() {
+    mPixelsNew = false;
+
+    // Keep only the newest image when several finished since the last update
+    uint64_t frameNumber;
+    bool decoded;
+    while (mDecoder.receive(mReceived, frameNumber, decoded)) {
+        if (!decoded) {
+            OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraLiveView", "Failed to decode live view frame {}", frameNumber);
+            continue;
+        }
+        mPixels.swap(mReceived);
+        mPixelsFrameNumber = frameNumber;
+        mPixelsNew = true;
+    }
+}
+
+ofxSonyCameraLiveView::Stats ofxSonyCameraLiveView::getStats() const {
+    Stats stats;
+    stats.framesAcquired = mFramesAcquired;
+    stats.framesDelivered = mFramesDelivered;
+    stats.framesDropped = mFramesDropped;
+    stats.errors = mErrors;
+    stats.fps = mFps;
+    stats.lastLatencyMicros = mLastLatency;
+    stats.avgLatencyMicros = mAvgLatency;
+    stats.maxLatencyMicros = mMaxLatency;
+
+    ofxSonyCameraJpegDecoder::Stats decoderStats = mDecoder.getStats();
+    stats.framesDecoded = decoderStats.decoded;
+    stats.decodeErrors = decoderStats.failed;
+    stats.decodeSkipped = decoderStats.rejected;
+    stats.avgDecodeMicros = decoderStats.avgDecodeMicros;
+    return stats;
+}
+
+void ofxSonyCameraLiveView::threadedFunction() {
+    while (mRunning) {
+        Frame& frame = mFrames[mBack];
+
+        auto start = std::chrono::steady_clock::now();
+        size_t offset = 0;
+        size_t size = 0;
+        CrInt32u result = mSource->readFrame(frame.buffer.data(), frame.buffer.size(), offset, size);
+        auto end = std::chrono::steady_clock::now();
+
+        if (result == CrWarning_Frame_NotUpdated) {
+            std::this_thread::sleep_for(mPollInterval);
+            continue;
+        }
+        if (result != CrError_None) {
+            mErrors++;
+            OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraLiveView", "Failed to read live view frame: {}", result);
+            std::this_thread::sleep_for(mPollInterval);
+            continue;
+        }
+
+        frame.offset = offset;
+        frame.size = size;
+        frame.frameNumber = ++mFramesAcquired;
+        frame.acquiredMicros = steadyMicros(end);
+        frame.latencyMicros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+        // Smoothed frame rate
+        if (mLastFrameTime.time_since_epoch().count() != 0) {
+            double interval = std::chrono::duration<double>(end - mLastFrameTime).count();
+            if (interval > 0) {
+                double fps = mFps;
+                mFps = fps == 0 ? 1.0 / interval : fps * 0.9 + (1.0 / interval) * 0.1;
+            }
+        }
+        mLastFrameTime = end;
+
+        publish(frame.latencyMicros);
+    }
+}
+
+void ofxSonyCameraLiveView::publish(uint64_t latencyMicros) {
+    mLastLatency = latencyMicros;
+    uint64_t avg = mAvgLatency;
+    mAvgLatency = avg == 0 ? latencyMicros : (avg * 7 + latencyMicros) / 8;
+    if (latencyMicros > mMaxLatency) {
+        mMaxLatency = latencyMicros;
+    }
+
+    // Hand the back buffer over and take whatever was in the middle
+    uint8_t previous = mMiddle.exchange(mBack | kNewFlag, std::memory_order_acq_rel);
+    if (previous & kNewFlag) {
+        mFramesDropped++;
+    }
+    mBack = previous & kIndexMask;
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "ofMain.h"
+#include "../libs/CRSDK/include/CameraRemote_SDK.h"
+#include "ofxSonyCameraJpegDecoder.h"
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+
+/**
+ * @brief Source of JPEG live view frames
+ *
+ * Implementations write one frame into a caller-owned buffer per call, so the
+ * live view engine can reuse its preallocated frame pool.
+ */
+class ofxSonyCameraLiveViewSource {
+public:
+    virtual ~ofxSonyCameraLiveViewSource() {}
+
+    /**
+     * @brief Get the largest frame this source can produce
+     *
+     * Called once before streaming starts to size the frame pool.
+     */
+    virtual size_t getMaxFrameSize() = 0;
+
+    /**
+     * @brief Read the newest frame into a buffer
+     *
+     * @param buffer The buffer to fill
+     * @param capacity The size of the buffer in bytes
+     * @param offset Receives the offset of the JPEG data within the buffer
+     * @param size Receives the size of the JPEG data
+     * @return CrError_None on success, CrWarning_Frame_NotUpdated if there is
+     *         no new frame yet, or an SDK error code
+     */
+    virtual CrInt32u readFrame(CrInt8u* buffer, size_t capacity, size_t& offset, size_t& size) = 0;
+};
+
+/**
+ * @brief Live view source reading from a connected camera
+ */
+class ofxSonyCameraSdkLiveViewSource : public ofxSonyCameraLiveViewSource {
+public:
+    explicit ofxSonyCameraSdkLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle);
+
+    size_t getMaxFrameSize() override;
+    CrInt32u readFrame(CrInt8u* buffer, size_t capacity, size_t& offset, size_t& size) override;
+
+private:
+    SCRSDK::CrDeviceHandle mDeviceHandle;
+#ifndef OFX_SONY_CAMERA_NO_SDK
+    SCRSDK::CrImageDataBlock mImageData;
+#endif
+};
+
+/**
+ * @brief Live view source replaying JPEG frames at a fixed rate
+ *
+ * Lets the live view pipeline run without a camera attached.
+ */
+class ofxSonyCameraSyntheticLiveViewSource : public ofxSonyCameraLiveViewSource {
+public:
+    /**
+     * @param frames Encoded JPEG frames, replayed in a loop
+     * @param fps The rate at which new frames become available
+     */
+    ofxSonyCameraSyntheticLiveViewSource(const std::vector<ofBuffer>& frames, double fps = 30.0);
+
+    size_t getMaxFrameSize() override;
+    CrInt32u readFrame(CrInt8u* buffer, size_t capacity, size_t& offset, size_t& size) override;
+
+private:
+    std::vector<ofBuffer> mFrames;
+    size_t mNextFrame;
+    std::chrono::steady_clock::duration mInterval;
+    std::chrono::steady_clock::time_point mNextDeadline;
+};
+
+/**
+ * @brief Live view streaming engine
+ *
+ * A background thread pulls frames from a source into a pool of three
+ * preallocated buffers, so streaming does no per-frame allocation. The
+ * newest complete frame is handed to the consumer through a lock-free triple
+ * buffer: the producer always has a buffer to write into, the consumer always
+ * has a stable buffer to read, and a frame the consumer never picked up is
+ * counted as dropped when a newer one replaces it.
+ *
+ * With decoding enabled, each frame update() picks up is also decoded on an
+ * ofxSonyCameraJpegDecoder worker pool, and getPixels() holds the newest
+ * decoded image.
+ *
+ * update(), isFrameNew(), getFrame() and the decoding calls must be called
+ * from a single consumer thread, typically the openFrameworks thread.
+ */
+class ofxSonyCameraLiveView {
+public:
+    struct Frame {
+        std::vector<CrInt8u> buffer; // preallocated storage, never resized while streaming
+        size_t offset = 0;           // start of the JPEG data within buffer
+        size_t size = 0;             // size of the JPEG data
+        uint64_t frameNumber = 0;    // running count of acquired frames
+        uint64_t acquiredMicros = 0; // steady clock time the frame was acquired
+        uint64_t latencyMicros = 0;  // time spent reading the frame from the source
+
+        const CrInt8u* getData() const { return buffer.data() + offset; }
+    };
+
+    struct Stats {
+        uint64_t framesAcquired = 0;  // frames read from the source
+        uint64_t framesDelivered = 0; // frames picked up by update()
+        uint64_t framesDropped = 0;   // frames replaced before update() picked them up
+        uint64_t errors = 0;          // failed reads
+        double fps = 0;               // smoothed acquisition rate
+        uint64_t lastLatencyMicros = 0;
+        uint64_t avgLatencyMicros = 0; // smoothed acquisition latency
+        uint64_t maxLatencyMicros = 0;
+        uint64_t framesDecoded = 0;   // frames decoded to pixels
+        uint64_t decodeErrors = 0;    // frames that could not be decoded
+        uint64_t decodeSkipped = 0;   // frames not decoded because the decoder was saturated
+        uint64_t avgDecodeMicros = 0; // smoothed decode time per frame
+    };
+
+    ofxSonyCameraLiveView();
+    ~ofxSonyCameraLiveView();
+
+    /**
+     * @brief Start streaming from a source
+     *
+     * @param source The frame source; the live view takes ownership
+     * @return true if streaming started, false otherwise
+     */
+    bool start(std::unique_ptr<ofxSonyCameraLiveViewSource> source);
+
+    /**
+     * @brief Stop streaming and release the source
+     */
+    void stop();
+
+    bool isRunning() const;
+
+    /**
+     * @brief Set how long to wait before polling again when no new frame is ready
+     *
+     * Must be called while the live view is stopped.
+     */
+    void setPollInterval(std::chrono::microseconds interval);
+
+    /**
+     * @brief Pick up the newest complete frame, if any
+     *
+     * @return true if a new frame is available through getFrame()
+     */
+    bool update();
+
+    /**
+     * @brief Check if the last update() picked up a new frame
+     */
+    bool isFrameNew() const;
+
+    /**
+     * @brief Get the frame picked up by the last successful update()
+     *
+     * The frame stays valid until the next update() call.
+     */
+    const Frame& getFrame() const;
+
+    /**
+     * @brief Decode frames to pixels as update() picks them up
+     *
+     * Decoding runs on a worker pool, so the pixels lag the newest frame by
+     * about one decode.
+     *
+     * @param enabled Whether to decode frames
+     * @param scale The output scale; a quarter or an eighth is plenty for a preview
+     * @param numWorkers Number of decode threads (0 picks one per core, up to 4);
+     *        a frame that arrives while all of them are busy is not decoded
+     */
+    void setDecodeEnabled(bool enabled,
+                          ofxSonyCameraJpegDecoder::Scale scale = ofxSonyCameraJpegDecoder::SCALE_FULL,
+                          size_t numWorkers = 0);
+
+    bool isDecodeEnabled() const;
+
+    /**
+     * @brief Check if the last update() received a newly decoded image
+     */
+    bool isPixelsNew() const;
+
+    /**
+     * @brief Get the newest decoded image
+     *
+     * The pixels stay valid until the next update() call.
+     */
+    const ofPixels& getPixels() const;
+
+    /**
+     * @brief Get the frame number of the image in getPixels()
+     */
+    uint64_t getPixelsFrameNumber() const;
+
+    Stats getStats() const;
+
+private:
+    static constexpr uint8_t kIndexMask = 0x03;
+    static constexpr uint8_t kNewFlag = 0x04;
+
+    void threadedFunction();
+    void publish(uint64_t latencyMicros);
+    void receiveDecoded();
+
+    std::unique_ptr<ofxSonyCameraLiveViewSource> mSource;
+    std::thread mThread;
+    std::atomic<bool> mRunning;
+    std::chrono::microseconds mPollInterval;
+
+    // Triple buffer: mBack belongs to the producer, mFront to the consumer
+    // and mMiddle holds the index of the last published frame plus kNewFlag
+    Frame mFrames[3];
+    uint8_t mBack;
+    uint8_t mFront;
+    std::atomic<uint8_t> mMiddle;
+    bool mFrameNew;
+
+    // Counters written by the producer thread
+    std::atomic<uint64_t> mFramesAcquired;
+    std::atomic<uint64_t> mFramesDelivered;
+    std::atomic<uint64_t> mFramesDropped;
+    std::atomic<uint64_t> mErrors;
+    std::atomic<double> mFps;
+    std::atomic<uint64_t> mLastLatency;
+    std::atomic<uint64_t> mAvgLatency;
+    std::atomic<uint64_t> mMaxLatency;
+    std::chrono::steady_clock::time_point mLastFrameTime;
+
+    // Decoding, owned by the consumer thread
+    ofxSonyCameraJpegDecoder mDecoder;
+    ofxSonyCameraJpegDecoder::Scale mDecodeScale;
+    bool mDecodeEnabled;
+    ofPixels mPixels;
+    ofPixels mReceived;
+    uint64_t mPixelsFrameNumber;
+    bool mPixelsNew;
+};
@@ -0,0 +1,204 @@
+#include "ofxSonyCameraLog.h"
+#include "ofxSonyCameraRing.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+
+std::atomic<int> ofxSonyCameraLog::sLevel(-1);
+
+namespace {
+    // How long the formatter sleeps when the ring is empty; producers never
+    // wake it, which would cost them a lock
+    const std::chrono::milliseconds kPollInterval(5);
+
+    // Records go through an ofxSonyCameraRing, with the formatter thread as
+    // its consumer
+    class Logger {
+    public:
+        typedef ofxSonyCameraLog::Record Record;
+
+        static Logger& get() {
+            // Created on first use, so destroyed before openFrameworks' logger
+            static Logger logger;
+            return logger;
+        }
+
+        ~Logger() {
+            mRunning.store(false, std::memory_order_release);
+            if (mThread.joinable()) {
+                mThread.join();
+            }
+            drain();
+        }
+
+        void push(const Record& record) {
+            // Only the used part of the string space needs copying
+            if (!mRing.push([&record](Record& slot) { copy(slot, record); })) {
+                mDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            mWritten.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void flush() {
+            uint64_t target = mRing.getNumPushed();
+            while (mFormatted.load(std::memory_order_acquire) < target) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        ofxSonyCameraLog::Stats getStats() const {
+            ofxSonyCameraLog::Stats stats;
+            stats.written = mWritten.load(std::memory_order_relaxed);
+            stats.dropped = mDropped.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        Logger()
+            : mFormatted(0)
+            , mWritten(0)
+            , mDropped(0)
+            , mReportedDropped(0)
+            , mRunning(true) {
+            mThread = std::thread(&Logger::threadedFunction, this);
+        }
+
+        static void copy(Record& to, const Record& from) {
+            to.format = from.format;
+            to.numArgs = from.numArgs;
+            to.stringsUsed = from.stringsUsed;
+            std::copy(from.args, from.args + from.numArgs, to.args);
+            memcpy(to.strings, from.strings, from.stringsUsed);
+        }
+
+        static void print(const Record& record) {
+            std::string text = ofxSonyCameraLog::format(record);
+            const char* module = record.format->module;
+            switch (record.format->level) {
+                case OF_LOG_VERBOSE: ofLogVerbose(module) << text; break;
+                case OF_LOG_NOTICE: ofLogNotice(module) << text; break;
+                case OF_LOG_WARNING: ofLogWarning(module) << text; break;
+                case OF_LOG_ERROR: ofLogError(module) << text; break;
+                case OF_LOG_FATAL_ERROR: ofLogFatalError(module) << text; break;
+                default: break;
+            }
+        }
+
+        // Format everything queued; returns whether there was anything
+        bool drain() {
+            bool any = false;
+
+            // Print from the slot itself, then hand it back
+            while (mRing.pop(print)) {
+                mFormatted.fetch_add(1, std::memory_order_release);
+                any = true;
+            }
+
+            uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+            if (dropped != mReportedDropped) {
+                ofLogWarning("ofxSonyCameraLog") << "Dropped " << (dropped - mReportedDropped) << " message(s): the log ring was full";
+                mReportedDropped = dropped;
+            }
+            return any;
+        }
+
+        void threadedFunction() {
+            while (mRunning.load(std::memory_order_acquire)) {
+                if (!drain()) {
+                    std::this_thread::sleep_for(kPollInterval);
+                }
+            }
+        }
+
+        ofxSonyCameraRing<Record, ofxSonyCameraLog::kCapacity> mRing;
+        std::atomic<uint64_t> mFormatted;
+        std::atomic<uint64_t> mWritten;
+        std::atomic<uint64_t> mDropped;
+        uint64_t mReportedDropped; // formatter only
+        std::atomic<bool> mRunning;
+        std::thread mThread;
+    };
+
+    void appendArg(std::string& text, const ofxSonyCameraLog::Record& record, const ofxSonyCameraLog::Arg& arg, bool hex) {
+        char number[32];
+        switch (arg.type) {
+            case ofxSonyCameraLog::Arg::TYPE_INT:
+                snprintf(number, sizeof(number), hex ? "%" PRIx64 : "%" PRId64, arg.i);
+                text += number;
+                break;
+            case ofxSonyCameraLog::Arg::TYPE_UINT:
+                snprintf(number, sizeof(number), hex ? "%" PRIx64 : "%" PRIu64, arg.u);
+                text += number;
+                break;
+            case ofxSonyCameraLog::Arg::TYPE_DOUBLE:
+                snprintf(number, sizeof(number), "%g", arg.d);
+                text += number;
+                break;
+            case ofxSonyCameraLog::Arg::TYPE_BOOL:
+                text += arg.u ? "true" : "false";
+                break;
+            case ofxSonyCameraLog::Arg::TYPE_POINTER:
+                snprintf(number, sizeof(number), "%p", arg.p);
+                text += number;
+                break;
+            case ofxSonyCameraLog::Arg::TYPE_STRING:
+                text.append(record.strings + arg.offset, arg.length);
+                if (arg.truncated) {
+                    text += "...";
+                }
+                break;
+        }
+    }
+}
+
+void ofxSonyCameraLog::setLevel(ofLogLevel level) {
+    sLevel.store(level, std::memory_order_relaxed);
+}
+
+void ofxSonyCameraLog::flush() {
+    Logger::get().flush();
+}
+
+ofxSonyCameraLog::Stats ofxSonyCameraLog::getStats() {
+    return Logger::get().getStats();
+}
+
+std::string ofxSonyCameraLog::format(const Record& record) {
+    std::string text;
+    const char* format = record.format->text;
+    size_t next = 0;
+    while (*format) {
+        if (format[0] == '{' && format[1] == '}') {
+            if (next < record.numArgs) {
+                appendArg(text, record, record.args[next++], false);
+            }
+            format += 2;
+        } else if (strncmp(format, "{:x}", 4) == 0) {
+            if (next < record.numArgs) {
+                appendArg(text, record, record.args[next++], true);
+            }
+            format += 4;
+        } else {
+            text += *format++;
+        }
+    }
+    return text;
+}
+
+void ofxSonyCameraLog::push(const Record& record) {
+    Logger::get().push(record);
+}
+
+void ofxSonyCameraLog::packString(Record& record, const char* data, size_t length) {
+    // Cut to what's left of the string space rather than allocate
+    size_t space = kStringSpace - record.stringsUsed;
+    Arg& arg = nextArg(record, Arg::TYPE_STRING);
+    arg.offset = record.stringsUsed;
+    arg.length = static_cast<uint16_t>(std::min(length, space));
+    arg.truncated = length > space;
+    memcpy(record.strings + record.stringsUsed, data, arg.length);
+    record.stringsUsed += arg.length;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/**
+ * Messages below this level compile to nothing, arguments included. Define it
+ * in ADDON_CFLAGS, e.g. -DOFX_SONY_CAMERA_LOG_LEVEL=OF_LOG_WARNING.
+ */
+#ifndef OFX_SONY_CAMERA_LOG_LEVEL
+#define OFX_SONY_CAMERA_LOG_LEVEL OF_LOG_VERBOSE
+#endif
+
+/**
+ * @brief Binary ring-buffer logger for the addon's messages
+ *
+ * Logging a message copies a fixed-size record (a pointer to the message's
+ * static format, used as its id, plus the raw arguments) into a bounded
+ * lock-free ring; a background thread formats the records and passes them to
+ * ofLog with the message's level and module, so ofSetLogLevel() works as
+ * before. Logging from the SDK's callback thread thus costs a compare-and-swap
+ * and a copy, without locks, string formatting or allocation.
+ *
+ * Formats take "{}" for an argument and "{:x}" for an integer in hex.
+ * Strings are copied into the record; those too long to fit are cut short
+ * and end in "..." when printed. When the ring is full, messages are dropped
+ * and counted.
+ *
+ * Log through the OFX_SONY_CAMERA_LOG_* macros, which give each message its
+ * format and apply OFX_SONY_CAMERA_LOG_LEVEL.
+ */
+class ofxSonyCameraLog {
+public:
+    static constexpr size_t kMaxArgs = 8;
+    static constexpr size_t kStringSpace = 128;
+    static constexpr size_t kCapacity = 1024; // records; must be a power of two
+
+    /**
+     * @brief A message's static part; its address identifies it
+     */
+    struct Format {
+        ofLogLevel level;
+        const char* module;
+        const char* text;
+    };
+
+    struct Arg {
+        enum Type : uint8_t {
+            TYPE_INT,
+            TYPE_UINT,
+            TYPE_DOUBLE,
+            TYPE_BOOL,
+            TYPE_POINTER,
+            TYPE_STRING // in the record's string space
+        };
+
+        Type type;
+        bool truncated;  // TYPE_STRING: cut short to fit the string space
+        uint16_t offset; // TYPE_STRING
+        uint16_t length; // TYPE_STRING
+        union {
+            int64_t i;
+            uint64_t u;
+            double d;
+            const void* p;
+        };
+    };
+
+    struct Record {
+        const Format* format;
+        uint8_t numArgs;
+        uint16_t stringsUsed;
+        Arg args[kMaxArgs];
+        char strings[kStringSpace];
+    };
+
+    struct Stats {
+        uint64_t written = 0;
+        uint64_t dropped = 0; // because the ring was full
+    };
+
+    /**
+     * @brief Log a message; use the macros below instead
+     */
+    template<typename... Args>
+    static void write(const Format* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= kMaxArgs, "Too many log arguments");
+        if (format->level < getLevel()) {
+            return;
+        }
+
+        Record record;
+        record.format = format;
+        record.numArgs = 0;
+        record.stringsUsed = 0;
+        int expand[] = { 0, (pack(record, args), 0)... };
+        (void)expand;
+        push(record);
+    }
+
+    /**
+     * @brief Skip messages below a level before they are recorded
+     *
+     * ofSetLogLevel() still filters what is printed; this also spares
+     * recording messages that would be filtered. Until set, follows
+     * ofGetLogLevel(), so set it to OF_LOG_VERBOSE to see verbose messages of
+     * modules lowered with ofSetLogLevel(module, level) alone.
+     */
+    static void setLevel(ofLogLevel level);
+    static ofLogLevel getLevel() {
+        int level = sLevel.load(std::memory_order_relaxed);
+        return level < 0 ? ofGetLogLevel() : static_cast<ofLogLevel>(level);
+    }
+
+    /**
+     * @brief Wait until every message logged so far has been passed to ofLog
+     */
+    static void flush();
+
+    static Stats getStats();
+
+    /**
+     * @brief Turn a record into its message text
+     */
+    static std::string format(const Record& record);
+
+private:
+    static void push(const Record& record);
+
+    static Arg& nextArg(Record& record, Arg::Type type) {
+        Arg& arg = record.args[record.numArgs++];
+        arg.type = type;
+        return arg;
+    }
+
+    template<typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    pack(Record& record, T value) {
+        nextArg(record, Arg::TYPE_INT).i = value;
+    }
+
+    template<typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value>::type
+    pack(Record& record, T value) {
+        nextArg(record, Arg::TYPE_UINT).u = value;
+    }
+
+    template<typename T>
+    static typename std::enable_if<std::is_enum<T>::value>::type
+    pack(Record& record, T value) {
+        pack(record, static_cast<typename std::underlying_type<T>::type>(value));
+    }
+
+    template<typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type
+    pack(Record& record, T value) {
+        nextArg(record, Arg::TYPE_DOUBLE).d = value;
+    }
+
+    static void pack(Record& record, bool value) {
+        nextArg(record, Arg::TYPE_BOOL).u = value;
+    }
+
+    static void pack(Record& record, const void* value) {
+        nextArg(record, Arg::TYPE_POINTER).p = value;
+    }
+
+    static void pack(Record& record, const char* value) {
+        packString(record, value ? value : "(null)", value ? strlen(value) : 6);
+    }
+
+    static void pack(Record& record, const std::string& value) {
+        packString(record, value.data(), value.size());
+    }
+
+    static void packString(Record& record, const char* data, size_t length);
+
+    static std::atomic<int> sLevel; // -1 until setLevel() is called
+};
+
+#define OFX_SONY_CAMERA_LOG(level, module, text, ...) \
+    do { \
+        if ((level) >= OFX_SONY_CAMERA_LOG_LEVEL) { \
+            static const ofxSonyCameraLog::Format ofxSonyCameraLogFormat = { level, module, text }; \
+            ofxSonyCameraLog::write(&ofxSonyCameraLogFormat, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define OFX_SONY_CAMERA_LOG_VERBOSE(module, text, ...) OFX_SONY_CAMERA_LOG(OF_LOG_VERBOSE, module, text, ##__VA_ARGS__)
+#define OFX_SONY_CAMERA_LOG_NOTICE(module, text, ...) OFX_SONY_CAMERA_LOG(OF_LOG_NOTICE, module, text, ##__VA_ARGS__)
+#define OFX_SONY_CAMERA_LOG_WARNING(module, text, ...) OFX_SONY_CAMERA_LOG(OF_LOG_WARNING, module, text, ##__VA_ARGS__)
+#define OFX_SONY_CAMERA_LOG_ERROR(module, text, ...) OFX_SONY_CAMERA_LOG(OF_LOG_ERROR, module, text, ##__VA_ARGS__)
@@ -0,0 +1,273 @@
+#include "ofxSonyCameraMetrics.h"
+#include "ofMain.h"
+#include "ofxSonyCameraLog.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Every live instance, for the Prometheus export
+    std::mutex registryMutex;
+    std::vector<const ofxSonyCameraMetrics*> registry;
+
+    // Periodic export; stopped at the latest when the program ends
+    struct PrometheusExporter {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::thread thread;
+        bool running = false;
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running = false;
+            }
+            condition.notify_all();
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+
+        ~PrometheusExporter() {
+            stop();
+        }
+    } exporter;
+
+    const char* const callNames[ofxSonyCameraMetrics::CALL_COUNT] = {
+        "Connect",
+        "Disconnect",
+        "SendCommand",
+        "GetDeviceProperties",
+        "GetSelectDeviceProperties",
+        "SetDeviceProperty",
+        "EnumCameraObjects"
+    };
+
+    const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+    int highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value | 1);
+#else
+        int bit = 0;
+        while (value >>= 1) {
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    // Prometheus label values escape backslashes, quotes and newlines
+    std::string escapeLabel(const std::string& value) {
+        std::string escaped;
+        for (char c : value) {
+            if (c == '\\' || c == '"') {
+                escaped += '\\';
+                escaped += c;
+            } else if (c == '\n') {
+                escaped += "\\n";
+            } else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+}
+
+ofxSonyCameraMetrics::ofxSonyCameraMetrics(const std::string& camera)
+    : mCamera(camera) {
+    reset();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.push_back(this);
+}
+
+ofxSonyCameraMetrics::~ofxSonyCameraMetrics() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+}
+
+void ofxSonyCameraMetrics::setCamera(const std::string& camera) {
+    std::lock_guard<std::mutex> lock(mCameraMutex);
+    mCamera = camera;
+}
+
+std::string ofxSonyCameraMetrics::getCamera() const {
+    std::lock_guard<std::mutex> lock(mCameraMutex);
+    return mCamera;
+}
+
+void ofxSonyCameraMetrics::record(Call call, uint64_t nanos, bool failed) {
+    Histogram& histogram = mHistograms[call];
+    histogram.buckets[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+    if (failed) {
+        histogram.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t max = histogram.maxNanos.load(std::memory_order_relaxed);
+    while (nanos > max && !histogram.maxNanos.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+ofxSonyCameraMetrics::CallStats ofxSonyCameraMetrics::getStats(Call call) const {
+    const Histogram& histogram = mHistograms[call];
+    CallStats stats;
+
+    // Copy the buckets first; the total is taken from them so percentiles stay
+    // consistent while other threads keep recording
+    uint64_t counts[kNumBuckets];
+    uint64_t total = 0;
+    for (size_t i = 0; i < kNumBuckets; i++) {
+        counts[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    stats.count = total;
+    stats.errors = histogram.errors.load(std::memory_order_relaxed);
+    stats.maxMicros = histogram.maxNanos.load(std::memory_order_relaxed) / 1000.0;
+    if (total == 0) {
+        return stats;
+    }
+    stats.meanMicros = histogram.sumNanos.load(std::memory_order_relaxed) / 1000.0 / histogram.count.load(std::memory_order_relaxed);
+
+    double* targets[] = { &stats.p50Micros, &stats.p90Micros, &stats.p99Micros, &stats.p999Micros };
+    size_t next = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets && next < 4; i++) {
+        seen += counts[i];
+        while (next < 4 && seen >= static_cast<uint64_t>(std::ceil(quantiles[next] * total))) {
+            // Report the middle of the bucket, never beyond the largest value seen
+            double middle = (bucketLowerBound(i) + bucketUpperBound(i)) / 2.0 / 1000.0;
+            *targets[next++] = std::min(middle, stats.maxMicros);
+        }
+    }
+    return stats;
+}
+
+void ofxSonyCameraMetrics::reset() {
+    for (Histogram& histogram : mHistograms) {
+        for (auto& bucket : histogram.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.errors.store(0, std::memory_order_relaxed);
+        histogram.sumNanos.store(0, std::memory_order_relaxed);
+        histogram.maxNanos.store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* ofxSonyCameraMetrics::getCallName(Call call) {
+    return call < CALL_COUNT ? callNames[call] : "Unknown";
+}
+
+size_t ofxSonyCameraMetrics::bucketIndex(uint64_t nanos) {
+    // Below 2^kSubBucketBits every value has its own bucket; above, each
+    // power of two is split into 2^kSubBucketBits linear sub-buckets
+    const uint64_t subBuckets = uint64_t(1) << kSubBucketBits;
+    if (nanos < subBuckets) {
+        return nanos;
+    }
+
+    int exponent = std::min(highestBit(nanos), kMaxExponent);
+    if (exponent == kMaxExponent) {
+        return kNumBuckets - 1;
+    }
+    int shift = exponent - kSubBucketBits;
+    uint64_t mantissa = nanos >> shift; // in [subBuckets, 2 * subBuckets)
+    return ((shift + 1) << kSubBucketBits) + (mantissa - subBuckets);
+}
+
+uint64_t ofxSonyCameraMetrics::bucketLowerBound(size_t index) {
+    const uint64_t subBuckets = uint64_t(1) << kSubBucketBits;
+    if (index < subBuckets) {
+        return index;
+    }
+    int shift = static_cast<int>(index >> kSubBucketBits) - 1;
+    uint64_t mantissa = subBuckets + (index & (subBuckets - 1));
+    return mantissa << shift;
+}
+
+uint64_t ofxSonyCameraMetrics::bucketUpperBound(size_t index) {
+    if (index + 1 >= kNumBuckets) {
+        return bucketLowerBound(index);
+    }
+    return bucketLowerBound(index + 1);
+}
+
+std::string ofxSonyCameraMetrics::writePrometheusSamples() const {
+    std::ostringstream out;
+    std::string camera = escapeLabel(getCamera());
+
+    for (int call = 0; call < CALL_COUNT; call++) {
+        CallStats stats = getStats(Call(call));
+        if (stats.count == 0) {
+            continue;
+        }
+
+        std::string labels = "camera=\"" + camera + "\",call=\"" + callNames[call] + "\"";
+        double percentiles[] = { stats.p50Micros, stats.p90Micros, stats.p99Micros, stats.p999Micros };
+        for (size_t i = 0; i < 4; i++) {
+            out << "ofx_sony_camera_sdk_call_seconds{" << labels << ",quantile=\"" << quantiles[i] << "\"} "
+                << percentiles[i] / 1e6 << "\n";
+        }
+        out << "ofx_sony_camera_sdk_call_seconds_sum{" << labels << "} "
+            << mHistograms[call].sumNanos.load(std::memory_order_relaxed) / 1e9 << "\n";
+        out << "ofx_sony_camera_sdk_call_seconds_count{" << labels << "} " << stats.count << "\n";
+        out << "ofx_sony_camera_sdk_call_errors_total{" << labels << "} " << stats.errors << "\n";
+    }
+    return out.str();
+}
+
+bool ofxSonyCameraMetrics::writePrometheus(const std::string& path) {
+    std::string text =
+        "# HELP ofx_sony_camera_sdk_call_seconds Latency of Camera Remote SDK calls\n"
+        "# TYPE ofx_sony_camera_sdk_call_seconds summary\n"
+        "# HELP ofx_sony_camera_sdk_call_errors_total Camera Remote SDK calls that returned an error\n"
+        "# TYPE ofx_sony_camera_sdk_call_errors_total counter\n";
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const ofxSonyCameraMetrics* metrics : registry) {
+            text += metrics->writePrometheusSamples();
+        }
+    }
+
+    std::string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "w");
+    if (!file) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraMetrics", "Cannot write {}", temporary);
+        return false;
+    }
+    bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+    written = fclose(file) == 0 && written;
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraMetrics", "Cannot write {}", path);
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+void ofxSonyCameraMetrics::startPrometheusExport(const std::string& path, std::chrono::milliseconds interval) {
+    exporter.stop();
+
+    std::lock_guard<std::mutex> lock(exporter.mutex);
+    exporter.running = true;
+    exporter.thread = std::thread([path, interval]() {
+        std::unique_lock<std::mutex> lock(exporter.mutex);
+        while (!exporter.condition.wait_for(lock, interval, []() { return !exporter.running; })) {
+            lock.unlock();
+            writePrometheus(path);
+            lock.lock();
+        }
+    });
+}
+
+void ofxSonyCameraMetrics::stopPrometheusExport() {
+    exporter.stop();
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CrError.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Latency histograms of the Camera Remote SDK calls made for one camera
+ *
+ * Each call type has a log-linear histogram (16 sub-buckets per power of
+ * two, so about 6% resolution from nanoseconds to minutes) of atomic
+ * counters. Recording a call is two clock reads and a few relaxed atomic
+ * increments, without locks or allocation, from any thread.
+ *
+ * Every instance registers itself in a process-wide list, so the histograms
+ * of all cameras can be written to one Prometheus text file, once or
+ * periodically from a background thread.
+ *
+ * Building the addon with OFX_SONY_CAMERA_NO_METRICS defined turns
+ * OFX_SONY_CAMERA_TIMED() into a plain call and nothing is recorded.
+ */
+class ofxSonyCameraMetrics {
+public:
+    enum Call {
+        CALL_CONNECT,
+        CALL_DISCONNECT,
+        CALL_SEND_COMMAND,
+        CALL_GET_DEVICE_PROPERTIES,
+        CALL_GET_SELECT_DEVICE_PROPERTIES,
+        CALL_SET_DEVICE_PROPERTY,
+        CALL_ENUM_CAMERA_OBJECTS,
+        CALL_COUNT
+    };
+
+    /**
+     * @brief Percentiles and counters of one call type
+     */
+    struct CallStats {
+        uint64_t count = 0;
+        uint64_t errors = 0; // calls that returned anything but CrError_None
+        double meanMicros = 0;
+        double p50Micros = 0;
+        double p90Micros = 0;
+        double p99Micros = 0;
+        double p999Micros = 0;
+        double maxMicros = 0;
+    };
+
+    /**
+     * @param camera Label for this camera in exports, e.g. its serial number
+     */
+    explicit ofxSonyCameraMetrics(const std::string& camera = "");
+    ~ofxSonyCameraMetrics();
+
+    ofxSonyCameraMetrics(const ofxSonyCameraMetrics&) = delete;
+    ofxSonyCameraMetrics& operator=(const ofxSonyCameraMetrics&) = delete;
+
+    void setCamera(const std::string& camera);
+    std::string getCamera() const;
+
+    /**
+     * @brief Time an SDK call
+     *
+     * Use through OFX_SONY_CAMERA_TIMED() so the timing compiles out.
+     *
+     * @param call The call type
+     * @param function The call, returning a CrError
+     * @return What the call returned
+     */
+    template<typename Function>
+    SCRSDK::CrError time(Call call, Function&& function) {
+        auto start = std::chrono::steady_clock::now();
+        SCRSDK::CrError err = function();
+        record(call, std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count(), err != SCRSDK::CrError_None);
+        return err;
+    }
+
+    /**
+     * @brief Add one call to its histogram
+     *
+     * @param call The call type
+     * @param nanos How long it took
+     * @param failed Whether it returned an error
+     */
+    void record(Call call, uint64_t nanos, bool failed);
+
+    /**
+     * @brief Get the percentiles of a call type, from the counts so far
+     */
+    CallStats getStats(Call call) const;
+
+    /**
+     * @brief Forget everything recorded
+     */
+    void reset();
+
+    static const char* getCallName(Call call);
+
+    /**
+     * @brief Write every instance's histograms in Prometheus text format
+     *
+     * The file is written next to the path and renamed over it, so a
+     * collector never reads a partial file.
+     *
+     * @param path The file to write, e.g. for node_exporter's textfile collector
+     * @return true if the file was written, false otherwise
+     */
+    static bool writePrometheus(const std::string& path);
+
+    /**
+     * @brief Call writePrometheus() periodically from a background thread
+     *
+     * @param path The file to write
+     * @param interval The time between writes
+     */
+    static void startPrometheusExport(const std::string& path, std::chrono::milliseconds interval);
+    static void stopPrometheusExport();
+
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kMaxExponent = 40; // 2^40 ns, about 18 minutes
+    static constexpr size_t kNumBuckets = (kMaxExponent - kSubBucketBits + 2) << kSubBucketBits;
+
+private:
+    struct Histogram {
+        std::atomic<uint64_t> buckets[kNumBuckets];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> errors;
+        std::atomic<uint64_t> sumNanos;
+        std::atomic<uint64_t> maxNanos;
+    };
+
+    static size_t bucketIndex(uint64_t nanos);
+    static uint64_t bucketLowerBound(size_t index);
+    static uint64_t bucketUpperBound(size_t index);
+
+    std::string writePrometheusSamples() const;
+
+    Histogram mHistograms[CALL_COUNT];
+
+    std::string mCamera;
+    mutable std::mutex mCameraMutex;
+};
+
+#ifdef OFX_SONY_CAMERA_NO_METRICS
+#define OFX_SONY_CAMERA_TIMED(metrics, call, expression) (expression)
+#else
+#define OFX_SONY_CAMERA_TIMED(metrics, call, expression) \
+    (metrics).time(ofxSonyCameraMetrics::call, [&]() { return (expression); })
+#endif
@@ -0,0 +1,105 @@
+#include "ofxSonyCameraPropertyCache.h"
+#include <algorithm>
+
+ofxSonyCameraPropertyCache::ofxSonyCameraPropertyCache()
+    : mGeneration(0) {
+}
+
+void ofxSonyCameraPropertyCache::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCodes.clear();
+    mValues.clear();
+    mVersions.clear();
+    mValid.clear();
+}
+
+void ofxSonyCameraPropertyCache::store(CrInt32u code, CrInt64u value) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.stores++;
+
+    auto it = std::lower_bound(mCodes.begin(), mCodes.end(), code);
+    size_t index = it - mCodes.begin();
+
+    if (it == mCodes.end() || *it != code) {
+        // New code: insert at its sorted position in every array
+        mCodes.insert(it, code);
+        mValues.insert(mValues.begin() + index, value);
+        mVersions.insert(mVersions.begin() + index, ++mGeneration);
+        mValid.insert(mValid.begin() + index, 1);
+        mStats.changes++;
+        return;
+    }
+
+    if (mValues[index] != value) {
+        mValues[index] = value;
+        mVersions[index] = ++mGeneration;
+        mStats.changes++;
+    }
+    mValid[index] = 1;
+}
+
+void ofxSonyCameraPropertyCache::invalidate(CrInt32u num, const CrInt32u* codes) {
+    if (!codes) return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (CrInt32u i = 0; i < num; i++) {
+        size_t index = findIndex(codes[i]);
+        if (index != npos && mValid[index]) {
+            mValid[index] = 0;
+            mStats.invalidations++;
+        }
+    }
+}
+
+void ofxSonyCameraPropertyCache::invalidateAll() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.invalidations += mValid.size();
+    std::fill(mValid.begin(), mValid.end(), 0);
+}
+
+bool ofxSonyCameraPropertyCache::get(CrInt32u code, CrInt64u& value) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t index = findIndex(code);
+    if (index == npos || !mValid[index]) {
+        mStats.misses++;
+        return false;
+    }
+
+    value = mValues[index];
+    mStats.hits++;
+    return true;
+}
+
+uint64_t ofxSonyCameraPropertyCache::getVersion(CrInt32u code) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t index = findIndex(code);
+    return index == npos ? 0 : mVersions[index];
+}
+
+uint64_t ofxSonyCameraPropertyCache::getGeneration() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mGeneration;
+}
+
+size_t ofxSonyCameraPropertyCache::size() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCodes.size();
+}
+
+ofxSonyCameraPropertyCache::Stats ofxSonyCameraPropertyCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void ofxSonyCameraPropertyCache::resetStats() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats = Stats();
+}
+
+size_t ofxSonyCameraPropertyCache::findIndex(CrInt32u code) const {
+    auto it = std::lower_bound(mCodes.begin(), mCodes.end(), code);
+    if (it == mCodes.end() || *it != code) {
+        return npos;
+    }
+    return it - mCodes.begin();
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CrTypes.h"
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief In-process cache of camera property values
+ *
+ * The cache is filled once when a camera connects and then refreshed only for
+ * the property codes the camera reports as changed, so reads can be served
+ * from memory instead of a USB round trip.
+ *
+ * Codes are kept sorted in parallel arrays and looked up by binary search.
+ * Every stored value that differs from the cached one is stamped with a new
+ * version taken from a cache-wide generation counter, which never goes
+ * backwards (not even across clear()), so callers can cheaply detect changes.
+ *
+ * All methods are thread-safe: the command thread writes while the
+ * application thread reads.
+ */
+class ofxSonyCameraPropertyCache {
+public:
+    /**
+     * @brief Cache access counters
+     */
+    struct Stats {
+        uint64_t hits = 0;          // get() calls served from memory
+        uint64_t misses = 0;        // get() calls for unknown or invalidated codes
+        uint64_t stores = 0;        // values written into the cache
+        uint64_t changes = 0;       // stores that changed the cached value
+        uint64_t invalidations = 0; // codes marked stale
+    };
+
+    ofxSonyCameraPropertyCache();
+
+    /**
+     * @brief Drop all cached values
+     */
+    void clear();
+
+    /**
+     * @brief Store the current value of a property
+     *
+     * @param code The property code (from SCRSDK::CrDeviceProperty enum)
+     * @param value The value reported by the camera
+     */
+    void store(CrInt32u code, CrInt64u value);
+
+    /**
+     * @brief Mark properties as stale so the next get() misses
+     *
+     * @param num Number of codes in the array
+     * @param codes The property codes to invalidate
+     */
+    void invalidate(CrInt32u num, const CrInt32u* codes);
+
+    /**
+     * @brief Mark every cached property as stale
+     */
+    void invalidateAll();
+
+    /**
+     * @brief Read a cached property value
+     *
+     * @param code The property code
+     * @param value Reference to store the property value
+     * @return true on a cache hit, false if the code is unknown or stale
+     */
+    bool get(CrInt32u code, CrInt64u& value);
+
+    /**
+     * @brief Get the version of a property
+     *
+     * @param code The property code
+     * @return The generation at which the value last changed, 0 if unknown
+     */
+    uint64_t getVersion(CrInt32u code) const;
+
+    /**
+     * @brief Get the cache-wide generation counter
+     *
+     * @return The version assigned to the most recent change
+     */
+    uint64_t getGeneration() const;
+
+    /**
+     * @brief Get the number of cached properties
+     */
+    size_t size() const;
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Must be called with mMutex held
+    size_t findIndex(CrInt32u code) const;
+
+    // Parallel arrays sorted by code
+    std::vector<CrInt32u> mCodes;
+    std::vector<CrInt64u> mValues;
+    std::vector<uint64_t> mVersions;
+    std::vector<uint8_t> mValid;
+
+    uint64_t mGeneration;
+    Stats mStats;
+    mutable std::mutex mMutex;
+};
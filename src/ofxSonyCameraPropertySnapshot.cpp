@@ -0,0 +1,183 @@
+#include "ofxSonyCameraPropertySnapshot.h"
+#include "ofxSonyCameraPropertyTraits.h"
+#include <algorithm>
+#include <numeric>
+#include <cstdio>
+
+std::atomic<uint64_t> ofxSonyCameraPropertySnapshot::sGeneration(0);
+
+ofxSonyCameraPropertySnapshot::ofxSonyCameraPropertySnapshot()
+    : mSorted(true)
+    , mGeneration(0) {
+}
+
+void ofxSonyCameraPropertySnapshot::set(CrInt32u code, CrInt64u value, bool writable, const CrInt64u* possible, size_t numPossible) {
+    if (!possible) {
+        numPossible = 0;
+    }
+
+    // Replace in place when updating a stamped snapshot
+    size_t index = mSorted ? find(code) : npos;
+    if (index == npos) {
+        if (!mCodes.empty() && code <= mCodes.back()) {
+            mSorted = false;
+        }
+        index = mCodes.size();
+        mCodes.push_back(code);
+        mValues.push_back(value);
+        mWritable.push_back(writable);
+        mPossibleOffsets.push_back(0);
+        mPossibleCounts.push_back(0);
+    } else {
+        mValues[index] = value;
+        mWritable[index] = writable;
+    }
+
+    if (numPossible > mPossibleCounts[index]) {
+        mPossibleOffsets[index] = static_cast<uint32_t>(mPossiblePool.size());
+        mPossiblePool.insert(mPossiblePool.end(), possible, possible + numPossible);
+    } else {
+        std::copy(possible, possible + numPossible, mPossiblePool.begin() + mPossibleOffsets[index]);
+    }
+    mPossibleCounts[index] = static_cast<uint32_t>(numPossible);
+}
+
+void ofxSonyCameraPropertySnapshot::stamp() {
+    // Order by code; for repeated codes the last set() wins
+    std::vector<size_t> order(mCodes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return mCodes[a] < mCodes[b];
+    });
+
+    std::vector<CrInt32u> codes;
+    std::vector<CrInt64u> values;
+    std::vector<uint8_t> writable;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> counts;
+    std::vector<CrInt64u> pool;
+    codes.reserve(order.size());
+    values.reserve(order.size());
+    writable.reserve(order.size());
+    offsets.reserve(order.size());
+    counts.reserve(order.size());
+    pool.reserve(mPossiblePool.size());
+
+    for (size_t i = 0; i < order.size(); i++) {
+        if (i + 1 < order.size() && mCodes[order[i + 1]] == mCodes[order[i]]) {
+            continue;
+        }
+        size_t index = order[i];
+        codes.push_back(mCodes[index]);
+        values.push_back(mValues[index]);
+        writable.push_back(mWritable[index]);
+        offsets.push_back(static_cast<uint32_t>(pool.size()));
+        counts.push_back(mPossibleCounts[index]);
+
+        // Repack the pool without ranges left behind by replaced values
+        auto begin = mPossiblePool.begin() + mPossibleOffsets[index];
+        pool.insert(pool.end(), begin, begin + mPossibleCounts[index]);
+    }
+
+    mCodes.swap(codes);
+    mValues.swap(values);
+    mWritable.swap(writable);
+    mPossibleOffsets.swap(offsets);
+    mPossibleCounts.swap(counts);
+    mPossiblePool.swap(pool);
+    mSorted = true;
+    mGeneration = ++sGeneration;
+}
+
+uint64_t ofxSonyCameraPropertySnapshot::getGeneration() const {
+    return mGeneration;
+}
+
+size_t ofxSonyCameraPropertySnapshot::size() const {
+    return mCodes.size();
+}
+
+size_t ofxSonyCameraPropertySnapshot::find(CrInt32u code) const {
+    auto it = std::lower_bound(mCodes.begin(), mCodes.end(), code);
+    if (it == mCodes.end() || *it != code) {
+        return npos;
+    }
+    return it - mCodes.begin();
+}
+
+bool ofxSonyCameraPropertySnapshot::get(CrInt32u code, CrInt64u& value) const {
+    size_t index = find(code);
+    if (index == npos) {
+        return false;
+    }
+    value = mValues[index];
+    return true;
+}
+
+CrInt32u ofxSonyCameraPropertySnapshot::getCode(size_t index) const {
+    return mCodes[index];
+}
+
+CrInt64u ofxSonyCameraPropertySnapshot::getValue(size_t index) const {
+    return mValues[index];
+}
+
+bool ofxSonyCameraPropertySnapshot::isWritable(size_t index) const {
+    return mWritable[index] != 0;
+}
+
+const CrInt64u* ofxSonyCameraPropertySnapshot::getPossibleValues(size_t index, size_t& count) const {
+    count = mPossibleCounts[index];
+    return count == 0 ? nullptr : mPossiblePool.data() + mPossibleOffsets[index];
+}
+
+void ofxSonyCameraPropertySnapshot::diff(const ofxSonyCameraPropertySnapshot& before, const ofxSonyCameraPropertySnapshot& after, std::vector<CrInt32u>& changed) {
+    changed.clear();
+
+    // Both code arrays are sorted: walk them together once
+    size_t i = 0, j = 0;
+    while (i < before.mCodes.size() || j < after.mCodes.size()) {
+        if (j == after.mCodes.size() || (i < before.mCodes.size() && before.mCodes[i] < after.mCodes[j])) {
+            changed.push_back(before.mCodes[i++]);
+        } else if (i == before.mCodes.size() || after.mCodes[j] < before.mCodes[i]) {
+            changed.push_back(after.mCodes[j++]);
+        } else {
+            if (before.mValues[i] != after.mValues[j] || before.mWritable[i] != after.mWritable[j]) {
+                changed.push_back(after.mCodes[j]);
+            }
+            i++;
+            j++;
+        }
+    }
+}
+
+std::vector<CrInt32u> ofxSonyCameraPropertySnapshot::diff(const ofxSonyCameraPropertySnapshot& before, const ofxSonyCameraPropertySnapshot& after) {
+    std::vector<CrInt32u> changed;
+    diff(before, after, changed);
+    return changed;
+}
+
+std::string ofxSonyCameraPropertySnapshot::formatDiff(const ofxSonyCameraPropertySnapshot& before, const ofxSonyCameraPropertySnapshot& after) {
+    std::string text;
+    for (CrInt32u code : diff(before, after)) {
+        if (!text.empty()) {
+            text += ", ";
+        }
+
+        const ofxSonyCameraProperty::Info* info = ofxSonyCameraProperty::find(code);
+        if (info) {
+            text += info->name;
+        } else {
+            char name[16];
+            snprintf(name, sizeof(name), "0x%04X", code);
+            text += name;
+        }
+
+        CrInt64u value;
+        text += " ";
+        text += before.get(code, value) ? ofxSonyCameraProperty::format(code, value) : "-";
+        text += " -> ";
+        text += after.get(code, value) ? ofxSonyCameraProperty::format(code, value) : "-";
+    }
+    return text;
+}
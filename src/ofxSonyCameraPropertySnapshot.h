@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CrTypes.h"
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Immutable copy of every camera property at one point in time
+ *
+ * Codes, current values, writability and the ranges of possible values are
+ * kept in parallel arrays sorted by code, with all possible values packed in
+ * one shared pool, so a snapshot of a few hundred properties is a handful of
+ * allocations and lookups are binary searches.
+ *
+ * Every snapshot is stamped with a process-wide generation that only grows,
+ * and diff() compares two snapshots in a single merge pass over their codes.
+ */
+class ofxSonyCameraPropertySnapshot {
+public:
+    ofxSonyCameraPropertySnapshot();
+
+    /**
+     * @brief Add or replace a property while building the snapshot
+     *
+     * Call stamp() when done to sort the arrays and assign a generation.
+     *
+     * @param code The property code
+     * @param value The current value
+     * @param writable Whether the camera accepts writes right now
+     * @param possible The possible values, or nullptr
+     * @param numPossible The number of possible values
+     */
+    void set(CrInt32u code, CrInt64u value, bool writable, const CrInt64u* possible, size_t numPossible);
+
+    /**
+     * @brief Sort the arrays and assign the next generation
+     */
+    void stamp();
+
+    uint64_t getGeneration() const;
+    size_t size() const;
+
+    /**
+     * @brief Find a property
+     *
+     * @return The index of the code, or npos
+     */
+    size_t find(CrInt32u code) const;
+
+    bool get(CrInt32u code, CrInt64u& value) const;
+
+    CrInt32u getCode(size_t index) const;
+    CrInt64u getValue(size_t index) const;
+    bool isWritable(size_t index) const;
+
+    /**
+     * @brief Get the possible values of a property
+     *
+     * @param index The index of the property
+     * @param count Receives the number of values
+     * @return Pointer into the snapshot's value pool, valid while it lives
+     */
+    const CrInt64u* getPossibleValues(size_t index, size_t& count) const;
+
+    /**
+     * @brief Get the codes whose value or writability differs between two snapshots
+     *
+     * Codes present in only one of them count as changed.
+     *
+     * @param before The older snapshot
+     * @param after The newer snapshot
+     * @param changed Receives the changed codes in ascending order
+     */
+    static void diff(const ofxSonyCameraPropertySnapshot& before, const ofxSonyCameraPropertySnapshot& after, std::vector<CrInt32u>& changed);
+
+    static std::vector<CrInt32u> diff(const ofxSonyCameraPropertySnapshot& before, const ofxSonyCameraPropertySnapshot& after);
+
+    /**
+     * @brief Describe the differences on one line, e.g. "F-Number f/2.8 -> f/4.0, ISO ISO 100 -> ISO 400"
+     */
+    static std::string formatDiff(const ofxSonyCameraPropertySnapshot& before, const ofxSonyCameraPropertySnapshot& after);
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    // Parallel arrays sorted by code (after stamp())
+    std::vector<CrInt32u> mCodes;
+    std::vector<CrInt64u> mValues;
+    std::vector<uint8_t> mWritable;
+    std::vector<uint32_t> mPossibleOffsets; // into mPossiblePool
+    std::vector<uint32_t> mPossibleCounts;
+
+    std::vector<CrInt64u> mPossiblePool;
+    bool mSorted;
+    uint64_t mGeneration;
+
+    static std::atomic<uint64_t> sGeneration;
+};
@@ -0,0 +1,187 @@
+#include "ofxSonyCameraPropertySubscriptions.h"
+#include <algorithm>
+
+namespace {
+    struct CodeLess {
+        template<typename Entry>
+        bool operator()(const Entry& entry, CrInt32u code) const { return entry.code < code; }
+        template<typename Entry>
+        bool operator()(CrInt32u code, const Entry& entry) const { return code < entry.code; }
+    };
+}
+
+ofxSonyCameraPropertySubscriptions::ofxSonyCameraPropertySubscriptions()
+    : mHasLargeCodes(false)
+    , mAllChanged(false)
+    , mNextId(1)
+    , mDispatching(false)
+    , mNeedsCompact(false) {
+}
+
+size_t ofxSonyCameraPropertySubscriptions::subscribe(CrInt32u code, Handler handler) {
+    Entry entry;
+    entry.code = code;
+    entry.id = mNextId++;
+    entry.handler = handler;
+
+    // Don't move entries under a running dispatch
+    if (mDispatching) {
+        mDeferred.push_back(entry);
+    } else {
+        insert(entry);
+    }
+    return entry.id;
+}
+
+void ofxSonyCameraPropertySubscriptions::unsubscribe(size_t id) {
+    if (id == 0) {
+        return;
+    }
+
+    auto deferred = std::find_if(mDeferred.begin(), mDeferred.end(), [id](const Entry& entry) { return entry.id == id; });
+    if (deferred != mDeferred.end()) {
+        mDeferred.erase(deferred);
+        return;
+    }
+
+    for (auto& entry : mEntries) {
+        if (entry.id == id) {
+            // The handler may be the one running; remove it once dispatch is done
+            entry.id = 0;
+            mNeedsCompact = true;
+            break;
+        }
+    }
+    if (!mDispatching && mNeedsCompact) {
+        compact();
+    }
+}
+
+void ofxSonyCameraPropertySubscriptions::markChanged(CrInt32u num, const CrInt32u* codes) {
+    if (num == 0 || !codes) {
+        mAllChanged = true;
+        return;
+    }
+
+    for (CrInt32u i = 0; i < num; i++) {
+        CrInt32u code = codes[i];
+        if (!isSubscribed(code)) {
+            continue;
+        }
+        if (code < kBitsetSize) {
+            if (mChangedBits.test(code)) {
+                continue;
+            }
+            mChangedBits.set(code);
+        } else if (std::find(mChanged.begin(), mChanged.end(), code) != mChanged.end()) {
+            continue;
+        }
+        mChanged.push_back(code);
+    }
+}
+
+size_t ofxSonyCameraPropertySubscriptions::dispatch(ofxSonyCameraPropertyCache& cache) {
+    if (mDispatching || (!mAllChanged && mChanged.empty())) {
+        return 0;
+    }
+
+    // Take the batch; changes marked by handlers go into the next one
+    bool all = mAllChanged;
+    std::vector<CrInt32u> changed;
+    changed.swap(mChanged);
+    for (CrInt32u code : changed) {
+        if (code < kBitsetSize) {
+            mChangedBits.reset(code);
+        }
+    }
+    mAllChanged = false;
+
+    mDispatching = true;
+    size_t count = 0;
+
+    auto run = [this, &cache, &count](size_t begin, size_t end) {
+        if (begin == end) {
+            return;
+        }
+        CrInt64u value;
+        if (!cache.get(mEntries[begin].code, value)) {
+            return;
+        }
+        for (size_t i = begin; i < end; i++) {
+            if (mEntries[i].id != 0) {
+                mEntries[i].handler(mEntries[i].code, value);
+                count++;
+            }
+        }
+    };
+
+    if (all) {
+        size_t begin = 0;
+        for (size_t i = 1; i <= mEntries.size(); i++) {
+            if (i == mEntries.size() || mEntries[i].code != mEntries[begin].code) {
+                run(begin, i);
+                begin = i;
+            }
+        }
+    } else {
+        for (CrInt32u code : changed) {
+            auto range = std::equal_range(mEntries.begin(), mEntries.end(), code, CodeLess());
+            run(range.first - mEntries.begin(), range.second - mEntries.begin());
+        }
+    }
+
+    mDispatching = false;
+
+    for (auto& entry : mDeferred) {
+        insert(entry);
+    }
+    mDeferred.clear();
+    if (mNeedsCompact) {
+        compact();
+    }
+
+    return count;
+}
+
+bool ofxSonyCameraPropertySubscriptions::isSubscribed(CrInt32u code) const {
+    if (code < kBitsetSize) {
+        return mSubscribed.test(code);
+    }
+    return mHasLargeCodes && std::binary_search(mEntries.begin(), mEntries.end(), code, CodeLess());
+}
+
+size_t ofxSonyCameraPropertySubscriptions::size() const {
+    size_t count = mDeferred.size();
+    for (const auto& entry : mEntries) {
+        if (entry.id != 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void ofxSonyCameraPropertySubscriptions::insert(Entry entry) {
+    auto it = std::upper_bound(mEntries.begin(), mEntries.end(), entry.code, CodeLess());
+    if (entry.code < kBitsetSize) {
+        mSubscribed.set(entry.code);
+    } else {
+        mHasLargeCodes = true;
+    }
+    mEntries.insert(it, std::move(entry));
+}
+
+void ofxSonyCameraPropertySubscriptions::compact() {
+    mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(), [](const Entry& entry) { return entry.id == 0; }),
+                   mEntries.end());
+
+    mSubscribed.reset();
+    mHasLargeCodes = false;
+    for (const auto& entry : mEntries) {
+        if (entry.code < kBitsetSize) {
+            mSubscribed.set(entry.code);
+        } else {
+            mHasLargeCodes = true;
+        }
+    }
+    mNeedsCompact = false;
+}
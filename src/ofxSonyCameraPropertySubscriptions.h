@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CrTypes.h"
+#include "ofxSonyCameraPropertyCache.h"
+#include <vector>
+#include <bitset>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Property change handlers keyed by property code
+ *
+ * Changes are collected with markChanged() as the camera reports them and
+ * delivered together by dispatch(), so a handler runs at most once per batch
+ * however often its property changed, and only handlers of changed codes run.
+ *
+ * Handlers are kept in a flat array sorted by code. A bitset over the 16-bit
+ * code range answers "does anyone listen to this code" without a search, so
+ * changes nobody subscribed to cost a single bit test.
+ *
+ * Not thread-safe: subscribe, mark and dispatch from the same thread.
+ * Handlers may subscribe and unsubscribe while being dispatched.
+ */
+class ofxSonyCameraPropertySubscriptions {
+public:
+    typedef std::function<void(CrInt32u code, CrInt64u value)> Handler;
+
+    ofxSonyCameraPropertySubscriptions();
+
+    /**
+     * @brief Call a handler when a property changes
+     *
+     * @param code The property code (CrDeviceProperty_*)
+     * @param handler Called with the code and its new value
+     * @return An id for unsubscribe(), never 0
+     */
+    size_t subscribe(CrInt32u code, Handler handler);
+
+    /**
+     * @brief Remove a handler
+     *
+     * @param id The id returned by subscribe()
+     */
+    void unsubscribe(size_t id);
+
+    /**
+     * @brief Record changed properties for the next dispatch()
+     *
+     * @param num Number of codes; 0 means every property may have changed
+     * @param codes The changed property codes
+     */
+    void markChanged(CrInt32u num, const CrInt32u* codes);
+
+    /**
+     * @brief Run the handlers of every property changed since the last dispatch
+     *
+     * Properties missing from the cache are skipped.
+     *
+     * @param cache Source of the new values
+     * @return The number of handlers run
+     */
+    size_t dispatch(ofxSonyCameraPropertyCache& cache);
+
+    /**
+     * @brief Check if anyone listens to a property code
+     */
+    bool isSubscribed(CrInt32u code) const;
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        CrInt32u code;
+        size_t id;      // 0 once unsubscribed, removed after dispatch
+        Handler handler;
+    };
+
+    static constexpr size_t kBitsetSize = 1 << 16;
+
+    void insert(Entry entry);
+    void compact();
+
+    std::vector<Entry> mEntries;     // sorted by code, then subscription order
+    std::bitset<kBitsetSize> mSubscribed;
+    bool mHasLargeCodes;             // codes outside the bitset are searched for
+
+    std::vector<CrInt32u> mChanged;  // unique codes changed since the last dispatch
+    std::bitset<kBitsetSize> mChangedBits;
+    bool mAllChanged;
+
+    size_t mNextId;
+    bool mDispatching;
+    bool mNeedsCompact;
+    std::vector<Entry> mDeferred;    // subscribed during dispatch
+};
@@ -0,0 +1,56 @@
+#include "ofxSonyCameraPropertyTraits.h"
+#include <cstdio>
+
+namespace ofxSonyCameraProperty {
+
+    std::string format(CrInt32u code, CrInt64u value) {
+        char text[32];
+        const Info* info = find(code);
+        Packing packing = info ? info->packing : PACKING_ENUM;
+
+        switch (packing) {
+            case PACKING_INTEGER:
+                snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(value));
+                break;
+            case PACKING_HUNDREDTHS:
+                if (!Codec<PACKING_HUNDREDTHS>::isNumeric(value)) {
+                    return "--";
+                }
+                snprintf(text, sizeof(text), "f/%.1f", Codec<PACKING_HUNDREDTHS>::decode(value));
+                break;
+            case PACKING_THOUSANDTHS:
+                snprintf(text, sizeof(text), "%+.1f EV", Codec<PACKING_THOUSANDTHS>::decode(value));
+                break;
+            case PACKING_FRACTION: {
+                typedef Codec<PACKING_FRACTION> codec;
+                if (!codec::isNumeric(value)) {
+                    return "BULB";
+                }
+                if (codec::numerator(value) == 1 && codec::denominator(value) > 1) {
+                    snprintf(text, sizeof(text), "1/%llu", static_cast<unsigned long long>(codec::denominator(value)));
+                } else {
+                    snprintf(text, sizeof(text), "%g\"", codec::decode(value));
+                }
+                break;
+            }
+            case PACKING_ISO: {
+                if (!Codec<PACKING_ISO>::isNumeric(value)) {
+                    return "ISO AUTO";
+                }
+                snprintf(text, sizeof(text), "ISO %d", Codec<PACKING_ISO>::decode(value));
+                break;
+            }
+            case PACKING_KELVIN:
+                snprintf(text, sizeof(text), "%lluK", static_cast<unsigned long long>(value));
+                break;
+            case PACKING_PERCENT:
+                snprintf(text, sizeof(text), "%llu%%", static_cast<unsigned long long>(value));
+                break;
+            case PACKING_ENUM:
+            default:
+                snprintf(text, sizeof(text), "0x%llX", static_cast<unsigned long long>(value));
+                break;
+        }
+        return text;
+    }
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CrTypes.h"
+#include "../libs/CRSDK/include/CrDeviceProperty.h"
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Compile-time description of camera properties
+ *
+ * A constexpr table, sorted by property code at compile time, records for every known
+ * property its SDK data type, how its value is packed, and whether it is
+ * read-only. Typed tags such as ofxSonyCameraProperty::FNumber carry the
+ * matching codec, so ofxSonyCameraRemote::get<>() and set<>() convert between
+ * human units and the SDK encoding without any runtime lookup, and setting a
+ * read-only property fails to compile.
+ *
+ * format() turns any encoded value into display text using the same table.
+ */
+namespace ofxSonyCameraProperty {
+
+    /**
+     * @brief How a property value is packed into the SDK's integer
+     */
+    enum Packing {
+        PACKING_ENUM,        // camera-defined enumeration, shown as hex
+        PACKING_INTEGER,     // plain number
+        PACKING_HUNDREDTHS,  // value * 100 (f-number)
+        PACKING_THOUSANDTHS, // signed 16-bit value * 1000 (exposure compensation in EV)
+        PACKING_FRACTION,    // numerator << 16 | denominator (exposure time in seconds)
+        PACKING_ISO,         // ISO number in the low 24 bits, mode flags above
+        PACKING_KELVIN,      // color temperature in kelvin
+        PACKING_PERCENT      // 0 to 100
+    };
+
+    struct Info {
+        CrInt32u code;
+        const char* name;
+        SCRSDK::CrDataType type;
+        Packing packing;
+        bool readOnly;
+    };
+
+    // In any order: the SDK header numbers some codes implicitly, so their
+    // values can't be relied on here. Sorted by code below
+    constexpr Info kEntries[] = {
+        { SCRSDK::CrDeviceProperty_FNumber,                    "F-Number",              SCRSDK::CrDataType_UInt16, PACKING_HUNDREDTHS,  false },
+        { SCRSDK::CrDeviceProperty_ExposureBiasCompensation,   "Exposure Compensation", SCRSDK::CrDataType_Int16,  PACKING_THOUSANDTHS, false },
+        { SCRSDK::CrDeviceProperty_FlashCompensation,          "Flash Compensation",    SCRSDK::CrDataType_Int16,  PACKING_THOUSANDTHS, false },
+        { SCRSDK::CrDeviceProperty_ShutterSpeed,               "Shutter Speed",         SCRSDK::CrDataType_UInt32, PACKING_FRACTION,    false },
+        { SCRSDK::CrDeviceProperty_IsoSensitivity,             "ISO",                   SCRSDK::CrDataType_UInt32, PACKING_ISO,         false },
+        { SCRSDK::CrDeviceProperty_ExposureProgramMode,        "Exposure Mode",         SCRSDK::CrDataType_UInt32, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_FileType,                   "File Type",             SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_JpegQuality,                "JPEG Quality",          SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_WhiteBalance,               "White Balance",         SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_FocusMode,                  "Focus Mode",            SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_MeteringMode,               "Metering Mode",         SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_FlashMode,                  "Flash Mode",            SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_DriveMode,                  "Drive Mode",            SCRSDK::CrDataType_UInt32, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_DRO,                        "DRO",                   SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_ImageSize,                  "Image Size",            SCRSDK::CrDataType_UInt8,  PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_AspectRatio,                "Aspect Ratio",          SCRSDK::CrDataType_UInt8,  PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_FocusArea,                  "Focus Area",            SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_Colortemp,                  "Color Temperature",     SCRSDK::CrDataType_UInt16, PACKING_KELVIN,      false },
+        { SCRSDK::CrDeviceProperty_StillImageStoreDestination, "Save Destination",      SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_Movie_File_Format,          "Movie Format",          SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_Movie_Recording_Setting,    "Movie Quality",         SCRSDK::CrDataType_UInt16, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_Movie_Recording_FrameRateSetting, "Movie Frame Rate", SCRSDK::CrDataType_UInt8, PACKING_ENUM,        false },
+        { SCRSDK::CrDeviceProperty_RecordingState,             "Recording State",       SCRSDK::CrDataType_UInt8,  PACKING_ENUM,        true  },
+        { SCRSDK::CrDeviceProperty_LiveViewStatus,             "Live View Status",      SCRSDK::CrDataType_UInt16, PACKING_ENUM,        true  },
+        { SCRSDK::CrDeviceProperty_FocusIndication,            "Focus Indication",      SCRSDK::CrDataType_UInt32, PACKING_ENUM,        true  },
+        { SCRSDK::CrDeviceProperty_BatteryRemain,              "Battery",               SCRSDK::CrDataType_UInt16, PACKING_PERCENT,     true  },
+    };
+
+    constexpr size_t kTableSize = sizeof(kEntries) / sizeof(kEntries[0]);
+
+    struct Table {
+        Info entries[kTableSize];
+    };
+
+    constexpr Table sortByCode() {
+        Table table{};
+        for (size_t i = 0; i < kTableSize; i++) {
+            size_t j = i;
+            for (; j > 0 && table.entries[j - 1].code > kEntries[i].code; j--) {
+                table.entries[j] = table.entries[j - 1];
+            }
+            table.entries[j] = kEntries[i];
+        }
+        return table;
+    }
+
+    constexpr Table kTable = sortByCode();
+
+    constexpr bool isUnique(size_t index = 1) {
+        return index >= kTableSize || (kTable.entries[index - 1].code < kTable.entries[index].code && isUnique(index + 1));
+    }
+    static_assert(isUnique(), "ofxSonyCameraProperty::kEntries lists a code twice");
+
+    constexpr size_t findIndex(CrInt32u code, size_t first = 0, size_t last = kTableSize) {
+        return first >= last ? kTableSize
+             : kTable.entries[first + (last - first) / 2].code == code ? first + (last - first) / 2
+             : kTable.entries[first + (last - first) / 2].code < code ? findIndex(code, first + (last - first) / 2 + 1, last)
+             : findIndex(code, first, first + (last - first) / 2);
+    }
+
+    /**
+     * @brief Look up a property
+     *
+     * @return The table entry, or nullptr for codes not in the table
+     */
+    constexpr const Info* find(CrInt32u code) {
+        return findIndex(code) < kTableSize ? &kTable.entries[findIndex(code)] : nullptr;
+    }
+
+    /**
+     * @brief Format an encoded value for display, e.g. "f/2.8", "1/125", "ISO 400"
+     */
+    std::string format(CrInt32u code, CrInt64u value);
+
+    //--------------------------------------------------------------
+    // Codecs between human units and SDK encodings, one per packing;
+    // isNumeric() is false for special values that stand for no quantity
+
+    template<Packing P>
+    struct Codec {
+        typedef CrInt64u value_type;
+        static constexpr CrInt64u encode(value_type value) { return value; }
+        static constexpr value_type decode(CrInt64u value) { return value; }
+        static constexpr bool isNumeric(CrInt64u) { return true; }
+    };
+
+    template<>
+    struct Codec<PACKING_HUNDREDTHS> {
+        typedef double value_type;
+        static constexpr CrInt64u kSpecial = 0xFFFD; // and above: no f-number, e.g. a manual lens
+        static constexpr CrInt64u encode(double value) { return static_cast<CrInt64u>(value * 100.0 + 0.5); }
+        static constexpr double decode(CrInt64u value) { return value / 100.0; }
+        static constexpr bool isNumeric(CrInt64u value) { return value != 0 && value < kSpecial; }
+    };
+
+    template<>
+    struct Codec<PACKING_THOUSANDTHS> {
+        typedef double value_type;
+        static constexpr CrInt64u encode(double value) {
+            return static_cast<CrInt16u>(static_cast<CrInt16>(value * 1000.0 + (value < 0 ? -0.5 : 0.5)));
+        }
+        static constexpr double decode(CrInt64u value) { return static_cast<CrInt16>(static_cast<CrInt16u>(value)) / 1000.0; }
+        static constexpr bool isNumeric(CrInt64u) { return true; }
+    };
+
+    template<>
+    struct Codec<PACKING_FRACTION> {
+        typedef double value_type; // seconds; 0 is BULB
+
+        // Sony writes fast speeds as 1/n and slow ones in tenths of a second
+        static constexpr CrInt64u encode(double seconds) {
+            return seconds <= 0 ? 0
+                 : seconds < 0.3 ? (CrInt64u(1) << 16) | static_cast<CrInt64u>(1.0 / seconds + 0.5)
+                 : (static_cast<CrInt64u>(seconds * 10.0 + 0.5) << 16) | 10;
+        }
+        static constexpr double decode(CrInt64u value) {
+            return denominator(value) == 0 ? 0.0 : static_cast<double>(numerator(value)) / denominator(value);
+        }
+        static constexpr bool isNumeric(CrInt64u value) { return numerator(value) != 0 && denominator(value) != 0; }
+        static constexpr CrInt64u numerator(CrInt64u value) { return (value >> 16) & 0xFFFF; }
+        static constexpr CrInt64u denominator(CrInt64u value) { return value & 0xFFFF; }
+    };
+
+    template<>
+    struct Codec<PACKING_ISO> {
+        typedef int value_type; // 0 is AUTO
+        static constexpr CrInt64u kAuto = 0x00FFFFFF;
+        static constexpr CrInt64u encode(int iso) { return iso <= 0 ? kAuto : static_cast<CrInt64u>(iso); }
+        static constexpr int decode(CrInt64u value) {
+            return (value & 0x00FFFFFF) == kAuto ? 0 : static_cast<int>(value & 0x00FFFFFF);
+        }
+        static constexpr bool isNumeric(CrInt64u value) { return decode(value) != 0; }
+    };
+
+    template<>
+    struct Codec<PACKING_KELVIN> {
+        typedef int value_type;
+        static constexpr CrInt64u encode(int kelvin) { return static_cast<CrInt64u>(kelvin); }
+        static constexpr int decode(CrInt64u value) { return static_cast<int>(value); }
+        static constexpr bool isNumeric(CrInt64u) { return true; }
+    };
+
+    template<>
+    struct Codec<PACKING_PERCENT> {
+        typedef int value_type;
+        static constexpr CrInt64u encode(int percent) { return static_cast<CrInt64u>(percent); }
+        static constexpr int decode(CrInt64u value) { return static_cast<int>(value); }
+        static constexpr bool isNumeric(CrInt64u) { return true; }
+    };
+
+    //--------------------------------------------------------------
+
+    /**
+     * @brief Typed tag for one property, resolved from the table at compile time
+     */
+    template<CrInt32u Code>
+    struct Property {
+        static_assert(findIndex(Code) < kTableSize, "Property code missing from ofxSonyCameraProperty::kEntries");
+
+        static constexpr CrInt32u code = Code;
+        static constexpr Packing packing = kTable.entries[findIndex(Code)].packing;
+        static constexpr bool readOnly = kTable.entries[findIndex(Code)].readOnly;
+
+        typedef Codec<packing> codec;
+        typedef typename codec::value_type value_type;
+
+        static constexpr CrInt64u encode(value_type value) { return codec::encode(value); }
+        static constexpr value_type decode(CrInt64u value) { return codec::decode(value); }
+        static const char* name() { return kTable.entries[findIndex(Code)].name; }
+    };
+
+    // Exposure
+    typedef Property<SCRSDK::CrDeviceProperty_FNumber> FNumber;
+    typedef Property<SCRSDK::CrDeviceProperty_ShutterSpeed> ShutterSpeed;
+    typedef Property<SCRSDK::CrDeviceProperty_IsoSensitivity> Iso;
+    typedef Property<SCRSDK::CrDeviceProperty_ExposureBiasCompensation> ExposureCompensation;
+    typedef Property<SCRSDK::CrDeviceProperty_ExposureProgramMode> ExposureMode;
+    typedef Property<SCRSDK::CrDeviceProperty_MeteringMode> MeteringMode;
+    typedef Property<SCRSDK::CrDeviceProperty_FlashCompensation> FlashCompensation;
+
+    // Focus
+    typedef Property<SCRSDK::CrDeviceProperty_FocusMode> FocusMode;
+    typedef Property<SCRSDK::CrDeviceProperty_FocusArea> FocusArea;
+    typedef Property<SCRSDK::CrDeviceProperty_FocusIndication> FocusIndication;
+
+    // White balance
+    typedef Property<SCRSDK::CrDeviceProperty_WhiteBalance> WhiteBalance;
+    typedef Property<SCRSDK::CrDeviceProperty_Colortemp> ColorTemperature;
+
+    // Drive and still image
+    typedef Property<SCRSDK::CrDeviceProperty_DriveMode> DriveMode;
+    typedef Property<SCRSDK::CrDeviceProperty_FileType> FileType;
+    typedef Property<SCRSDK::CrDeviceProperty_StillImageStoreDestination> SaveDestination;
+
+    // Movie
+    typedef Property<SCRSDK::CrDeviceProperty_Movie_File_Format> MovieFormat;
+    typedef Property<SCRSDK::CrDeviceProperty_Movie_Recording_Setting> MovieQuality;
+    typedef Property<SCRSDK::CrDeviceProperty_Movie_Recording_FrameRateSetting> MovieFrameRate;
+    typedef Property<SCRSDK::CrDeviceProperty_RecordingState> RecordingState;
+
+    // Status
+    typedef Property<SCRSDK::CrDeviceProperty_BatteryRemain> Battery;
+}
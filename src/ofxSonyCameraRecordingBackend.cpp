@@ -0,0 +1,237 @@
+#include "ofxSonyCameraRecordingBackend.h"
+#include "ofMain.h"
+
+typedef ofxSonyCameraTrace::Record Record;
+
+ofxSonyCameraRecordingBackend::ofxSonyCameraRecordingBackend(std::shared_ptr<ofxSonyCameraBackend> backend, const std::string& path)
+    : mBackend(backend)
+    , mNextConnection(1) {
+    mTrace.open(path);
+}
+
+ofxSonyCameraRecordingBackend::~ofxSonyCameraRecordingBackend() {
+    mTrace.close();
+}
+
+bool ofxSonyCameraRecordingBackend::isRecording() const {
+    return mTrace.isOpen();
+}
+
+const ofxSonyCameraTrace& ofxSonyCameraRecordingBackend::getTrace() const {
+    return mTrace;
+}
+
+bool ofxSonyCameraRecordingBackend::init() {
+    return mBackend->init();
+}
+
+void ofxSonyCameraRecordingBackend::release() {
+    mBackend->release();
+}
+
+CrInt32u ofxSonyCameraRecordingBackend::getSdkVersion() {
+    Record record = makeRecord(Record::TYPE_GET_SDK_VERSION, 0);
+    CrInt32u version = mBackend->getSdkVersion();
+    record.durationMicros = mTrace.getMicros() - record.timeMicros;
+    record.result = version;
+    mTrace.write(record);
+    return version;
+}
+
+SCRSDK::CrError ofxSonyCameraRecordingBackend::enumerate(std::vector<CameraInfo>& cameras) {
+    Record record = makeRecord(Record::TYPE_ENUMERATE, 0);
+    SCRSDK::CrError err = mBackend->enumerate(cameras);
+    for (const CameraInfo& camera : cameras) {
+        CameraInfo recorded;
+        recorded.model = camera.model;
+        recorded.id = camera.id;
+        record.cameras.push_back(recorded);
+    }
+    finishRecord(record, err);
+    return err;
+}
+
+SCRSDK::CrError ofxSonyCameraRecordingBackend::connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) {
+    // The wrapper must exist before connecting: the SDK may notify before Connect() returns
+    Connection connection;
+    connection.number = mNextConnection++;
+    connection.callback = std::make_unique<Callback>(mTrace, connection.number, callback);
+
+    Record record = makeRecord(Record::TYPE_CONNECT, 0);
+    record.connection = connection.number;
+    record.text = camera.id;
+    SCRSDK::CrError err = mBackend->connect(camera, connection.callback.get(), deviceHandle);
+    finishRecord(record, err);
+
+    if (err == SCRSDK::CrError_None) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mConnections[*deviceHandle] = std::move(connection);
+    }
+    return err;
+}
+
+SCRSDK::CrError ofxSonyCameraRecordingBackend::disconnect(SCRSDK::CrDeviceHandle deviceHandle) {
+    Record record = makeRecord(Record::TYPE_DISCONNECT, deviceHandle);
+    SCRSDK::CrError err = mBackend->disconnect(deviceHandle);
+    finishRecord(record, err);
+    return err;
+}
+
+SCRSDK::CrError ofxSonyCameraRecordingBackend::releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) {
+    Record record = makeRecord(Record::TYPE_RELEASE_DEVICE, deviceHandle);
+    SCRSDK::CrError err = mBackend->releaseDevice(deviceHandle);
+    finishRecord(record, err);
+
+    // No notification arrives for the handle anymore, so its wrapper can go
+    std::lock_guard<std::mutex> lock(mMutex);
+    mConnections.erase(deviceHandle);
+    return err;
+}
+
+SCRSDK::CrError ofxSonyCameraRecordingBackend::sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) {
+    Record record = makeRecord(Record::TYPE_SEND_COMMAND, deviceHandle);
+    record.args[0] = commandId;
+    record.args[1] = commandParam;
+    SCRSDK::CrError err = mBackend->sendCommand(deviceHandle, commandId, commandParam);
+    finishRecord(record, err);
+    return err;
+}
+
+SCRSDK::CrError ofxSonyCameraRecordingBackend::getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) {
+    Record record = makeRecord(Record::TYPE_GET_DEVICE_PROPERTIES, deviceHandle);
+    SCRSDK::CrError err = mBackend->getDeviceProperties(deviceHandle, properties);
+    record.durationMicros = mTrace.getMicros() - record.timeMicros;
+    if (err == SCRSDK::CrError_None) {
+        record.properties = properties;
+    }
+    record.result = err;
+    mTrace.write(record);
+    return err;
+}
+
+SCRSDK::CrError ofxSonyCameraRecordingBackend::getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) {
+    Record record = makeRecord(Record::TYPE_GET_SELECT_DEVICE_PROPERTIES, deviceHandle);
+    if (codes) {
+        record.codes.assign(codes, codes + numOfCodes);
+    }
+    SCRSDK::CrError err = mBackend->getSelectDeviceProperties(deviceHandle, numOfCodes, codes, properties);
+    record.durationMicros = mTrace.getMicros() - record.timeMicros;
+    if (err == SCRSDK::CrError_None) {
+        record.properties = properties;
+    }
+    record.result = err;
+    mTrace.write(record);
+    return err;
+}
+
+SCRSDK::CrError ofxSonyCameraRecordingBackend::setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) {
+    Record record = makeRecord(Record::TYPE_SET_DEVICE_PROPERTY, deviceHandle);
+    record.args[0] = property.code;
+    record.args[1] = property.value;
+    SCRSDK::CrError err = mBackend->setDeviceProperty(deviceHandle, property);
+    finishRecord(record, err);
+    return err;
+}
+
+std::unique_ptr<ofxSonyCameraLiveViewSource> ofxSonyCameraRecordingBackend::createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) {
+    return mBackend->createLiveViewSource(deviceHandle);
+}
+
+Record ofxSonyCameraRecordingBackend::makeRecord(Record::Type type, SCRSDK::CrDeviceHandle deviceHandle) {
+    Record record;
+    record.type = type;
+    if (deviceHandle) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mConnections.find(deviceHandle);
+        if (it != mConnections.end()) {
+            record.connection = it->second.number;
+        }
+    }
+    record.timeMicros = mTrace.getMicros();
+    return record;
+}
+
+void ofxSonyCameraRecordingBackend::finishRecord(Record& record, SCRSDK::CrError err) {
+    record.durationMicros = mTrace.getMicros() - record.timeMicros;
+    record.result = err;
+    mTrace.write(record);
+}
+
+//--------------------------------------------------------------
+ofxSonyCameraRecordingBackend::Callback::Callback(ofxSonyCameraTrace& trace, uint32_t connection, SCRSDK::IDeviceCallback* callback)
+    : mTrace(trace)
+    , mConnection(connection)
+    , mCallback(callback) {
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnConnected(SCRSDK::DeviceConnectionVersioin version) {
+    mTrace.write(makeRecord(Record::TYPE_CONNECTED, version));
+    mCallback->OnConnected(version);
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnDisconnected(CrInt32u error) {
+    mTrace.write(makeRecord(Record::TYPE_DISCONNECTED, error));
+    mCallback->OnDisconnected(error);
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnPropertyChanged() {
+    mTrace.write(makeRecord(Record::TYPE_PROPERTY_CHANGED));
+    mCallback->OnPropertyChanged();
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes) {
+    Record record = makeRecord(Record::TYPE_PROPERTY_CHANGED_CODES);
+    if (codes) {
+        record.codes.assign(codes, codes + num);
+    }
+    mTrace.write(record);
+    mCallback->OnPropertyChangedCodes(num, codes);
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnLvPropertyChanged() {
+    mTrace.write(makeRecord(Record::TYPE_LV_PROPERTY_CHANGED));
+    mCallback->OnLvPropertyChanged();
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes) {
+    Record record = makeRecord(Record::TYPE_LV_PROPERTY_CHANGED_CODES);
+    if (codes) {
+        record.codes.assign(codes, codes + num);
+    }
+    mTrace.write(record);
+    mCallback->OnLvPropertyChangedCodes(num, codes);
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnCompleteDownload(CrChar* filename, CrInt32u type) {
+    Record record = makeRecord(Record::TYPE_COMPLETE_DOWNLOAD, type);
+    record.text = filename ? filename : "";
+    mTrace.write(record);
+    mCallback->OnCompleteDownload(filename, type);
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnNotifyContentsTransfer(CrInt32u notify, SCRSDK::CrContentHandle handle, CrChar* filename) {
+    Record record = makeRecord(Record::TYPE_NOTIFY_CONTENTS_TRANSFER, notify);
+    record.args[1] = handle;
+    record.text = filename ? filename : "";
+    mTrace.write(record);
+    mCallback->OnNotifyContentsTransfer(notify, handle, filename);
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnWarning(CrInt32u warning) {
+    mTrace.write(makeRecord(Record::TYPE_WARNING, warning));
+    mCallback->OnWarning(warning);
+}
+
+void ofxSonyCameraRecordingBackend::Callback::OnError(CrInt32u error) {
+    mTrace.write(makeRecord(Record::TYPE_ERROR, error));
+    mCallback->OnError(error);
+}
+
+Record ofxSonyCameraRecordingBackend::Callback::makeRecord(Record::Type type, CrInt64u value) {
+    Record record;
+    record.type = type;
+    record.timeMicros = mTrace.getMicros();
+    record.connection = mConnection;
+    record.args[0] = value;
+    return record;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ofxSonyCameraBackend.h"
+#include "ofxSonyCameraTrace.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief Backend recording another backend's calls and notifications to a trace
+ *
+ * Forwards every call to the wrapped backend and appends it, with its
+ * arguments, result, start time and duration, to an ofxSonyCameraTrace. Each
+ * connection's IDeviceCallback is wrapped too, so every notification is
+ * recorded before it is passed on. Connections are numbered within the trace
+ * rather than recorded by SDK handle, so a replay can tell them apart.
+ *
+ * Live view frames are not recorded.
+ */
+class ofxSonyCameraRecordingBackend : public ofxSonyCameraBackend {
+public:
+    /**
+     * @param backend The backend to record, e.g. an ofxSonyCameraSdkBackend
+     * @param path The trace file, replaced if it exists
+     */
+    ofxSonyCameraRecordingBackend(std::shared_ptr<ofxSonyCameraBackend> backend, const std::string& path);
+    ~ofxSonyCameraRecordingBackend();
+
+    /**
+     * @brief Check whether the trace is being written
+     */
+    bool isRecording() const;
+
+    const ofxSonyCameraTrace& getTrace() const;
+
+    // ofxSonyCameraBackend
+    bool init() override;
+    void release() override;
+    CrInt32u getSdkVersion() override;
+    SCRSDK::CrError enumerate(std::vector<CameraInfo>& cameras) override;
+    SCRSDK::CrError connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) override;
+    SCRSDK::CrError disconnect(SCRSDK::CrDeviceHandle deviceHandle) override;
+    SCRSDK::CrError releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) override;
+    SCRSDK::CrError sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) override;
+    SCRSDK::CrError getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) override;
+    SCRSDK::CrError getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) override;
+    SCRSDK::CrError setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) override;
+    std::unique_ptr<ofxSonyCameraLiveViewSource> createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) override;
+
+private:
+    // Records a connection's notifications, then passes them on
+    class Callback : public SCRSDK::IDeviceCallback {
+    public:
+        Callback(ofxSonyCameraTrace& trace, uint32_t connection, SCRSDK::IDeviceCallback* callback);
+
+        void OnConnected(SCRSDK::DeviceConnectionVersioin version) override;
+        void OnDisconnected(CrInt32u error) override;
+        void OnPropertyChanged() override;
+        void OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes) override;
+        void OnLvPropertyChanged() override;
+        void OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes) override;
+        void OnCompleteDownload(CrChar* filename, CrInt32u type) override;
+        void OnNotifyContentsTransfer(CrInt32u notify, SCRSDK::CrContentHandle handle, CrChar* filename) override;
+        void OnWarning(CrInt32u warning) override;
+        void OnError(CrInt32u error) override;
+
+    private:
+        ofxSonyCameraTrace::Record makeRecord(ofxSonyCameraTrace::Record::Type type, CrInt64u value = 0);
+
+        ofxSonyCameraTrace& mTrace;
+        uint32_t mConnection;
+        SCRSDK::IDeviceCallback* mCallback;
+    };
+
+    ofxSonyCameraTrace::Record makeRecord(ofxSonyCameraTrace::Record::Type type, SCRSDK::CrDeviceHandle deviceHandle);
+    void finishRecord(ofxSonyCameraTrace::Record& record, SCRSDK::CrError err);
+
+    std::shared_ptr<ofxSonyCameraBackend> mBackend;
+    ofxSonyCameraTrace mTrace;
+
+    // Wrapped callbacks and trace numbers of open connections
+    struct Connection {
+        uint32_t number = 0;
+        std::unique_ptr<Callback> callback;
+    };
+    std::map<SCRSDK::CrDeviceHandle, Connection> mConnections;
+    std::atomic<uint32_t> mNextConnection;
+    mutable std::mutex mMutex;
+};
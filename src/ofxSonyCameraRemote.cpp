@@ -1,22 +1,43 @@
 #include "ofxSonyCameraRemote.h"
+#include "ofxSonyCameraLog.h"
+#include "ofxSonyCameraSdk.h"
 #include <dlfcn.h>
 #include <iomanip>
+#include <cstring>
+#include <chrono>
+#include <sys/time.h>
 
 // Sony's vendor ID
 const uint16_t SONY_VENDOR_ID = 0x054C;
 
-// Some known Sony camera product IDs (partial list)
-const std::vector<uint16_t> SONY_PRODUCT_IDS = {
-    0x0994, // Sony Alpha series
-    0x0C28, // Alpha 7 series
-    0x0C29, // Other Alpha models
-    // Add more as identified
-};
+namespace {
+    uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+    
+    int64_t steadyMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
 
 ofxSonyCameraRemote::ofxSonyCameraRemote()
-    : mEnumCameraObjInfo(nullptr)
+    : mBackend(std::make_shared<ofxSonyCameraSdkBackend>())
     , mDeviceHandle(0)
     , mConnected(false)
+    , mSdkAcquired(false)
+    , mProbeLibraries(false)
+    , mPendingDownloads(0)
+    , mFocusHeld(false)
+    , mPressCount(0)
+    , mHeldPress(0)
+    , mLiftPress(0)
+    , mState(STATE_DISCONNECTED)
+    , mReconnectAttempts(0)
+    , mLostError(0)
+    , mLossesPending(0)
+    , mSnapshotStale(false)
     , mUsbContext(nullptr)
     , mLibUsbHandle(nullptr)
     , fn_libusb_init(nullptr)
@@ -31,7 +52,17 @@ ofxSonyCameraRemote::ofxSonyCameraRemote()
     , fn_libusb_get_string_descriptor_ascii(nullptr)
     , fn_libusb_claim_interface(nullptr)
     , fn_libusb_release_interface(nullptr)
-    , fn_libusb_error_name(nullptr) {
+    , fn_libusb_error_name(nullptr)
+    , fn_libusb_has_capability(nullptr)
+    , fn_libusb_hotplug_register_callback(nullptr)
+    , fn_libusb_hotplug_deregister_callback(nullptr)
+    , fn_libusb_handle_events_timeout_completed(nullptr)
+    , mHotplugHandle(0)
+    , mHotplugRunning(false)
+    , mHotplugFirstEventMicros(0)
+    , mHotplugLastEventMicros(0)
+    , mHotplugEnumeratePending(false)
+    , mHotplugArrivalMicros(0) {
 }
 
 ofxSonyCameraRemote::~ofxSonyCameraRemote() {
@@ -39,151 +70,75 @@ ofxSonyCameraRemote::~ofxSonyCameraRemote() {
 }
 
 bool ofxSonyCameraRemote::setup() {
-    // Debug library loading
-    ofLogNotice("ofxSonyCameraRemote") << "Testing library loading...";
-    
-    // Test loading core libraries
-    void* lib1 = dlopen("libCr_Core.dylib", RTLD_LAZY);
-    if (!lib1) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to load libCr_Core.dylib: " << dlerror();
-        lib1 = dlopen("../../../../../libs/CRSDK/lib/libCr_Core.dylib", RTLD_LAZY);
-        if (!lib1) {
-            ofLogError("ofxSonyCameraRemote") << "Failed with relative path too: " << dlerror();
-        } else {
-            ofLogNotice("ofxSonyCameraRemote") << "Loaded with relative path ../../../../../libs/CRSDK/lib/libCr_Core.dylib";
-            dlclose(lib1);
-        }
-    } else {
-        ofLogNotice("ofxSonyCameraRemote") << "Successfully loaded libCr_Core.dylib";
-        dlclose(lib1);
-    }
-    
-    // Check if adapter libraries can be loaded
-    void* lib2 = dlopen("libCr_PTP_IP.dylib", RTLD_LAZY);
-    if (!lib2) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to load libCr_PTP_IP.dylib: " << dlerror();
-        lib2 = dlopen("../../../../../libs/CRSDK/lib/CrAdapter/libCr_PTP_IP.dylib", RTLD_LAZY);
-        if (!lib2) {
-            ofLogError("ofxSonyCameraRemote") << "Failed with relative path too: " << dlerror();
-        } else {
-            ofLogNotice("ofxSonyCameraRemote") << "Loaded with relative path ../../../../../libs/CRSDK/lib/CrAdapter/libCr_PTP_IP.dylib";
-            dlclose(lib2);
-        }
-    } else {
-        ofLogNotice("ofxSonyCameraRemote") << "Successfully loaded libCr_PTP_IP.dylib";
-        dlclose(lib2);
-    }
-    
-    // Check if USB adapter library can be loaded
-    void* lib3 = dlopen("libCr_PTP_USB.dylib", RTLD_LAZY);
-    if (!lib3) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to load libCr_PTP_USB.dylib: " << dlerror();
-        lib3 = dlopen("../../../../../libs/CRSDK/lib/CrAdapter/libCr_PTP_USB.dylib", RTLD_LAZY);
-        if (!lib3) {
-            ofLogError("ofxSonyCameraRemote") << "Failed with relative path too: " << dlerror();
-        } else {
-            ofLogNotice("ofxSonyCameraRemote") << "Loaded with relative path ../../../../../libs/CRSDK/lib/CrAdapter/libCr_PTP_USB.dylib";
-            dlclose(lib3);
-        }
-    } else {
-        ofLogNotice("ofxSonyCameraRemote") << "Successfully loaded libCr_PTP_USB.dylib";
-        dlclose(lib3);
+    // Optional diagnostic: check the SDK's libraries before initializing it
+    auto start = std::chrono::steady_clock::now();
+    if (mProbeLibraries) {
+        ofxSonyCameraSdk::probeLibraries();
     }
+    mStartupTiming.probeMicros = microsSince(start);
     
-    // Check if libusb can be loaded
-    void* lib4 = dlopen("libusb-1.0.dylib", RTLD_LAZY);
-    if (!lib4) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to load libusb-1.0.dylib: " << dlerror();
-        lib4 = dlopen("../../../../../libs/CRSDK/lib/CrAdapter/libusb-1.0.dylib", RTLD_LAZY);
-        if (!lib4) {
-            ofLogError("ofxSonyCameraRemote") << "Failed with relative path too: " << dlerror();
-        } else {
-            ofLogNotice("ofxSonyCameraRemote") << "Loaded with relative path ../../../../../libs/CRSDK/lib/CrAdapter/libusb-1.0.dylib";
-            dlclose(lib4);
+    // Initialize the Sony SDK, shared with any other camera objects
+    start = std::chrono::steady_clock::now();
+    if (!mSdkAcquired) {
+        if (!mBackend->init()) {
+            return false;
         }
-    } else {
-        ofLogNotice("ofxSonyCameraRemote") << "Successfully loaded libusb-1.0.dylib";
-        dlclose(lib4);
+        mSdkAcquired = true;
     }
+    mStartupTiming.sdkInitMicros = microsSince(start);
+    OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraRemote", "Startup: probe {} ms, SDK init {} ms",
+        mStartupTiming.probeMicros / 1000.0, mStartupTiming.sdkInitMicros / 1000.0);
     
-    // Check for monitor protocol libraries
-    void* lib5 = dlopen("libmonitor_protocol.dylib", RTLD_LAZY);
-    if (!lib5) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to load libmonitor_protocol.dylib: " << dlerror();
-        lib5 = dlopen("../../../../../libs/CRSDK/lib/libmonitor_protocol.dylib", RTLD_LAZY);
-        if (!lib5) {
-            ofLogError("ofxSonyCameraRemote") << "Failed with relative path too: " << dlerror();
-        } else {
-            ofLogNotice("ofxSonyCameraRemote") << "Loaded with relative path ../../../../../libs/CRSDK/lib/libmonitor_protocol.dylib";
-            dlclose(lib5);
-        }
-    } else {
-        ofLogNotice("ofxSonyCameraRemote") << "Successfully loaded libmonitor_protocol.dylib";
-        dlclose(lib5);
-    }
+    // Create callback handler
+    mCallback = std::make_unique<ofxSonyCameraCallback>();
     
-    // Check monitor protocol platform-specific library
-    void* lib6 = dlopen("libmonitor_protocol_pf.dylib", RTLD_LAZY);
-    if (!lib6) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to load libmonitor_protocol_pf.dylib: " << dlerror();
-        lib6 = dlopen("../../../../../libs/CRSDK/lib/libmonitor_protocol_pf.dylib", RTLD_LAZY);
-        if (!lib6) {
-            ofLogError("ofxSonyCameraRemote") << "Failed with relative path too: " << dlerror();
-        } else {
-            ofLogNotice("ofxSonyCameraRemote") << "Loaded with relative path ../../../../../libs/CRSDK/lib/libmonitor_protocol_pf.dylib";
-            dlclose(lib6);
+    // Keep the property cache in sync with the camera's change notifications.
+    // The values are read back on the command thread, never on the SDK's
+    // callback thread, which would hold up the notifications behind them
+    mCallback->setPropertyCodesCallback([this](CrInt32u num, CrInt32u* codes) {
+        // A capture shows up as a property change, e.g. of the remaining shots
+        mShotTracer.markNext(ofxSonyCameraShotTracer::STAGE_CAPTURED);
+        std::vector<CrInt32u> changed;
+        if (codes) {
+            changed.assign(codes, codes + num);
         }
-    } else {
-        ofLogNotice("ofxSonyCameraRemote") << "Successfully loaded libmonitor_protocol_pf.dylib";
-        dlclose(lib6);
-    }
-    
-    // Check SSH library (used for network connections)
-    void* lib7 = dlopen("libssh2.dylib", RTLD_LAZY);
-    if (!lib7) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to load libssh2.dylib: " << dlerror();
-        lib7 = dlopen("../../../../../libs/CRSDK/lib/CrAdapter/libssh2.dylib", RTLD_LAZY);
-        if (!lib7) {
-            ofLogError("ofxSonyCameraRemote") << "Failed with relative path too: " << dlerror();
-        } else {
-            ofLogNotice("ofxSonyCameraRemote") << "Loaded with relative path ../../../../../libs/CRSDK/lib/CrAdapter/libssh2.dylib";
-            dlclose(lib7);
+        submitCommand([this, changed]() {
+            refreshProperties(changed);
+            return CrError_None;
+        }, nullptr);
+    });
+    
+    // Count captures until the camera reports their files downloaded
+    mCallback->setDownloadCallback([this](const std::string& filename, CrInt32u type) {
+        mShotTracer.markDownloaded(filename);
+        int pending = mPendingDownloads.load();
+        while (pending > 0 && !mPendingDownloads.compare_exchange_weak(pending, pending - 1)) {
         }
-    } else {
-        ofLogNotice("ofxSonyCameraRemote") << "Successfully loaded libssh2.dylib";
-        dlclose(lib7);
-    }
-    
-    // Check alternate libusb filename pattern
-    void* lib8 = dlopen("libusb-1.0.0.dylib", RTLD_LAZY);
-    if (!lib8) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to load libusb-1.0.0.dylib: " << dlerror();
-        lib8 = dlopen("../../../../../libs/CRSDK/lib/CrAdapter/libusb-1.0.0.dylib", RTLD_LAZY);
-        if (!lib8) {
-            ofLogError("ofxSonyCameraRemote") << "Failed with relative path too: " << dlerror();
-        } else {
-            ofLogNotice("ofxSonyCameraRemote") << "Loaded with relative path ../../../../../libs/CRSDK/lib/CrAdapter/libusb-1.0.0.dylib";
-            dlclose(lib8);
+    });
+    mCallback->setContentsTransferCallback([this](CrInt32u notify) {
+        mShotTracer.markNext(ofxSonyCameraShotTracer::STAGE_TRANSFER_NOTIFIED);
+    });
+    
+    // Track the connection ourselves; the SDK's own reconnection is off
+    mCallback->setDisconnectCallback([this](CrInt32u error) {
+        onConnectionLost(error);
+    });
+    
+    // Everything else reaches the application through pollEvents()
+    mCallback->setEventQueue(&mEvents);
+    
+    // Start the command thread; between commands it lets the shutter up,
+    // sends property writes whose predecessors timed out waiting for
+    // confirmation, and retries lost connections
+    mExecutor.setIdleTask([this]() {
+        liftDueShutter();
+        if (mConnected) {
+            flushPropertyWrites();
+        } else if (mState == STATE_RECONNECTING) {
+            tryReconnect();
         }
-    } else {
-        ofLogNotice("ofxSonyCameraRemote") << "Successfully loaded libusb-1.0.0.dylib";
-        dlclose(lib8);
-    }
-    
-    // Initialize the Sony SDK with error diagnostic
-    ofLogNotice("ofxSonyCameraRemote") << "Initializing Sony Camera Remote SDK...";
-    bool result = SCRSDK::Init();
-    if (!result) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to initialize Sony Camera Remote SDK";
-        return false;
-    }
-    
-	
-    
-	ofLogNotice("ofxSonyCameraRemote") << "SDK initialized successfully";
-    
-    // Create callback handler
-    mCallback = std::make_unique<ofxSonyCameraCallback>();
+    }, std::chrono::milliseconds(100));
+    mExecutor.start();
     
     return true;
 }
@@ -194,17 +149,25 @@ void ofxSonyCameraRemote::exit() {
         disconnect();
     }
     
-    // Clean up device info list
-    mDeviceInfoList.clear();
+    // Stop the command thread once its queue is empty
+    mExecutor.stop();
+    setConnectionState(STATE_DISCONNECTED);
+    
+    // Clean up device info list; this releases the enumerations
+    {
+        std::lock_guard<std::mutex> lock(mDeviceInfoMutex);
+        mDeviceInfoList.clear();
+    }
+    mCamera = ofxSonyCameraBackend::CameraInfo();
     
-    // Release enumeration object
-    if (mEnumCameraObjInfo) {
-        mEnumCameraObjInfo->Release();
-        mEnumCameraObjInfo = nullptr;
+    // Release SDK resources once the last user is gone
+    if (mSdkAcquired) {
+        mBackend->release();
+        mSdkAcquired = false;
     }
     
-    // Release SDK resources
-    SCRSDK::Release();
+    // Stop the hotplug thread before its context goes away
+    stopHotplug();
     
     // Clean up USB resources
     if (mUsbContext && fn_libusb_exit) {
@@ -232,297 +195,1075 @@ void ofxSonyCameraRemote::exit() {
     fn_libusb_claim_interface = nullptr;
     fn_libusb_release_interface = nullptr;
     fn_libusb_error_name = nullptr;
+    fn_libusb_has_capability = nullptr;
+    fn_libusb_hotplug_register_callback = nullptr;
+    fn_libusb_hotplug_deregister_callback = nullptr;
+    fn_libusb_handle_events_timeout_completed = nullptr;
     
     // Clear data
     mUsbDeviceInfoList.clear();
+    mUsbInventory.clear();
 }
 
 bool ofxSonyCameraRemote::enumerateDevices() {
-    // Clear previous device list
-    mDeviceInfoList.clear();
-    
-    // Release previous enumeration
-    if (mEnumCameraObjInfo) {
-        mEnumCameraObjInfo->Release();
-        mEnumCameraObjInfo = nullptr;
-    }
-    
     // Detailed error logging
-    ofLogNotice("ofxSonyCameraRemote") << "Enumerating camera devices...";
-    ofLogNotice("ofxSonyCameraRemote") << "SDK Version: " << SCRSDK::GetSDKVersion();
-    
-    // Enumerate connected cameras
-    CrError err = SCRSDK::EnumCameraObjects(&mEnumCameraObjInfo);
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Enumerating camera devices...");
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "SDK Version: {}", mBackend->getSdkVersion());
+    
+    // Enumerate connected cameras, then replace the previous list; hotplug
+    // and connect() may both be enumerating, from different threads
+    std::vector<ofxSonyCameraBackend::CameraInfo> found;
+    auto start = std::chrono::steady_clock::now();
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_ENUM_CAMERA_OBJECTS, mBackend->enumerate(found));
+    mStartupTiming.enumerateMicros = microsSince(start);
+    
+    {
+        std::lock_guard<std::mutex> lock(mDeviceInfoMutex);
+        mDeviceInfoList = found;
+    }
     
-    // Enhanced error diagnostic based on error code
     if (err != CrError_None) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to enumerate camera devices: " << err;
-        
-        // Convert to hex for easier lookup in header file
-        std::stringstream ss;
-        ss << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << err;
-        ofLogError("ofxSonyCameraRemote") << "Error code in hex: 0x" << ss.str();
-        
-        // More detailed error analysis
-        if (err >= SCRSDK::CrError_Connect && err < SCRSDK::CrError_Memory) {
-            ofLogError("ofxSonyCameraRemote") << "This is a connection-related error. Check camera connectivity.";
-        } else if (err >= SCRSDK::CrError_Adaptor && err < SCRSDK::CrError_Device) {
-            ofLogError("ofxSonyCameraRemote") << "This is an adapter-related error. Check if the camera is in the correct mode (PC Remote or similar).";
-            
-            // More specific diagnostics
-            if (err == SCRSDK::CrError_Adaptor_EnumDevice) {
-                ofLogError("ofxSonyCameraRemote") << "Specifically an enumeration error. Make sure camera is connected and in Remote control mode.";
-            }
-            
-            // Specific handling for error 0x8703 (34563)
-            if (err == 34563) { // 0x8703
-                ofLogError("ofxSonyCameraRemote") << "Error 0x8703: USB device enumeration failure detected.";
-                ofLogError("ofxSonyCameraRemote") << "This usually indicates one of the following:";
-                ofLogError("ofxSonyCameraRemote") << "1. The camera is not in the proper connection mode (needs to be in PC Remote or PC Connection mode)";
-                ofLogError("ofxSonyCameraRemote") << "2. The camera's USB connection is not functioning correctly";
-                ofLogError("ofxSonyCameraRemote") << "3. macOS permissions issues with USB device access";
-                ofLogError("ofxSonyCameraRemote") << "4. Another application has exclusive access to the camera";
-                
-                // Additional diagnostic information specific to macOS
-                ofLogError("ofxSonyCameraRemote") << "Additional troubleshooting steps:";
-                ofLogError("ofxSonyCameraRemote") << "- Check System Information > USB for camera detection";
-                ofLogError("ofxSonyCameraRemote") << "- Try connecting camera to a different USB port";
-                ofLogError("ofxSonyCameraRemote") << "- Restart the camera and ensure it's set to PC Remote mode";
-                ofLogError("ofxSonyCameraRemote") << "- Try using Image Capture app to see if macOS can detect the camera";
-            }
+        const ofxSonyCameraError::Info& info = recordError("enumerate", err);
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to enumerate camera devices: {} (0x{:x}, {} error)",
+            info.name, err, ofxSonyCameraError::getCategoryName(info.category));
+        if (info.action[0]) {
+            OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "{}", info.action);
         }
-        
-        ofLogNotice("ofxSonyCameraRemote") << "DEBUG TIPS:";
-        ofLogNotice("ofxSonyCameraRemote") << "1. Make sure camera is connected via USB or Wi-Fi";
-        ofLogNotice("ofxSonyCameraRemote") << "2. Camera should be in 'PC Remote' or 'Remote Shooting' mode in the camera menu";
-        ofLogNotice("ofxSonyCameraRemote") << "3. Check if libraries are correctly loaded (see above messages)";
-        ofLogNotice("ofxSonyCameraRemote") << "4. Make sure camera isn't already connected to another app";
-        ofLogNotice("ofxSonyCameraRemote") << "5. Try restarting the camera";
-        
         return false;
     }
     
     // Get count of connected cameras
-    int count = mEnumCameraObjInfo->GetCount();
+    int count = found.size();
     if (count == 0) {
-        ofLogNotice("ofxSonyCameraRemote") << "No cameras found. Make sure your camera is:";
-        ofLogNotice("ofxSonyCameraRemote") << "1. Connected via USB or Wi-Fi";
-        ofLogNotice("ofxSonyCameraRemote") << "2. In 'PC Remote' or similar transfer mode";
-        ofLogNotice("ofxSonyCameraRemote") << "3. Not currently being used by another application";
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "No cameras found. Make sure your camera is:");
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "1. Connected via USB or Wi-Fi");
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "2. In 'PC Remote' or similar transfer mode");
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "3. Not currently being used by another application");
         return false;
     }
     
-    // Store camera info objects
+    // Enhanced logging with device details
     for (int i = 0; i < count; i++) {
-        const ICrCameraObjectInfo* camera = mEnumCameraObjInfo->GetCameraObjectInfo(i);
-        mDeviceInfoList.push_back(camera);
-        
-        // Enhanced logging with device details
-        ofLogNotice("ofxSonyCameraRemote") << "Camera " << i << ": Model=" << camera->GetModel()
-                                         << ", Serial=" << camera->GetId();
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Camera {}: Model={}, Serial={}", i, found[i].model, found[i].id);
     }
     
-    ofLogNotice("ofxSonyCameraRemote") << "Found " << count << " camera(s)";
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Found {} camera(s)", count);
     return true;
 }
 
 bool ofxSonyCameraRemote::connect(int deviceIndex) {
+    return connectAsync(deviceIndex).get() == CrError_None;
+}
+
+std::future<CrError> ofxSonyCameraRemote::connectAsync(int deviceIndex) {
+    return submitCommand([this, deviceIndex]() { return doConnect(deviceIndex); });
+}
+
+void ofxSonyCameraRemote::connectAsync(int deviceIndex, std::function<void(CrError)> onComplete) {
+    submitCommand([this, deviceIndex]() { return doConnect(deviceIndex); }, onComplete);
+}
+
+bool ofxSonyCameraRemote::connect(const ofxSonyCameraBackend::CameraInfo& camera) {
+    return connectAsync(camera).get() == CrError_None;
+}
+
+std::future<CrError> ofxSonyCameraRemote::connectAsync(const ofxSonyCameraBackend::CameraInfo& camera) {
+    return submitCommand([this, camera]() { return doConnectCamera(camera); });
+}
+
+void ofxSonyCameraRemote::connectAsync(const ofxSonyCameraBackend::CameraInfo& camera, std::function<void(CrError)> onComplete) {
+    submitCommand([this, camera]() { return doConnectCamera(camera); }, onComplete);
+}
+
+CrError ofxSonyCameraRemote::doConnect(int deviceIndex) {
     // Check if already connected
     if (mConnected) {
-        ofLogWarning("ofxSonyCameraRemote") << "Already connected to a camera";
-        return false;
+        OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraRemote", "Already connected to a camera");
+        return SCRSDK::CrError_Generic_InvalidParameter;
     }
     
     // Check if we have devices in the list
-    if (mDeviceInfoList.empty()) {
-        ofLogNotice("ofxSonyCameraRemote") << "No cameras in device list. Attempting to enumerate...";
+    if (getDeviceCount() == 0) {
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "No cameras in device list. Attempting to enumerate...");
         if (!enumerateDevices()) {
-            return false;
+            return SCRSDK::CrError_Adaptor_EnumDevice;
+        }
+    }
+    
+    // Take a copy: the camera info is shared, and the list may be replaced
+    // by a hotplug enumeration while connecting
+    ofxSonyCameraBackend::CameraInfo camera;
+    {
+        std::lock_guard<std::mutex> lock(mDeviceInfoMutex);
+        if (deviceIndex >= 0 && deviceIndex < mDeviceInfoList.size()) {
+            camera = mDeviceInfoList[deviceIndex];
         }
     }
     
     // Check device index
-    if (deviceIndex < 0 || deviceIndex >= mDeviceInfoList.size()) {
-        ofLogError("ofxSonyCameraRemote") << "Invalid device index: " << deviceIndex;
-        return false;
+    if (!camera.handle) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Invalid device index: {}", deviceIndex);
+        return SCRSDK::CrError_Generic_InvalidParameter;
+    }
+    
+    return doConnectCamera(camera);
+}
+
+CrError ofxSonyCameraRemote::doConnectCamera(const ofxSonyCameraBackend::CameraInfo& camera) {
+    // Check if already connected
+    if (mConnected) {
+        OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraRemote", "Already connected to a camera");
+        return SCRSDK::CrError_Generic_InvalidParameter;
+    }
+    
+    if (!camera.handle || !mCallback) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot connect: no camera info or setup() not called");
+        return SCRSDK::CrError_Generic_InvalidParameter;
     }
     
+    // A new connection starts without settings to restore
+    mAppliedSettings.clear();
+    
+    setConnectionState(STATE_CONNECTING);
+    CrError err = openCamera(camera);
+    if (err != CrError_None) {
+        setConnectionState(STATE_FAILED);
+    }
+    
+    return err;
+}
+
+CrError ofxSonyCameraRemote::openCamera(const ofxSonyCameraBackend::CameraInfo& camera) {
     // Connect to the camera with enhanced logging
-    const ICrCameraObjectInfo* camera = mDeviceInfoList[deviceIndex];
-    ofLogNotice("ofxSonyCameraRemote") << "Connecting to camera: " << camera->GetModel();
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Connecting to camera: {}", camera.model);
     
-    // SDK requires non-const pointer even though it shouldn't modify it
-    CrError err = SCRSDK::Connect(
-        const_cast<ICrCameraObjectInfo*>(camera), // Camera info (cast const away)
+    // The backend connects in remote mode without the SDK's own
+    // reconnection, which is handled by tryReconnect()
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_CONNECT, mBackend->connect(
+        camera,                       // Camera from enumeration
         mCallback.get(),              // Callback handler
-        &mDeviceHandle,               // Output device handle
-        CrSdkControlMode_Remote,      // Remote control mode
-        CrReconnecting_ON     // Auto reconnect
-    );
+        &mDeviceHandle                // Output device handle
+    ));
     
     if (err != CrError_None) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to connect to camera: " << err;
-        
-        // Convert to hex for easier lookup in header file
-        std::stringstream ss;
-        ss << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << err;
-        ofLogError("ofxSonyCameraRemote") << "Error code in hex: 0x" << ss.str();
-        
-        // More detailed diagnostic based on error code
-        if (err == SCRSDK::CrError_Connect_FailRejected) {
-            ofLogError("ofxSonyCameraRemote") << "Connection rejected by camera. Check if it's in the correct mode.";
-        } else if (err == SCRSDK::CrError_Connect_FailBusy) {
-            ofLogError("ofxSonyCameraRemote") << "Camera is busy. It might be connected to another application.";
-        } else if (err == SCRSDK::CrError_Generic_InvalidParameter) {
-            ofLogError("ofxSonyCameraRemote") << "Invalid parameter. This could be an SDK compatibility issue.";
+        const ofxSonyCameraError::Info& info = recordError("connect", err);
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to connect to camera: {} (0x{:x}, {} error)",
+            info.name, err, ofxSonyCameraError::getCategoryName(info.category));
+        if (info.action[0]) {
+            OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "{}", info.action);
         }
         
-        return false;
+        return err;
     }
     
     mConnected = true;
-    ofLogNotice("ofxSonyCameraRemote") << "Connected to camera: " << camera->GetModel();
+    setConnectionState(STATE_CONNECTED);
+    mCamera = camera;
+    mModel = camera.model;
+    mSerialNumber = camera.id;
+    mMetrics.setCamera(mSerialNumber);
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Connected to camera: {}", camera.model);
     
     // Load initial properties
     loadProperties();
     
-    return true;
+    return CrError_None;
 }
 
 bool ofxSonyCameraRemote::disconnect() {
+    return disconnectAsync().get() == CrError_None;
+}
+
+std::future<CrError> ofxSonyCameraRemote::disconnectAsync() {
+    return submitCommand([this]() { return doDisconnect(); });
+}
+
+void ofxSonyCameraRemote::disconnectAsync(std::function<void(CrError)> onComplete) {
+    submitCommand([this]() { return doDisconnect(); }, onComplete);
+}
+
+CrError ofxSonyCameraRemote::doDisconnect() {
     if (!mConnected) {
-        ofLogWarning("ofxSonyCameraRemote") << "Not connected to any camera";
-        return false;
+        // Stop trying to get a lost camera back
+        ConnectionState state = mState;
+        if (state == STATE_RECONNECTING || state == STATE_FAILED) {
+            if (state == STATE_RECONNECTING) {
+                finishReconnect(false);
+            }
+            mAppliedSettings.clear();
+            setConnectionState(STATE_DISCONNECTED);
+            return CrError_None;
+        }
+        OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraRemote", "Not connected to any camera");
+        return SCRSDK::CrError_Connect;
     }
     
+    // Leave the connected state first, so OnDisconnected isn't taken for a lost connection
+    setConnectionState(STATE_DISCONNECTED);
+    
+    // Stop pulling frames before the handle goes away
+    mLiveView.stop();
+    
     // Disconnect from the camera
-    CrError err = SCRSDK::Disconnect(mDeviceHandle);
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_DISCONNECT, mBackend->disconnect(mDeviceHandle));
     if (err != CrError_None) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to disconnect from camera: " << err;
-        return false;
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to disconnect from camera: {}", recordError("disconnect", err).name);
+        setConnectionState(STATE_CONNECTED);
+        return err;
     }
     
     // Release device
-    err = SCRSDK::ReleaseDevice(mDeviceHandle);
+    err = mBackend->releaseDevice(mDeviceHandle);
     if (err != CrError_None) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to release camera: " << err;
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to release camera: {}", recordError("release", err).name);
     }
     
     mConnected = false;
     mDeviceHandle = 0;
+    mCamera = ofxSonyCameraBackend::CameraInfo();
+    mAppliedSettings.clear();
+    mPropertyCache.clear();
+    mWriteQueue.clear();
+    mPendingDownloads = 0;
+    mShotTracer.abandonAll();
+    resetShutter();
+    {
+        std::lock_guard<std::mutex> lock(mValueTablesMutex);
+        mValueTables.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mSnapshotMutex);
+        mLiveSnapshot = ofxSonyCameraPropertySnapshot();
+        mSnapshotStale = false;
+        mSnapshot.reset();
+    }
     
-    ofLogNotice("ofxSonyCameraRemote") << "Disconnected from camera";
-    return true;
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Disconnected from camera");
+    return CrError_None;
 }
 
 bool ofxSonyCameraRemote::isConnected() const {
     return mConnected;
 }
 
-bool ofxSonyCameraRemote::capturePhoto() {
+ofxSonyCameraRemote::ConnectionState ofxSonyCameraRemote::getConnectionState() const {
+    return mState;
+}
+
+void ofxSonyCameraRemote::setReconnectSettings(const ReconnectSettings& settings) {
+    std::lock_guard<std::mutex> lock(mReconnectMutex);
+    mReconnectSettings = settings;
+}
+
+ofxSonyCameraRemote::ReconnectSettings ofxSonyCameraRemote::getReconnectSettings() const {
+    std::lock_guard<std::mutex> lock(mReconnectMutex);
+    return mReconnectSettings;
+}
+
+std::vector<ofxSonyCameraRemote::ReconnectIncident> ofxSonyCameraRemote::getReconnectIncidents() const {
+    std::lock_guard<std::mutex> lock(mReconnectMutex);
+    return mReconnectIncidents;
+}
+
+void ofxSonyCameraRemote::setConnectionState(ConnectionState state) {
+    if (mState.exchange(state) == state) {
+        return;
+    }
+    
+    ofxSonyCameraEvent event;
+    event.type = ofxSonyCameraEvent::EVENT_STATE_CHANGED;
+    event.value = state;
+    event.numCodes = 0;
+    event.filename[0] = '\0';
+    mEvents.push(event);
+}
+
+void ofxSonyCameraRemote::onConnectionLost(CrInt32u error) {
+    // Called on the SDK thread. Only a connection we didn't close is lost.
+    // Counted before the state changes, so the idle task doesn't reconnect
+    // before handleConnectionLost() has released the lost handle
+    bool reconnect = getReconnectSettings().enabled;
+    ConnectionState expected = STATE_CONNECTED;
+    mLossesPending++;
+    if (!mState.compare_exchange_strong(expected, reconnect ? STATE_RECONNECTING : STATE_DISCONNECTED)) {
+        mLossesPending--;
+        return;
+    }
+    mConnected = false;
+    
+    ofxSonyCameraEvent event;
+    event.type = ofxSonyCameraEvent::EVENT_STATE_CHANGED;
+    event.value = reconnect ? STATE_RECONNECTING : STATE_DISCONNECTED;
+    event.numCodes = 0;
+    event.filename[0] = '\0';
+    mEvents.push(event);
+    
+    OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraRemote", "Lost connection to camera: {}", error);
+    submitCommand([this, error]() { return handleConnectionLost(error); }, nullptr);
+}
+
+CrError ofxSonyCameraRemote::handleConnectionLost(CrInt32u error) {
+    releaseDevice();
+    
+    if (mState != STATE_RECONNECTING) {
+        mAppliedSettings.clear();
+        mLossesPending--;
+        return CrError_None;
+    }
+    
+    mLostTime = std::chrono::steady_clock::now();
+    mNextReconnectTime = mLostTime + std::chrono::milliseconds(getReconnectSettings().initialDelayMs);
+    mReconnectAttempts = 0;
+    mLostError = error;
+    mLossesPending--;
+    return CrError_None;
+}
+
+void ofxSonyCameraRemote::releaseDevice() {
+    // The handle of a lost connection still has to be released
+    mLiveView.stop();
+    if (mDeviceHandle) {
+        CrError err = mBackend->releaseDevice(mDeviceHandle);
+        if (err != CrError_None) {
+            OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to release camera: {}", err);
+        }
+        mDeviceHandle = 0;
+    }
+    
+    // Nothing in flight will be confirmed or downloaded any more
+    mWriteQueue.clear();
+    mPendingDownloads = 0;
+    mShotTracer.abandonAll();
+    resetShutter();
+}
+
+void ofxSonyCameraRemote::tryReconnect() {
+    // The lost handle is released, and the backoff started, first
+    auto now = std::chrono::steady_clock::now();
+    if (mLossesPending > 0 || now < mNextReconnectTime) {
+        return;
+    }
+    
+    ReconnectSettings settings = getReconnectSettings();
+    mReconnectAttempts++;
+    CrError err = reconnectBySerialNumber();
+    if (err == CrError_None) {
+        finishReconnect(true);
+        
+        // Restore what the application had set; the camera may have reset it
+        for (const auto& setting : mAppliedSettings) {
+            CrInt64u current;
+            if (!mPropertyCache.get(setting.first, current) || current != setting.second) {
+                mWriteQueue.submit(setting.first, setting.second);
+            }
+        }
+        flushPropertyWrites();
+        return;
+    }
+    
+    // No point waiting for an error that retrying can't fix
+    const ofxSonyCameraError::Info& info = recordError("reconnect", err);
+    if (settings.stopOnPermanentError && !info.retryable) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Giving up reconnecting: {} won't go away by retrying", info.name);
+        if (info.action[0]) {
+            OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "{}", info.action);
+        }
+        setConnectionState(STATE_FAILED);
+        finishReconnect(false);
+        return;
+    }
+    
+    if (settings.maxAttempts > 0 && mReconnectAttempts >= settings.maxAttempts) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Giving up reconnecting after {} attempts", mReconnectAttempts);
+        setConnectionState(STATE_FAILED);
+        finishReconnect(false);
+        return;
+    }
+    
+    // Exponential backoff, capped
+    uint64_t delayMs = settings.initialDelayMs;
+    for (int i = 0; i < mReconnectAttempts && delayMs < settings.maxDelayMs; i++) {
+        delayMs *= 2;
+    }
+    delayMs = std::min(delayMs, settings.maxDelayMs);
+    mNextReconnectTime = now + std::chrono::milliseconds(delayMs);
+    OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraRemote", "Reconnect attempt {} failed: {}, next in {} ms", mReconnectAttempts, info.name, delayMs);
+}
+
+CrError ofxSonyCameraRemote::reconnectBySerialNumber() {
+    // Our own enumeration, so the application's device list stays valid
+    std::vector<ofxSonyCameraBackend::CameraInfo> cameras;
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_ENUM_CAMERA_OBJECTS, mBackend->enumerate(cameras));
+    if (err != CrError_None) {
+        return err;
+    }
+    
+    // The same body, wherever it enumerated this time
+    for (const auto& camera : cameras) {
+        if (camera.id == mSerialNumber) {
+            return openCamera(camera);
+        }
+    }
+    return SCRSDK::CrError_Adaptor_EnumDevice;
+}
+
+void ofxSonyCameraRemote::finishReconnect(bool recovered) {
+    ReconnectIncident incident;
+    incident.error = mLostError;
+    incident.attempts = mReconnectAttempts;
+    incident.recovered = recovered;
+    incident.recoverMicros = microsSince(mLostTime);
+    
+    if (recovered) {
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Reconnected to camera after {} ms ({} attempts)",
+            incident.recoverMicros / 1000.0, incident.attempts);
+    }
+    
+    std::lock_guard<std::mutex> lock(mReconnectMutex);
+    mReconnectIncidents.push_back(incident);
+    if (mReconnectIncidents.size() > kMaxReconnectIncidents) {
+        mReconnectIncidents.erase(mReconnectIncidents.begin());
+    }
+}
+
+const ofxSonyCameraError::Info& ofxSonyCameraRemote::recordError(const char* operation, CrError err) {
+    const ofxSonyCameraError::Info& info = ofxSonyCameraError::lookup(err);
+    
+    std::lock_guard<std::mutex> lock(mErrorMutex);
+    mLastError.code = err;
+    mLastError.category = info.category;
+    mLastError.retryable = info.retryable;
+    mLastError.name = info.name;
+    mLastError.action = info.action;
+    mLastError.operation = operation;
+    return info;
+}
+
+ofxSonyCameraRemote::ErrorReport ofxSonyCameraRemote::getLastError() const {
+    std::lock_guard<std::mutex> lock(mErrorMutex);
+    return mLastError;
+}
+
+bool ofxSonyCameraRemote::capturePhoto() {
+    return capturePhotoAsync().get() == CrError_None;
+}
+
+std::future<CrError> ofxSonyCameraRemote::capturePhotoAsync() {
+    uint64_t shot = mShotTracer.begin();
+    return submitCommand([this, shot]() { return doCapturePhoto(shot); });
+}
+
+void ofxSonyCameraRemote::capturePhotoAsync(std::function<void(CrError)> onComplete) {
+    uint64_t shot = mShotTracer.begin();
+    submitCommand([this, shot]() { return doCapturePhoto(shot); }, onComplete);
+}
+
+CrError ofxSonyCameraRemote::releaseShutter() {
+    uint64_t press = 0;
+    CrError err = pressShutter(mShotTracer.begin(), false, press);
+    if (err != CrError_None) {
+        return err;
+    }
+    
+    // The command thread owns the deadline; handing it over doesn't block
+    auto due = std::chrono::steady_clock::now() + std::chrono::milliseconds(getShutterSettings().releaseHoldMs);
+    submitCommand([this, press, due]() {
+        scheduleLift(press, due);
+        return CrError_None;
+    }, nullptr);
+    return CrError_None;
+}
+
+bool ofxSonyCameraRemote::captureContinuous(uint64_t holdMs) {
+    return captureContinuousAsync(holdMs).get() == CrError_None;
+}
+
+std::future<CrError> ofxSonyCameraRemote::captureContinuousAsync(uint64_t holdMs) {
+    uint64_t shot = mShotTracer.begin();
+    return submitCommand([this, shot, holdMs]() { return doCaptureContinuous(shot, holdMs); });
+}
+
+bool ofxSonyCameraRemote::holdFocus() {
+    return submitCommand([this]() { return doHoldFocus(true); }).get() == CrError_None;
+}
+
+bool ofxSonyCameraRemote::releaseFocus() {
+    return submitCommand([this]() { return doHoldFocus(false); }).get() == CrError_None;
+}
+
+ofxSonyCameraRemote::ShutterState ofxSonyCameraRemote::getShutterState() const {
+    if (mHeldPress != 0) {
+        return SHUTTER_PRESSED;
+    }
+    return mFocusHeld ? SHUTTER_HALF_PRESSED : SHUTTER_IDLE;
+}
+
+void ofxSonyCameraRemote::setShutterSettings(const ShutterSettings& settings) {
+    std::lock_guard<std::mutex> lock(mShutterSettingsMutex);
+    mShutterSettings = settings;
+}
+
+ofxSonyCameraRemote::ShutterSettings ofxSonyCameraRemote::getShutterSettings() const {
+    std::lock_guard<std::mutex> lock(mShutterSettingsMutex);
+    return mShutterSettings;
+}
+
+ofxSonyCameraShotTracer::StageStats ofxSonyCameraRemote::getShutterLag(ShutterMode mode) const {
+    return mShotTracer.getShutterLagStats(mode);
+}
+
+CrError ofxSonyCameraRemote::doCapturePhoto(uint64_t shot) {
+    uint64_t press = 0;
+    CrError err = pressShutter(shot, false, press);
+    if (err == CrError_None) {
+        scheduleLift(press, std::chrono::steady_clock::now() + std::chrono::milliseconds(getShutterSettings().releaseHoldMs));
+    }
+    return err;
+}
+
+CrError ofxSonyCameraRemote::doCaptureContinuous(uint64_t shot, uint64_t holdMs) {
+    uint64_t press = 0;
+    CrError err = pressShutter(shot, true, press);
+    if (err == CrError_None) {
+        scheduleLift(press, std::chrono::steady_clock::now() + std::chrono::milliseconds(holdMs));
+    }
+    return err;
+}
+
+CrError ofxSonyCameraRemote::doHoldFocus(bool hold) {
+    if (!mConnected) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Not connected to any camera");
+        return SCRSDK::CrError_Connect;
+    }
+    
+    // The half-press is a button, not a setting: it bypasses the write
+    // queue and isn't sent again after reconnecting
+    ofxSonyCameraBackend::Property prop;
+    prop.code = CrDeviceProperty_S1;
+    prop.value = hold ? CrLockIndicator_Locked : CrLockIndicator_Unlocked;
+    prop.type = CrDataType_UInt16;
+    
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_SET_DEVICE_PROPERTY, mBackend->setDeviceProperty(
+        mDeviceHandle,  // Device handle
+        prop            // S1 button
+    ));
+    
+    if (err != CrError_None) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to {} focus: {}", hold ? "hold" : "release",
+            recordError(hold ? "hold focus" : "release focus", err).name);
+        return err;
+    }
+    
+    mFocusHeld = hold;
+    OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraRemote", "Shutter {}", hold ? "half-pressed" : "let go from half-press");
+    return CrError_None;
+}
+
+CrError ofxSonyCameraRemote::pressShutter(uint64_t shot, bool continuous, uint64_t& press) {
+    if (!mConnected) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Not connected to any camera");
+        mShotTracer.markReturned(shot, true);
+        return SCRSDK::CrError_Connect;
+    }
+    
+    ShutterMode mode = continuous ? SHUTTER_CONTINUOUS : mFocusHeld ? SHUTTER_PREFOCUSED : SHUTTER_SINGLE;
+    mShotTracer.setMode(shot, mode);
+    
+    // Taking the shutter over and sending Down happen under the shutter
+    // lock, as do the check and the Up in liftDueShutter(), so the Up of a
+    // press still holding the shutter can't come after this Down
+    std::unique_lock<std::mutex> lock(mShutterMutex);
+    press = ++mPressCount;
+    uint64_t previous = mHeldPress.exchange(press);
+    
+    // Count the download before sending: it may complete before SendCommand
+    // returns. Captures saved to the memory card only are never downloaded.
+    bool download = savesToHost();
+    if (download) {
+        mPendingDownloads++;
+    }
+    
+    // Press the shutter
+    mShotTracer.mark(shot, ofxSonyCameraShotTracer::STAGE_SENT);
+    CrError err = sendRelease(CrCommandParam_Down);
+    mShotTracer.markReturned(shot, err != CrError_None);
+    
+    if (err != CrError_None) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to capture photo: {}", recordError("capture", err).name);
+        if (download) {
+            mPendingDownloads--;
+        }
+        
+        // Hand the shutter back unless a newer press has taken it since; its
+        // own Up may have been skipped meanwhile, so it gets another
+        uint64_t failed = press;
+        bool handedBack = mHeldPress.compare_exchange_strong(failed, previous);
+        lock.unlock();
+        if (handedBack && previous != 0) {
+            auto due = std::chrono::steady_clock::now() + std::chrono::milliseconds(getShutterSettings().releaseHoldMs);
+            submitCommand([this, previous, due]() {
+                scheduleLift(previous, due);
+                return CrError_None;
+            }, nullptr);
+        }
+        return err;
+    }
+    
+    return CrError_None;
+}
+
+void ofxSonyCameraRemote::scheduleLift(uint64_t press, std::chrono::steady_clock::time_point due) {
+    // Runs on the command thread. Presses are numbered in order, so a
+    // deadline handed over late for an older press is dropped
+    if (press < mLiftPress) {
+        return;
+    }
+    mLiftPress = press;
+    mLiftDue = due;
+    mExecutor.wakeAt(due);
+}
+
+void ofxSonyCameraRemote::liftDueShutter() {
+    // Runs on the command thread, from the idle task
+    if (mLiftPress == 0) {
+        return;
+    }
+    if (std::chrono::steady_clock::now() < mLiftDue) {
+        mExecutor.wakeAt(mLiftDue);
+        return;
+    }
+    
+    uint64_t press = mLiftPress;
+    mLiftPress = 0;
+    
+    // Only if that press still holds the shutter: a newer one lets itself up
+    std::lock_guard<std::mutex> lock(mShutterMutex);
+    if (!mHeldPress.compare_exchange_strong(press, 0)) {
+        return;
+    }
+    
+    CrError err = sendRelease(CrCommandParam_Up);
+    if (err != CrError_None) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to let the shutter up: {}", recordError("release shutter", err).name);
+    }
+}
+
+CrError ofxSonyCameraRemote::sendRelease(CrCommandParam param) {
+    return OFX_SONY_CAMERA_TIMED(mMetrics, CALL_SEND_COMMAND, mBackend->sendCommand(
+        mDeviceHandle,        // Device handle
+        CrCommandId_Release,  // Shutter command
+        param                 // Press or let up
+    ));
+}
+
+void ofxSonyCameraRemote::resetShutter() {
+    // The camera lets go of its buttons when the connection ends
+    mHeldPress = 0;
+    mLiftPress = 0;
+    mFocusHeld = false;
+}
+
+bool ofxSonyCameraRemote::startLiveView() {
+    if (!mConnected) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot start live view: Not connected");
+        return false;
+    }
+    
+    return mLiveView.start(mBackend->createLiveViewSource(mDeviceHandle));
+}
+
+void ofxSonyCameraRemote::stopLiveView() {
+    mLiveView.stop();
+}
+
+ofxSonyCameraLiveView& ofxSonyCameraRemote::getLiveView() {
+    return mLiveView;
+}
+
+std::future<CrError> ofxSonyCameraRemote::submitCommand(std::function<CrError()> command) {
+    auto promise = std::make_shared<std::promise<CrError>>();
+    std::future<CrError> future = promise->get_future();
+    
+    // Run inline before setup(), after exit() and when already on the command thread
+    if (mExecutor.isCommandThread() || !mExecutor.submit([promise, command]() {
+            promise->set_value(command());
+        })) {
+        promise->set_value(command());
+    }
+    
+    return future;
+}
+
+void ofxSonyCameraRemote::submitCommand(std::function<CrError()> command, std::function<void(CrError)> onComplete) {
+    auto task = [command, onComplete]() {
+        CrError err = command();
+        if (onComplete) {
+            onComplete(err);
+        }
+    };
+    
+    if (mExecutor.isCommandThread() || !mExecutor.submit(task)) {
+        task();
+    }
+}
+
+void ofxSonyCameraRemote::loadProperties() {
+    if (!mConnected) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot load properties: Not connected");
+        return;
+    }
+    
+    // Get all device properties
+    std::vector<ofxSonyCameraBackend::Property> properties;
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_GET_DEVICE_PROPERTIES, mBackend->getDeviceProperties(
+        mDeviceHandle,    // Device handle
+        properties        // Output properties
+    ));
+    
+    if (err != CrError_None) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to get device properties: {}", recordError("get properties", err).name);
+        return;
+    }
+    
+    // Fill the property cache, value tables and snapshot
+    storeProperties(properties, true);
+    
+    // Log property information
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Loaded {} properties", properties.size());
+}
+
+void ofxSonyCameraRemote::refreshProperties(const std::vector<CrInt32u>& codes) {
+    // Runs on the command thread, queued by the SDK's change notifications
+    if (!mConnected) {
+        return;
+    }
+    
+    CrInt32u num = static_cast<CrInt32u>(codes.size());
+    if (codes.empty()) {
+        // Without a code list every property may have changed
+        mPropertyCache.invalidateAll();
+        loadProperties();
+    } else {
+        // Read back only the properties that changed
+        std::vector<ofxSonyCameraBackend::Property> properties;
+        std::vector<CrInt32u> changed = codes;
+        CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_GET_SELECT_DEVICE_PROPERTIES, mBackend->getSelectDeviceProperties(
+            mDeviceHandle,    // Device handle
+            num,              // Number of property codes
+            changed.data(),   // Changed property codes
+            properties        // Output properties
+        ));
+        
+        if (err != CrError_None) {
+            // Fall back to reading them on demand
+            OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraRemote", "Failed to refresh {} changed properties: {}", num,
+                recordError("refresh properties", err).name);
+            mPropertyCache.invalidate(num, changed.data());
+        } else {
+            storeProperties(properties, false);
+        }
+        
+        // The camera applied these writes, so send whatever was queued behind them
+        mWriteQueue.confirm(num, changed.data());
+        flushPropertyWrites();
+    }
+    
+    // Tell the application once the cache holds the new values; too many
+    // codes for one event report every property as changed
+    ofxSonyCameraEvent event;
+    event.type = ofxSonyCameraEvent::EVENT_PROPERTY_CHANGED;
+    event.value = 0;
+    event.numCodes = num <= ofxSonyCameraEvent::kMaxCodes ? num : 0;
+    std::copy(codes.begin(), codes.begin() + event.numCodes, event.codes);
+    event.filename[0] = '\0';
+    mEvents.push(event);
+}
+
+// Property getter and setter implementation
+bool ofxSonyCameraRemote::getProperty(CrInt32u code, CrInt64u& value) {
+    if (!mConnected) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot get property: Not connected");
+        return false;
+    }
+    
+    // Serve from the cache when possible
+    if (mPropertyCache.get(code, value)) {
+        return true;
+    }
+    
+    // Cache miss: read the property from the camera
+    std::vector<ofxSonyCameraBackend::Property> properties;
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_GET_SELECT_DEVICE_PROPERTIES, mBackend->getSelectDeviceProperties(
+        mDeviceHandle,    // Device handle
+        1,                // Number of property codes
+        &code,            // Property code
+        properties        // Output properties
+    ));
+    
+    if (err != CrError_None) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to get property {}: {}", code, recordError("get property", err).name);
+        return false;
+    }
+    if (properties.empty()) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to get property {}: not reported by the camera", code);
+        return false;
+    }
+    
+    // Extract the value and remember it
+    value = properties[0].value;
+    mPropertyCache.store(code, value);
+    
+    return true;
+}
+
+bool ofxSonyCameraRemote::setProperty(CrInt32u code, CrInt64u value) {
+    return setPropertyAsync(code, value).get() == CrError_None;
+}
+
+std::future<CrError> ofxSonyCameraRemote::setPropertyAsync(CrInt32u code, CrInt64u value) {
+    return submitCommand([this, code, value]() { return doSetProperty(code, value); });
+}
+
+void ofxSonyCameraRemote::setPropertyAsync(CrInt32u code, CrInt64u value, std::function<void(CrError)> onComplete) {
+    submitCommand([this, code, value]() { return doSetProperty(code, value); }, onComplete);
+}
+
+CrError ofxSonyCameraRemote::doSetProperty(CrInt32u code, CrInt64u value) {
+    if (!mConnected) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot set property: Not connected");
+        return SCRSDK::CrError_Connect;
+    }
+    
+    mAppliedSettings[code] = value;
+    mWriteQueue.submit(code, value);
+    
+    // Only this write's result: others may go out in the same flush, and
+    // this one may be held back behind an unconfirmed write of the code
+    std::map<CrInt32u, CrError> results;
+    flushPropertyWrites(&results);
+    auto result = results.find(code);
+    return result != results.end() ? result->second : CrError_None;
+}
+
+bool ofxSonyCameraRemote::getProperties(const std::vector<CrInt32u>& codes, std::vector<CrInt64u>& values) {
+    values.assign(codes.size(), 0);
+    
     if (!mConnected) {
-        ofLogError("ofxSonyCameraRemote") << "Not connected to any camera";
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot get properties: Not connected");
         return false;
     }
     
-    // Send shutter command
-    CrError err = SCRSDK::SendCommand(
-        mDeviceHandle,                // Device handle
-        CrCommandId_Release,  // Shutter command
-        CrCommandParam_Down   // Press shutter
-    );
-    
-    if (err != CrError_None) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to capture photo: " << err;
-        return false;
+    // Serve what we can from the cache and collect the rest
+    std::vector<bool> found(codes.size(), false);
+    std::vector<CrInt32u> missing;
+    for (size_t i = 0; i < codes.size(); i++) {
+        if (mPropertyCache.get(codes[i], values[i])) {
+            found[i] = true;
+        } else {
+            missing.push_back(codes[i]);
+        }
     }
     
-    return true;
-}
-
-void ofxSonyCameraRemote::loadProperties() {
-    if (!mConnected) {
-        ofLogError("ofxSonyCameraRemote") << "Cannot load properties: Not connected";
-        return;
+    if (missing.empty()) {
+        return true;
     }
     
-    // Get all device properties
-    CrDeviceProperty* properties = nullptr;
-    CrInt32 numOfProperties = 0;
-    CrError err = SCRSDK::GetDeviceProperties(
-        mDeviceHandle,    // Device handle
-        &properties,      // Output properties
-        &numOfProperties  // Output count
-    );
+    // Read all missing properties in a single request
+    std::vector<ofxSonyCameraBackend::Property> properties;
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_GET_SELECT_DEVICE_PROPERTIES, mBackend->getSelectDeviceProperties(
+        mDeviceHandle,                          // Device handle
+        static_cast<CrInt32u>(missing.size()),  // Number of property codes
+        missing.data(),                         // Property codes
+        properties                              // Output properties
+    ));
     
     if (err != CrError_None) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to get device properties: " << err;
-        return;
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to get {} properties: {}", missing.size(), recordError("get properties", err).name);
+        return false;
     }
     
-    // Log property information
-    ofLogNotice("ofxSonyCameraRemote") << "Loaded " << numOfProperties << " properties";
+    for (const auto& property : properties) {
+        CrInt32u code = property.code;
+        CrInt64u value = property.value;
+        mPropertyCache.store(code, value);
+        
+        for (size_t i = 0; i < codes.size(); i++) {
+            if (!found[i] && codes[i] == code) {
+                values[i] = value;
+                found[i] = true;
+            }
+        }
+    }
     
-    // Release properties when done
-    SCRSDK::ReleaseDeviceProperties(mDeviceHandle, properties);
+    bool allFound = true;
+    for (size_t i = 0; i < codes.size(); i++) {
+        if (!found[i]) {
+            OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to get property {}", codes[i]);
+            allFound = false;
+        }
+    }
+    return allFound;
 }
 
-// Property getter and setter implementation
-bool ofxSonyCameraRemote::getProperty(CrInt32u code, CrInt64u& value) {
+bool ofxSonyCameraRemote::setProperties(const std::vector<std::pair<CrInt32u, CrInt64u>>& values) {
     if (!mConnected) {
-        ofLogError("ofxSonyCameraRemote") << "Cannot get property: Not connected";
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot set properties: Not connected");
         return false;
     }
     
-    // Get specific device properties
-    CrDeviceProperty* properties = nullptr;
-    CrInt32 numOfProperties = 0;
-    CrError err = SCRSDK::GetSelectDeviceProperties(
-        mDeviceHandle,    // Device handle
-        1,                // Number of property codes
-        &code,            // Property code
-        &properties,      // Output properties
-        &numOfProperties  // Output count
-    );
-    
-    if (err != CrError_None || numOfProperties == 0) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to get property " << code << ": " << err;
+    return submitCommand([this, values]() {
+        // Queue every write and send them back to back, on the command
+        // thread so that no other flush sends them and keeps their results
+        for (const auto& entry : values) {
+            // Restored after reconnecting like single writes, including the
+            // values the camera already held
+            mAppliedSettings[entry.first] = entry.second;
+            
+            CrInt64u current;
+            if (!mWriteQueue.isBusy(entry.first) &&
+                mPropertyCache.get(entry.first, current) && current == entry.second) {
+                continue; // Camera already holds this value
+            }
+            mWriteQueue.submit(entry.first, entry.second);
+        }
+        
+        // The batch fails if any of its own writes did
+        std::map<CrInt32u, CrError> results;
+        flushPropertyWrites(&results);
+        CrError batch = CrError_None;
+        for (const auto& entry : values) {
+            auto result = results.find(entry.first);
+            if (result != results.end() && result->second != CrError_None) {
+                batch = result->second;
+            }
+        }
+        return batch;
+    }).get() == CrError_None;
+}
+
+bool ofxSonyCameraRemote::setPropertiesAndWait(const std::vector<std::pair<CrInt32u, CrInt64u>>& values, std::chrono::milliseconds timeout) {
+    // The command thread is what reads the new values back
+    if (mExecutor.isCommandThread()) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot wait for properties on the command thread");
+        return false;
+    }
+    if (!setProperties(values)) {
         return false;
     }
     
-    // Extract the value
-    value = properties[0].GetCurrentValue();
-    
-    // Release properties
-    SCRSDK::ReleaseDeviceProperties(mDeviceHandle, properties);
-    
-    return true;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        bool applied = true;
+        for (const auto& entry : values) {
+            CrInt64u current;
+            if (mWriteQueue.isBusy(entry.first) ||
+                !mPropertyCache.get(entry.first, current) || current != entry.second) {
+                applied = false;
+                break;
+            }
+        }
+        if (applied) {
+            return true;
+        }
+        if (!mConnected || std::chrono::steady_clock::now() >= deadline) {
+            OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraRemote", "Camera didn't report {} properties within {} ms", values.size(), timeout.count());
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
 }
 
-bool ofxSonyCameraRemote::setProperty(CrInt32u code, CrInt64u value) {
-    if (!mConnected) {
-        ofLogError("ofxSonyCameraRemote") << "Cannot set property: Not connected";
-        return false;
+void ofxSonyCameraRemote::flushPropertyWrites(std::map<CrInt32u, CrError>* results) {
+    std::vector<std::pair<CrInt32u, CrInt64u>> ready;
+    mWriteQueue.takeReady(ready);
+    
+    for (const auto& entry : ready) {
+        CrError err = sendProperty(entry.first, entry.second);
+        if (err != CrError_None) {
+            mWriteQueue.fail(entry.first);
+        }
+        if (results) {
+            (*results)[entry.first] = err;
+        }
     }
-    
+}
+
+CrError ofxSonyCameraRemote::sendProperty(CrInt32u code, CrInt64u value) {
     // Create property to set
-    CrDeviceProperty prop;
-    prop.SetCode(code);
-    prop.SetCurrentValue(value);
-    prop.SetValueType(CrDataType_UInt64);
+    ofxSonyCameraBackend::Property prop;
+    prop.code = code;
+    prop.value = value;
+    prop.type = CrDataType_UInt64;
     
     // Set the property
-    CrError err = SCRSDK::SetDeviceProperty(
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_SET_DEVICE_PROPERTY, mBackend->setDeviceProperty(
         mDeviceHandle,  // Device handle
-        &prop           // Property to set
-    );
+        prop            // Property to set
+    ));
     
     if (err != CrError_None) {
-        ofLogError("ofxSonyCameraRemote") << "Failed to set property " << code << ": " << err;
-        return false;
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to set property {}: {}", code, recordError("set property", err).name);
+        return err;
     }
     
-    return true;
+    return CrError_None;
+}
+
+void ofxSonyCameraRemote::storeProperties(const std::vector<ofxSonyCameraBackend::Property>& properties, bool complete) {
+    std::vector<std::pair<CrInt32u, ofxSonyCameraValueTable>> tables;
+    
+    {
+        // A full load starts afresh, a refresh patches only the changed
+        // entries; the copy handed out by getSnapshot() is made on demand
+        std::lock_guard<std::mutex> lock(mSnapshotMutex);
+        if (complete) {
+            mLiveSnapshot = ofxSonyCameraPropertySnapshot();
+        }
+        
+        bool repack = complete;
+        for (const auto& property : properties) {
+            mPropertyCache.store(property.code, property.value);
+            
+            // Switching to the memory card only leaves nothing to download
+            if (property.code == CrDeviceProperty_StillImageStoreDestination &&
+                property.value == CrStillImageStoreDestination_MemoryCard) {
+                mPendingDownloads = 0;
+            }
+            
+            // Value tables are only rebuilt when the possible values changed
+            size_t index = mLiveSnapshot.find(property.code);
+            size_t count = 0;
+            const CrInt64u* possible = index != ofxSonyCameraPropertySnapshot::npos ?
+                mLiveSnapshot.getPossibleValues(index, count) : nullptr;
+            bool changed = count != property.possible.size() ||
+                !std::equal(property.possible.begin(), property.possible.end(), possible);
+            
+            // New codes and longer value lists leave the arrays to re-sort
+            // and the pool to repack
+            repack = repack || index == ofxSonyCameraPropertySnapshot::npos || property.possible.size() > count;
+            
+            mLiveSnapshot.set(property.code, property.value, property.writable, property.possible.data(), property.possible.size());
+            if (changed && !property.possible.empty()) {
+                tables.emplace_back(property.code, ofxSonyCameraValueTable(property.code, property.possible));
+            }
+        }
+        if (repack) {
+            mLiveSnapshot.stamp();
+        }
+        mSnapshotStale = true;
+    }
+    
+    std::lock_guard<std::mutex> lock(mValueTablesMutex);
+    for (auto& entry : tables) {
+        mValueTables[entry.first] = std::move(entry.second);
+    }
+}
+
+bool ofxSonyCameraRemote::savesToHost() {
+    // Cameras that don't report a destination download every capture
+    CrInt64u destination = 0;
+    return !mPropertyCache.get(CrDeviceProperty_StillImageStoreDestination, destination) ||
+        destination != CrStillImageStoreDestination_MemoryCard;
 }
 
 // Function to load libusb functions
@@ -534,22 +1275,19 @@ bool ofxSonyCameraRemote::loadLibUsbFunctions() {
         return true;
     }
     
-    // Try to load the library
-    mLibUsbHandle = dlopen("libusb-1.0.dylib", RTLD_LAZY);
-    if (!mLibUsbHandle) {
-        // Try with path
-        mLibUsbHandle = dlopen("../../../../../libs/CRSDK/lib/CrAdapter/libusb-1.0.dylib", RTLD_LAZY);
-        if (!mLibUsbHandle) {
-            // Try alternate filename
-            mLibUsbHandle = dlopen("libusb-1.0.0.dylib", RTLD_LAZY);
-            if (!mLibUsbHandle) {
-                mLibUsbHandle = dlopen("../../../../../libs/CRSDK/lib/CrAdapter/libusb-1.0.0.dylib", RTLD_LAZY);
-                if (!mLibUsbHandle) {
-                    addUsbError("Failed to load libusb: " + std::string(dlerror()));
-                    return false;
-                }
-            }
+    // Try to load the library from the SDK's search path
+    for (const char* name : { "libusb-1.0.dylib", "libusb-1.0.0.dylib", "libusb-1.0.so.0", "libusb-1.0.so" }) {
+        std::string path = ofxSonyCameraSdk::findLibrary(name);
+        if (!path.empty()) {
+            mLibUsbHandle = dlopen(path.c_str(), RTLD_LAZY);
         }
+        if (mLibUsbHandle) {
+            break;
+        }
+    }
+    if (!mLibUsbHandle) {
+        addUsbError("Failed to load libusb from any library search path");
+        return false;
     }
     
     // Load function pointers
@@ -566,6 +1304,10 @@ bool ofxSonyCameraRemote::loadLibUsbFunctions() {
     fn_libusb_claim_interface = (libusb_claim_interface_fn)dlsym(mLibUsbHandle, "libusb_claim_interface");
     fn_libusb_release_interface = (libusb_release_interface_fn)dlsym(mLibUsbHandle, "libusb_release_interface");
     fn_libusb_error_name = (libusb_error_name_fn)dlsym(mLibUsbHandle, "libusb_error_name");
+    fn_libusb_has_capability = (libusb_has_capability_fn)dlsym(mLibUsbHandle, "libusb_has_capability");
+    fn_libusb_hotplug_register_callback = (libusb_hotplug_register_callback_fn)dlsym(mLibUsbHandle, "libusb_hotplug_register_callback");
+    fn_libusb_hotplug_deregister_callback = (libusb_hotplug_deregister_callback_fn)dlsym(mLibUsbHandle, "libusb_hotplug_deregister_callback");
+    fn_libusb_handle_events_timeout_completed = (libusb_handle_events_timeout_completed_fn)dlsym(mLibUsbHandle, "libusb_handle_events_timeout_completed");
     
     // Check if all functions were loaded
     if (!fn_libusb_init || !fn_libusb_exit || !fn_libusb_get_device_list || !fn_libusb_free_device_list ||
@@ -597,16 +1339,16 @@ bool ofxSonyCameraRemote::debugUsbDevices() {
     // Enumerate all devices
     int count = enumerateAllUsbDevices();
     if (count <= 0) {
-        ofLogError("ofxSonyCameraRemote") << "No USB devices found or error occurred";
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "No USB devices found or error occurred");
         return false;
     }
     
     // Count Sony devices
     int sonyCount = countSonyDevices();
-    ofLogNotice("ofxSonyCameraRemote") << "Found " << sonyCount << " Sony devices out of " << count << " total USB devices";
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Found {} Sony devices out of {} total USB devices", sonyCount, count);
     
     // Print detailed info
-    ofLogNotice("ofxSonyCameraRemote") << getUsbDevicesInfo();
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "{}", getUsbDevicesInfo());
     
     // Return if any Sony devices were found
     return (sonyCount > 0);
@@ -648,7 +1390,7 @@ std::string ofxSonyCameraRemote::getUsbDevicesInfo() const {
         }
         
         ss << "  Alpha 7S III Match: " << (isA7sIII ? "LIKELY" : "NO") << "\n";
-        ss << "  Accessible: " << (info.isAccessible ? "YES" : "NO") << "\n";
+        ss << "  Accessible: " << (!info.isOpened ? "NOT CHECKED" : info.isAccessible ? "YES" : "NO") << "\n";
         ss << "\n";
     }
     
@@ -672,7 +1414,18 @@ int ofxSonyCameraRemote::enumerateAllUsbDevices() {
         return -1;
     }
     
-    mUsbDeviceInfoList.clear();
+    UsbScanResult changes = scanUsbDevices();
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Found {} USB devices ({} new, {} removed)",
+        mUsbDeviceInfoList.size(), changes.added.size(), changes.removed.size());
+    
+    return mUsbDeviceInfoList.size();
+}
+
+ofxSonyCameraRemote::UsbScanResult ofxSonyCameraRemote::scanUsbDevices() {
+    UsbScanResult changes;
+    if (!loadLibUsbFunctions()) {
+        return changes;
+    }
     
     // Get device list
     libusb_device **deviceList;
@@ -680,16 +1433,16 @@ int ofxSonyCameraRemote::enumerateAllUsbDevices() {
     
     if (count < 0) {
         addUsbError("Failed to get USB device list: " + std::string(getLibUsbErrorName(count)));
-        return -1;
+        return changes;
     }
     
-    ofLogNotice("ofxSonyCameraRemote") << "Found " << count << " USB devices";
+    std::map<uint64_t, UsbDeviceInfo> inventory;
     
     // Process each device
     for (ssize_t i = 0; i < count; i++) {
         libusb_device *device = deviceList[i];
         
-        // Get device descriptor
+        // Get device descriptor; this is cached by libusb and never touches the device
         struct libusb_device_descriptor desc;
         int result = fn_libusb_get_device_descriptor(device, &desc);
         
@@ -698,55 +1451,91 @@ int ofxSonyCameraRemote::enumerateAllUsbDevices() {
             continue;
         }
         
+        // Devices already in the inventory keep what was read from them
+        uint8_t busNumber = fn_libusb_get_bus_number(device);
+        uint8_t deviceAddress = fn_libusb_get_device_address(device);
+        uint64_t key = usbDeviceKey(busNumber, deviceAddress, desc);
+        // Cameras that couldn't be opened, e.g. while another process held
+        // them, are tried again on every scan
+        auto cached = mUsbInventory.find(key);
+        bool known = cached != mUsbInventory.end();
+        if (known && !(cached->second.isOpened && !cached->second.isAccessible)) {
+            inventory.insert(*cached);
+            continue;
+        }
+        
         // Create device info
         UsbDeviceInfo info;
         info.vendorId = desc.idVendor;
         info.productId = desc.idProduct;
-        info.busNumber = fn_libusb_get_bus_number(device);
-        info.deviceAddress = fn_libusb_get_device_address(device);
+        info.deviceVersion = desc.bcdDevice;
+        info.busNumber = busNumber;
+        info.deviceAddress = deviceAddress;
         info.isSonyCamera = isSonyCamera(desc.idVendor, desc.idProduct);
+        info.isOpened = false;
         info.isAccessible = false;
         
-        // Try to open the device to get string descriptors
-        libusb_device_handle *handle;
-        result = fn_libusb_open(device, &handle);
-        
-        if (result == LIBUSB_SUCCESS) {
-            info.isAccessible = true;
-            
-            // Get string descriptors if available
-            if (desc.iManufacturer > 0) {
-                info.manufacturer = getUsbDeviceString(handle, desc.iManufacturer);
-            }
-            
-            if (desc.iProduct > 0) {
-                info.product = getUsbDeviceString(handle, desc.iProduct);
-            }
-            
-            if (desc.iSerialNumber > 0) {
-                info.serialNumber = getUsbDeviceString(handle, desc.iSerialNumber);
-            }
-            
-            // Close the device
-            fn_libusb_close(handle);
-        } else {
-            // Device cannot be opened
-            info.isAccessible = false;
+        // Only open possible cameras: opening hubs, docks and capture cards is
+        // slow and can stall on devices busy with other drivers
+        if (info.isSonyCamera) {
+            libusb_device_handle *handle;
+            result = fn_libusb_open(device, &handle);
+            info.isOpened = true;
             
-            if (info.isSonyCamera) {
+            if (result == LIBUSB_SUCCESS) {
+                info.isAccessible = true;
+                
+                // Get string descriptors if available
+                if (desc.iManufacturer > 0) {
+                    info.manufacturer = getUsbDeviceString(handle, desc.iManufacturer);
+                }
+                
+                if (desc.iProduct > 0) {
+                    info.product = getUsbDeviceString(handle, desc.iProduct);
+                }
+                
+                if (desc.iSerialNumber > 0) {
+                    info.serialNumber = getUsbDeviceString(handle, desc.iSerialNumber);
+                }
+                
+                // Close the device
+                fn_libusb_close(handle);
+            } else {
                 addUsbError("Sony camera found but cannot be opened: " +
                          std::string(getLibUsbErrorName(result)));
             }
         }
         
-        // Add to our list
-        mUsbDeviceInfoList.push_back(info);
+        inventory.emplace(key, info);
+        if (!known) {
+            changes.added.push_back(info);
+        }
     }
     
     // Free the list
     fn_libusb_free_device_list(deviceList, 1);
     
-    return mUsbDeviceInfoList.size();
+    // Whatever the previous scan saw and this one didn't is gone
+    for (const auto& entry : mUsbInventory) {
+        if (inventory.find(entry.first) == inventory.end()) {
+            changes.removed.push_back(entry.second);
+        }
+    }
+    mUsbInventory.swap(inventory);
+    
+    mUsbDeviceInfoList.clear();
+    mUsbDeviceInfoList.reserve(mUsbInventory.size());
+    for (const auto& entry : mUsbInventory) {
+        mUsbDeviceInfoList.push_back(entry.second);
+    }
+    
+    return changes;
+}
+
+uint64_t ofxSonyCameraRemote::usbDeviceKey(uint8_t busNumber, uint8_t deviceAddress, const libusb_device_descriptor& desc) {
+    // Bus and address first, so the inventory is ordered by location
+    return (uint64_t(busNumber) << 56) | (uint64_t(deviceAddress) << 48) |
+           (uint64_t(desc.idVendor) << 32) | (uint64_t(desc.idProduct) << 16) | desc.bcdDevice;
 }
 
 int ofxSonyCameraRemote::countSonyDevices() const {
@@ -778,21 +1567,9 @@ std::string ofxSonyCameraRemote::getUsbDeviceString(libusb_device_handle* handle
 }
 
 bool ofxSonyCameraRemote::isSonyCamera(uint16_t vendorId, uint16_t productId) const {
-    // Check vendor ID first
-    if (vendorId != SONY_VENDOR_ID) {
-        return false;
-    }
-    
-    // Check if product ID is in our list of known Sony camera IDs
-    for (auto knownId : SONY_PRODUCT_IDS) {
-        if (productId == knownId) {
-            return true;
-        }
-    }
-    
-    // For unknown Sony devices, look for camera-related strings in the product name
-    // which is already handled by checking for Sony's vendor ID
-    return true; // Any Sony device could potentially be a camera
+    // Sony publishes no list of its cameras' product IDs, and they differ
+    // per model and USB mode, so any Sony device may be a camera
+    return vendorId == SONY_VENDOR_ID;
 }
 
 bool ofxSonyCameraRemote::isAlpha7sIII(uint16_t vendorId, uint16_t productId, const std::string& productString) const {
@@ -823,7 +1600,7 @@ bool ofxSonyCameraRemote::isAlpha7sIII(uint16_t vendorId, uint16_t productId, co
 }
 
 void ofxSonyCameraRemote::addUsbError(const std::string& message) const {
-    ofLogError("ofxSonyCameraRemote") << message;
+    OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "{}", message);
     // Note: We need to cast away const here because we're modifying member data
     // from a const method. This is generally not ideal, but works for error collection.
     const_cast<ofxSonyCameraRemote*>(this)->mUsbErrorMessages.push_back(message);
@@ -856,59 +1633,366 @@ const char* ofxSonyCameraRemote::getLibUsbErrorName(int code) const {
 
 // Helper methods for specific properties
 bool ofxSonyCameraRemote::setIso(int isoValue) {
-    // Convert ISO value to SDK format and set the property
-    // This would need a proper mapping from ISO values to SDK enum values
-    // For now, we just use the value directly
-    CrInt64u sdkValue = isoValue;
-    return setProperty(CrDeviceProperty_IsoSensitivity, sdkValue);
+    return setNearestValue(CrDeviceProperty_IsoSensitivity, isoValue, "ISO");
 }
 
 bool ofxSonyCameraRemote::setShutterSpeed(double seconds) {
-    // Convert shutter speed to SDK format and set the property
-    // This would need a proper mapping from seconds to SDK enum values
-    // For now, we use a placeholder value
-    CrInt64u sdkValue = static_cast<CrInt64u>(1.0 / seconds);
-    return setProperty(CrDeviceProperty_ShutterSpeed, sdkValue);
+    return setNearestValue(CrDeviceProperty_ShutterSpeed, seconds, "shutter speed");
 }
 
 bool ofxSonyCameraRemote::setAperture(double fNumber) {
-    // Convert aperture to SDK format and set the property
-    // This would need a proper mapping from f-number to SDK enum values
-    // For now, we use a placeholder value
-    CrInt64u sdkValue = static_cast<CrInt64u>(fNumber * 100);
-    return setProperty(CrDeviceProperty_FNumber, sdkValue);
+    return setNearestValue(CrDeviceProperty_FNumber, fNumber, "aperture");
+}
+
+bool ofxSonyCameraRemote::setNearestValue(CrInt32u code, double quantity, const char* name) {
+    // Only ever send a value the camera listed as possible
+    CrInt64u sdkValue;
+    if (!getValueTable(code).nearest(quantity, sdkValue)) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot set {}: camera reported no possible values", name);
+        return false;
+    }
+    
+    OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraRemote", "Setting {} {} as 0x{:x}", name, quantity, sdkValue);
+    return setProperty(code, sdkValue);
+}
+
+ofxSonyCameraValueTable ofxSonyCameraRemote::getValueTable(CrInt32u code) const {
+    std::lock_guard<std::mutex> lock(mValueTablesMutex);
+    auto it = mValueTables.find(code);
+    return it == mValueTables.end() ? ofxSonyCameraValueTable() : it->second;
+}
+
+std::shared_ptr<const ofxSonyCameraPropertySnapshot> ofxSonyCameraRemote::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(mSnapshotMutex);
+    if (mSnapshotStale) {
+        auto snapshot = std::make_shared<ofxSonyCameraPropertySnapshot>(mLiveSnapshot);
+        snapshot->stamp();
+        mSnapshot = std::move(snapshot);
+        mSnapshotStale = false;
+    }
+    return mSnapshot;
+}
+
+void ofxSonyCameraRemote::setLibraryProbeEnabled(bool enabled) {
+    mProbeLibraries = enabled;
+}
+
+void ofxSonyCameraRemote::setBackend(std::shared_ptr<ofxSonyCameraBackend> backend) {
+    if (mSdkAcquired) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot change the backend after setup()");
+        return;
+    }
+    if (backend) {
+        mBackend = backend;
+    }
+}
+
+std::shared_ptr<ofxSonyCameraBackend> ofxSonyCameraRemote::getBackend() const {
+    return mBackend;
+}
+
+ofxSonyCameraRemote::StartupTiming ofxSonyCameraRemote::getStartupTiming() const {
+    return mStartupTiming;
+}
+
+// Event dispatch
+size_t ofxSonyCameraRemote::pollEvents() {
+    size_t count = 0;
+    bool propertiesChanged = false;
+    ofxSonyCameraEvent event;
+    
+    while (mEvents.pop(event)) {
+        count++;
+        if (mEventCallback) {
+            mEventCallback(event);
+        }
+        
+        switch (event.type) {
+            case ofxSonyCameraEvent::EVENT_CONNECTED:
+                if (mHotplugArrivalMicros != 0) {
+                    mHotplugStats.lastConnectLatencyMicros = steadyMicros() - mHotplugArrivalMicros;
+                    mHotplugStats.maxConnectLatencyMicros = std::max(mHotplugStats.maxConnectLatencyMicros, mHotplugStats.lastConnectLatencyMicros);
+                    mHotplugArrivalMicros = 0;
+                }
+                if (mConnectCallback) mConnectCallback();
+                break;
+            case ofxSonyCameraEvent::EVENT_DISCONNECTED:
+                if (mDisconnectCallback) mDisconnectCallback(event.value);
+                break;
+            case ofxSonyCameraEvent::EVENT_PROPERTY_CHANGED:
+                mSubscriptions.markChanged(event.numCodes, event.codes);
+                propertiesChanged = true;
+                break;
+            case ofxSonyCameraEvent::EVENT_DOWNLOAD_COMPLETE:
+                if (mDownloadCallback) mDownloadCallback(event.filename, event.value);
+                break;
+            case ofxSonyCameraEvent::EVENT_WARNING:
+                if (mWarningCallback) mWarningCallback(event.value);
+                break;
+            case ofxSonyCameraEvent::EVENT_ERROR:
+                if (mErrorCallback) mErrorCallback(event.value);
+                break;
+            case ofxSonyCameraEvent::EVENT_DEVICE_ARRIVED:
+                mHotplugStats.arrivals++;
+                mHotplugEnumeratePending = true;
+                break;
+            case ofxSonyCameraEvent::EVENT_DEVICE_LEFT:
+                mHotplugStats.departures++;
+                mHotplugEnumeratePending = true;
+                break;
+            case ofxSonyCameraEvent::EVENT_STATE_CHANGED:
+                if (mConnectionStateCallback) mConnectionStateCallback(ConnectionState(event.value));
+                break;
+            default:
+                break;
+        }
+    }
+    
+    // Property changes lost to a full queue: report every property as changed
+    if (mEvents.takePropertyOverflow()) {
+        event.type = ofxSonyCameraEvent::EVENT_PROPERTY_CHANGED;
+        event.value = 0;
+        event.numCodes = 0;
+        count++;
+        if (mEventCallback) {
+            mEventCallback(event);
+        }
+        mSubscriptions.markChanged(0, nullptr);
+        propertiesChanged = true;
+    }
+    
+    // Deliver the batch of property changes once, at the end of the frame's events
+    if (propertiesChanged) {
+        mSubscriptions.dispatch(mPropertyCache);
+        if (mPropertyChangeCallback) {
+            mPropertyChangeCallback();
+        }
+    }
+    
+    updateHotplug();
+    
+    return count;
+}
+
+uint64_t ofxSonyCameraRemote::getNumDroppedEvents() const {
+    return mEvents.getNumDropped();
+}
+
+// USB hotplug
+bool ofxSonyCameraRemote::startHotplug() {
+    if (mHotplugRunning) {
+        return true;
+    }
+    if (!loadLibUsbFunctions()) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot watch USB hotplug: libusb not available");
+        return false;
+    }
+    if (!fn_libusb_has_capability || !fn_libusb_hotplug_register_callback ||
+        !fn_libusb_hotplug_deregister_callback || !fn_libusb_handle_events_timeout_completed ||
+        !fn_libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Cannot watch USB hotplug: not supported by this libusb");
+        return false;
+    }
+    
+    // Only Sony devices; with ENUMERATE, those already plugged in arrive right away
+    int result = fn_libusb_hotplug_register_callback(
+        mUsbContext,
+        LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+        LIBUSB_HOTPLUG_ENUMERATE,
+        SONY_VENDOR_ID,
+        LIBUSB_HOTPLUG_MATCH_ANY,
+        LIBUSB_HOTPLUG_MATCH_ANY,
+        &ofxSonyCameraRemote::onHotplugEvent,
+        this,
+        &mHotplugHandle
+    );
+    if (result != LIBUSB_SUCCESS) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRemote", "Failed to register USB hotplug callback: {}", getLibUsbErrorName(result));
+        return false;
+    }
+    
+    // libusb only delivers hotplug events while someone handles its events
+    mHotplugRunning = true;
+    mHotplugThread = std::thread([this]() {
+        while (mHotplugRunning) {
+            struct timeval timeout = { 0, 100000 };
+            fn_libusb_handle_events_timeout_completed(mUsbContext, &timeout, nullptr);
+        }
+    });
+    
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRemote", "Watching USB for Sony devices");
+    return true;
+}
+
+void ofxSonyCameraRemote::stopHotplug() {
+    if (!mHotplugRunning) {
+        return;
+    }
+    
+    // Deregistering wakes the event thread, which then sees the flag
+    mHotplugRunning = false;
+    fn_libusb_hotplug_deregister_callback(mUsbContext, mHotplugHandle);
+    if (mHotplugThread.joinable()) {
+        mHotplugThread.join();
+    }
+    mHotplugFirstEventMicros = 0;
+    mHotplugLastEventMicros = 0;
+    mHotplugEnumeratePending = false;
+}
+
+bool ofxSonyCameraRemote::isHotplugActive() const {
+    return mHotplugRunning;
+}
+
+void ofxSonyCameraRemote::registerDevicesChangedCallback(std::function<void(int)> callback) {
+    mDevicesChangedCallback = callback;
+}
+
+ofxSonyCameraRemote::HotplugStats ofxSonyCameraRemote::getHotplugStats() const {
+    return mHotplugStats;
+}
+
+int ofxSonyCameraRemote::onHotplugEvent(libusb_context* context, libusb_device* device, int event, void* userData) {
+    // Called on the hotplug thread, or on the caller of startHotplug() for
+    // devices already present; only record the event here
+    ofxSonyCameraRemote* remote = static_cast<ofxSonyCameraRemote*>(userData);
+    int64_t now = steadyMicros();
+    int64_t none = 0;
+    remote->mHotplugFirstEventMicros.compare_exchange_strong(none, now);
+    remote->mHotplugLastEventMicros = now;
+    
+    ofxSonyCameraEvent hotplugEvent;
+    hotplugEvent.type = event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED ?
+        ofxSonyCameraEvent::EVENT_DEVICE_ARRIVED : ofxSonyCameraEvent::EVENT_DEVICE_LEFT;
+    hotplugEvent.value = 0;
+    hotplugEvent.numCodes = 0;
+    hotplugEvent.filename[0] = '\0';
+    
+    libusb_device_descriptor desc;
+    if (remote->fn_libusb_get_device_descriptor(device, &desc) == LIBUSB_SUCCESS) {
+        hotplugEvent.value = (CrInt32u(desc.idVendor) << 16) | desc.idProduct;
+    }
+    remote->mEvents.push(hotplugEvent);
+    
+    // Keep the callback registered
+    return 0;
+}
+
+void ofxSonyCameraRemote::updateHotplug() {
+    // A connected camera has no use for a new list, so hold the events until it disconnects
+    if (!mHotplugEnumeratePending || mConnected) {
+        return;
+    }
+    
+    // Cameras come and go as several USB events; enumerate once they settle
+    int64_t now = steadyMicros();
+    if (now - mHotplugLastEventMicros.load() < kHotplugSettleMillis * 1000) {
+        return;
+    }
+    
+    int64_t firstEvent = mHotplugFirstEventMicros.exchange(0);
+    mHotplugEnumeratePending = false;
+    
+    enumerateDevices();
+    mHotplugStats.enumerations++;
+    if (firstEvent != 0) {
+        mHotplugStats.lastEnumerateLatencyMicros = steadyMicros() - firstEvent;
+    }
+    
+    // Time the next connection from the arrival that made the camera visible
+    mHotplugArrivalMicros = getDeviceCount() > 0 ? firstEvent : 0;
+    
+    if (mDevicesChangedCallback) {
+        mDevicesChangedCallback(getDeviceCount());
+    }
 }
 
 // Callback registration
 void ofxSonyCameraRemote::registerConnectCallback(std::function<void()> callback) {
-    if (mCallback) {
-        mCallback->setConnectCallback(callback);
-    }
+    mConnectCallback = callback;
 }
 
 void ofxSonyCameraRemote::registerDisconnectCallback(std::function<void(CrInt32u)> callback) {
-    if (mCallback) {
-        mCallback->setDisconnectCallback(callback);
-    }
+    mDisconnectCallback = callback;
+}
+
+void ofxSonyCameraRemote::registerConnectionStateCallback(std::function<void(ConnectionState)> callback) {
+    mConnectionStateCallback = callback;
 }
 
 void ofxSonyCameraRemote::registerErrorCallback(std::function<void(CrInt32u)> callback) {
-    if (mCallback) {
-        mCallback->setErrorCallback(callback);
-    }
+    mErrorCallback = callback;
+}
+
+void ofxSonyCameraRemote::registerWarningCallback(std::function<void(CrInt32u)> callback) {
+    mWarningCallback = callback;
+}
+
+void ofxSonyCameraRemote::registerDownloadCallback(std::function<void(const std::string&, CrInt32u)> callback) {
+    mDownloadCallback = callback;
+}
+
+void ofxSonyCameraRemote::registerPropertyChangeCallback(std::function<void()> callback) {
+    mPropertyChangeCallback = callback;
+}
+
+size_t ofxSonyCameraRemote::subscribe(CrInt32u code, std::function<void(CrInt32u, CrInt64u)> handler) {
+    return mSubscriptions.subscribe(code, handler);
+}
+
+void ofxSonyCameraRemote::unsubscribe(size_t id) {
+    mSubscriptions.unsubscribe(id);
+}
+
+void ofxSonyCameraRemote::registerEventCallback(std::function<void(const ofxSonyCameraEvent&)> callback) {
+    mEventCallback = callback;
+}
+
+int ofxSonyCameraRemote::getNumPendingDownloads() const {
+    return mPendingDownloads.load();
 }
 
 int ofxSonyCameraRemote::getDeviceCount() const {
+    std::lock_guard<std::mutex> lock(mDeviceInfoMutex);
     return mDeviceInfoList.size();
 }
 
 std::string ofxSonyCameraRemote::getDeviceModel(int deviceIndex) const {
+    std::lock_guard<std::mutex> lock(mDeviceInfoMutex);
     if (deviceIndex < 0 || deviceIndex >= mDeviceInfoList.size()) {
         return "Unknown";
     }
-    return mDeviceInfoList[deviceIndex]->GetModel();
+    return mDeviceInfoList[deviceIndex].model;
+}
+
+std::string ofxSonyCameraRemote::getModel() const {
+    return mModel;
+}
+
+std::string ofxSonyCameraRemote::getSerialNumber() const {
+    return mSerialNumber;
 }
 
 CrInt32u ofxSonyCameraRemote::getSDKVersion() const {
-    return SCRSDK::GetSDKVersion();
+    return mBackend->getSdkVersion();
+}
+
+const ofxSonyCameraPropertyCache& ofxSonyCameraRemote::getPropertyCache() const {
+    return mPropertyCache;
+}
+
+void ofxSonyCameraRemote::setWriteQueueSettings(const ofxSonyCameraWriteQueue::Settings& settings) {
+    mWriteQueue.setSettings(settings);
+}
+
+ofxSonyCameraWriteQueue::Stats ofxSonyCameraRemote::getWriteQueueStats() const {
+    return mWriteQueue.getStats();
+}
+
+ofxSonyCameraMetrics& ofxSonyCameraRemote::getMetrics() {
+    return mMetrics;
+}
+
+ofxSonyCameraShotTracer& ofxSonyCameraRemote::getShotTracer() {
+    return mShotTracer;
 }
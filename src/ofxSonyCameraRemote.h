@@ -3,6 +3,18 @@
 #include "ofMain.h"
 #include "../libs/CRSDK/include/CameraRemote_SDK.h"
 #include "ofxSonyCameraCallback.h"
+#include "ofxSonyCameraPropertyCache.h"
+#include "ofxSonyCameraPropertySubscriptions.h"
+#include "ofxSonyCameraPropertyTraits.h"
+#include "ofxSonyCameraPropertySnapshot.h"
+#include "ofxSonyCameraValueTable.h"
+#include "ofxSonyCameraWriteQueue.h"
+#include "ofxSonyCameraCommandExecutor.h"
+#include "ofxSonyCameraLiveView.h"
+#include "ofxSonyCameraMetrics.h"
+#include "ofxSonyCameraBackend.h"
+#include "ofxSonyCameraErrorTable.h"
+#include "ofxSonyCameraShotTracer.h"
 
 // Note: CrInt32u, CrInt64u types are defined in the global namespace in CrTypes.h
 // Only types specifically defined in the SCRSDK namespace need to be qualified
@@ -16,8 +28,15 @@ using SCRSDK::CrDataType_UInt64;
 using SCRSDK::CrError_None;
 using SCRSDK::CrCommandId_Release;
 using SCRSDK::CrCommandParam_Down;
+using SCRSDK::CrCommandParam_Up;
 #include <vector>
 #include <memory>
+#include <utility>
+#include <future>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
 
 // Only include typedefs and constants we need from libusb
 // These match the libusb-1.0 API but don't require the header
@@ -57,6 +76,14 @@ typedef struct libusb_device_descriptor {
 #define LIBUSB_ERROR_NOT_SUPPORTED -12
 #define LIBUSB_ERROR_OTHER -99
 
+// Hotplug constants, from libusb 1.0.16
+typedef int libusb_hotplug_callback_handle;
+#define LIBUSB_CAP_HAS_HOTPLUG 0x0001
+#define LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED 0x01
+#define LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT 0x02
+#define LIBUSB_HOTPLUG_ENUMERATE 0x01
+#define LIBUSB_HOTPLUG_MATCH_ANY -1
+
 /**
  * @brief Main class for interacting with Sony cameras via the Camera Remote SDK
  * 
@@ -65,6 +92,122 @@ typedef struct libusb_device_descriptor {
  */
 class ofxSonyCameraRemote {
 public:
+    enum ConnectionState {
+        STATE_DISCONNECTED,
+        STATE_CONNECTING,
+        STATE_CONNECTED,
+        STATE_RECONNECTING, // connection lost, retrying with backoff
+        STATE_FAILED        // connecting failed, or reconnecting gave up
+    };
+    
+    /**
+     * @brief How to recover when the camera drops the connection
+     */
+    struct ReconnectSettings {
+        bool enabled = true;
+        uint64_t initialDelayMs = 500; // before the first attempt, doubled after each failure
+        uint64_t maxDelayMs = 10000;
+        int maxAttempts = 0;           // 0 retries until disconnect() is called
+        bool stopOnPermanentError = true; // give up on errors retrying can't fix, e.g. a rejected connection
+    };
+    
+    /**
+     * @brief One lost connection and how it ended
+     */
+    struct ReconnectIncident {
+        CrInt32u error = 0;        // reason reported by OnDisconnected
+        int attempts = 0;
+        bool recovered = false;
+        uint64_t recoverMicros = 0; // from the disconnect until reconnected or given up
+    };
+    
+    /**
+     * @brief The most recent failed SDK call
+     * 
+     * Described by ofxSonyCameraError, so applications can branch on the
+     * category or retryability instead of parsing log messages.
+     */
+    struct ErrorReport {
+        CrInt32u code = 0;            // the CrError returned
+        ofxSonyCameraError::Category category = ofxSonyCameraError::CATEGORY_NONE;
+        bool retryable = false;
+        const char* name = "CrError_None";
+        const char* action = "";      // what the user can do about it, may be empty
+        const char* operation = "";   // what failed, e.g. "connect"
+    };
+    
+    /**
+     * @brief How the shutter was pressed for a capture
+     */
+    enum ShutterMode {
+        SHUTTER_SINGLE,      // one press: the camera focuses before it fires
+        SHUTTER_PREFOCUSED,  // pressed while holdFocus() keeps focus and exposure locked
+        SHUTTER_CONTINUOUS,  // held down by captureContinuous()
+        SHUTTER_MODE_COUNT
+    };
+    
+    /**
+     * @brief Where the shutter button is
+     */
+    enum ShutterState {
+        SHUTTER_IDLE,
+        SHUTTER_HALF_PRESSED, // S1 held by holdFocus()
+        SHUTTER_PRESSED       // released, until it comes up again
+    };
+    
+    /**
+     * @brief How long the shutter button is held
+     */
+    struct ShutterSettings {
+        uint64_t releaseHoldMs = 35; // from Down to Up for a single shot
+    };
+    
+    /**
+     * @brief Time spent in each startup step
+     */
+    struct StartupTiming {
+        uint64_t probeMicros = 0;     // setup(): library probe, if enabled
+        uint64_t sdkInitMicros = 0;   // setup(): SDK initialization
+        uint64_t enumerateMicros = 0; // enumerateDevices(): SCRSDK::EnumCameraObjects
+    };
+    
+    /**
+     * @brief USB hotplug counters and latencies
+     */
+    struct HotplugStats {
+        uint64_t arrivals = 0;
+        uint64_t departures = 0;
+        uint64_t enumerations = 0;             // SDK enumerations triggered by hotplug events
+        uint64_t lastEnumerateLatencyMicros = 0; // first event to enumeration done
+        uint64_t lastConnectLatencyMicros = 0;   // arrival to connected
+        uint64_t maxConnectLatencyMicros = 0;
+    };
+    
+    /**
+     * @brief A USB device as seen by the USB scan
+     */
+    struct UsbDeviceInfo {
+        uint16_t vendorId;
+        uint16_t productId;
+        uint16_t deviceVersion;
+        uint8_t busNumber;
+        uint8_t deviceAddress;
+        std::string manufacturer;
+        std::string product;
+        std::string serialNumber;
+        bool isSonyCamera;  // has Sony's vendor ID; may be another Sony device
+        bool isOpened;      // only possible cameras are opened to read their strings
+        bool isAccessible;
+    };
+    
+    /**
+     * @brief Devices that appeared or disappeared since the previous scan
+     */
+    struct UsbScanResult {
+        std::vector<UsbDeviceInfo> added;
+        std::vector<UsbDeviceInfo> removed;
+    };
+    
     ofxSonyCameraRemote();
     ~ofxSonyCameraRemote();
     
@@ -77,6 +220,34 @@ public:
      */
     bool setup();
     
+    /**
+     * @brief Check that the SDK's libraries load before initializing it
+     * 
+     * Off by default. When enabled, setup() resolves every library against
+     * ofxSonyCameraSdk::setLibrarySearchPaths() and logs the ones it cannot
+     * find; results are cached for the process.
+     * 
+     * @param enabled Whether setup() probes the libraries
+     */
+    void setLibraryProbeEnabled(bool enabled);
+    
+    /**
+     * @brief Replace the backend the SDK calls go through
+     * 
+     * Must be called before setup(). Defaults to ofxSonyCameraSdkBackend;
+     * pass an ofxSonyCameraSimulatedBackend to run without a camera.
+     * 
+     * @param backend The backend, possibly shared with other camera objects
+     */
+    void setBackend(std::shared_ptr<ofxSonyCameraBackend> backend);
+    
+    std::shared_ptr<ofxSonyCameraBackend> getBackend() const;
+    
+    /**
+     * @brief Get the time spent in setup() and the last enumerateDevices()
+     */
+    StartupTiming getStartupTiming() const;
+    
     /**
      * @brief Clean up SDK resources
      * 
@@ -99,6 +270,50 @@ public:
      */
     bool connect(int deviceIndex = 0);
     
+    /**
+     * @brief Connect to a camera without blocking the calling thread
+     * 
+     * @param deviceIndex The index of the camera in the enumerated devices list
+     * @return A future holding the SDK result of the connection
+     */
+    std::future<CrError> connectAsync(int deviceIndex = 0);
+    
+    /**
+     * @brief Connect to a camera without blocking the calling thread
+     * 
+     * @param deviceIndex The index of the camera in the enumerated devices list
+     * @param onComplete Called on the command thread with the SDK result
+     */
+    void connectAsync(int deviceIndex, std::function<void(CrError)> onComplete);
+    
+    /**
+     * @brief Connect to a camera enumerated elsewhere
+     * 
+     * Used by ofxSonyCameraRig, which enumerates once for all cameras. The
+     * camera must come from this camera's backend. An ICrCameraObjectInfo
+     * converts implicitly; its enumeration must stay valid while connected.
+     * 
+     * @param camera The camera from enumeration
+     * @return true if connection was successful, false otherwise
+     */
+    bool connect(const ofxSonyCameraBackend::CameraInfo& camera);
+    
+    /**
+     * @brief Connect to a camera enumerated elsewhere without blocking
+     * 
+     * @param camera The camera from enumeration
+     * @return A future holding the SDK result of the connection
+     */
+    std::future<CrError> connectAsync(const ofxSonyCameraBackend::CameraInfo& camera);
+    
+    /**
+     * @brief Connect to a camera enumerated elsewhere without blocking
+     * 
+     * @param camera The camera from enumeration
+     * @param onComplete Called on the command thread with the SDK result
+     */
+    void connectAsync(const ofxSonyCameraBackend::CameraInfo& camera, std::function<void(CrError)> onComplete);
+    
     /**
      * @brief Disconnect from the camera
      * 
@@ -106,6 +321,20 @@ public:
      */
     bool disconnect();
     
+    /**
+     * @brief Disconnect from the camera without blocking the calling thread
+     * 
+     * @return A future holding the SDK result of the disconnection
+     */
+    std::future<CrError> disconnectAsync();
+    
+    /**
+     * @brief Disconnect from the camera without blocking the calling thread
+     * 
+     * @param onComplete Called on the command thread with the SDK result
+     */
+    void disconnectAsync(std::function<void(CrError)> onComplete);
+    
     /**
      * @brief Check if connected to a camera
      * 
@@ -113,16 +342,159 @@ public:
      */
     bool isConnected() const;
     
+    /**
+     * @brief Get the state of the connection
+     * 
+     * Changes are also reported through registerConnectionStateCallback().
+     */
+    ConnectionState getConnectionState() const;
+    
+    /**
+     * @brief Configure automatic reconnection
+     * 
+     * When the camera drops the connection, the camera is found again by
+     * serial number and reconnected, waiting longer after each failed
+     * attempt. Property values set through setProperty() or
+     * setProperties() since connect() are then sent again.
+     * 
+     * @param settings Whether to reconnect, the backoff and the attempt limit
+     */
+    void setReconnectSettings(const ReconnectSettings& settings);
+    ReconnectSettings getReconnectSettings() const;
+    
+    /**
+     * @brief Get the most recent lost connections, oldest first
+     */
+    std::vector<ReconnectIncident> getReconnectIncidents() const;
+    
+    static constexpr size_t kMaxReconnectIncidents = 32;
+    
+    /**
+     * @brief Get the most recent failed SDK call
+     * 
+     * Kept until the next failure; a call that succeeds doesn't clear it.
+     * The code is CrError_None if nothing has failed yet.
+     */
+    ErrorReport getLastError() const;
+    
     /**
      * @brief Capture a photo with the current settings
      * 
+     * Presses the shutter; the command thread lets it up again
+     * ShutterSettings::releaseHoldMs later. Without holdFocus() the camera
+     * focuses first.
+     * 
      * @return true if the capture command was sent successfully, false otherwise
      */
     bool capturePhoto();
     
+    /**
+     * @brief Capture a photo without blocking the calling thread
+     * 
+     * @return A future holding the SDK result of the capture command
+     */
+    std::future<CrError> capturePhotoAsync();
+    
+    /**
+     * @brief Capture a photo without blocking the calling thread
+     * 
+     * @param onComplete Called on the command thread with the SDK result
+     */
+    void capturePhotoAsync(std::function<void(CrError)> onComplete);
+    
+    /**
+     * @brief Send the shutter release on the calling thread
+     * 
+     * Bypasses the command thread, for callers that control the timing of the
+     * release themselves such as ofxSonyCameraSyncTrigger. Only sends Down;
+     * the command thread lets the shutter up ShutterSettings::releaseHoldMs
+     * later. Shutter commands are the only SDK calls made off the command
+     * thread, and are serialized among themselves: a press waits, at most,
+     * for an Up being sent. A press that comes while the
+     * shutter is still down keeps it down rather than letting it up in
+     * between, so the camera may take one picture for both. Call holdFocus()
+     * ahead of time for the release to fire without waiting for autofocus.
+     * 
+     * @return The SDK result of the capture command
+     */
+    CrError releaseShutter();
+    
+    /**
+     * @brief Hold the shutter down for a burst
+     * 
+     * The camera shoots for as long as the shutter is held when its drive
+     * mode is continuous, and takes a single picture otherwise. Returns once
+     * the shutter is down; the command thread lets it up holdMs later and
+     * keeps running other commands meanwhile. The burst is traced as one
+     * capture.
+     * 
+     * @param holdMs How long to hold the shutter down
+     * @return true if the shutter was pressed, false otherwise
+     */
+    bool captureContinuous(uint64_t holdMs);
+    std::future<CrError> captureContinuousAsync(uint64_t holdMs);
+    
+    /**
+     * @brief Press the shutter halfway and keep it there
+     * 
+     * Locks autofocus and exposure as the camera's half-press does, so
+     * captures until releaseFocus() fire without waiting for them. Give
+     * the camera time to focus before the first capture.
+     * 
+     * @return true if the half-press was sent, false otherwise
+     */
+    bool holdFocus();
+    
+    /**
+     * @brief Let go of the half-press held by holdFocus()
+     * 
+     * @return true if the release was sent, false otherwise
+     */
+    bool releaseFocus();
+    
+    ShutterState getShutterState() const;
+    
+    void setShutterSettings(const ShutterSettings& settings);
+    ShutterSettings getShutterSettings() const;
+    
+    /**
+     * @brief Get the measured shutter lag of recent captures in one mode
+     * 
+     * From the moment the shutter was pressed to the camera's first
+     * notification about the capture; see
+     * ofxSonyCameraShotTracer::getShutterLagStats().
+     */
+    ofxSonyCameraShotTracer::StageStats getShutterLag(ShutterMode mode) const;
+    
+    /**
+     * @brief Start streaming live view frames from the camera
+     * 
+     * Frames are pulled on a background thread; call getLiveView().update()
+     * once per frame to pick up the newest one.
+     * 
+     * @return true if streaming started, false otherwise
+     */
+    bool startLiveView();
+    
+    /**
+     * @brief Stop streaming live view frames
+     */
+    void stopLiveView();
+    
+    /**
+     * @brief Get the live view engine
+     * 
+     * @return The live view engine of this camera
+     */
+    ofxSonyCameraLiveView& getLiveView();
+    
     /**
      * @brief Get a camera property value
      * 
+     * Values are served from the property cache, which is filled on connect
+     * and kept up to date from the camera's change notifications. Only codes
+     * missing from the cache cost a round trip to the camera.
+     * 
      * @param code The property code (from SCRSDK::CrDeviceProperty enum)
      * @param value Reference to store the property value
      * @return true if the property was retrieved successfully, false otherwise
@@ -132,15 +504,117 @@ public:
     /**
      * @brief Set a camera property value
      * 
+     * Writes go through a coalescing queue: while an earlier write of the
+     * same property is waiting for the camera to confirm it, the new value
+     * is held back and replaces any older value that has not been sent yet.
+     * 
      * @param code The property code (from SCRSDK::CrDeviceProperty enum)
      * @param value The value to set
-     * @return true if the property was set successfully, false otherwise
+     * @return true if the value was sent or queued, false if sending failed
      */
     bool setProperty(CrInt32u code, CrInt64u value);
     
+    /**
+     * @brief Get a property in human units
+     * 
+     * The property tag selects the encoding at compile time, e.g.
+     * get<ofxSonyCameraProperty::FNumber>(fNumber) yields 2.8 for f/2.8.
+     * 
+     * @param value Reference to store the decoded value
+     * @return true if successful, false otherwise
+     */
+    template<typename Property>
+    bool get(typename Property::value_type& value) {
+        CrInt64u encoded;
+        if (!getProperty(Property::code, encoded)) {
+            return false;
+        }
+        value = Property::decode(encoded);
+        return true;
+    }
+    
+    /**
+     * @brief Set a property from human units
+     * 
+     * The value is encoded as is; unlike setAperture() and friends it is not
+     * snapped to a value the camera accepts. Fails to compile for read-only
+     * properties.
+     * 
+     * @param value The value to set
+     * @return true if successful, false otherwise
+     */
+    template<typename Property>
+    bool set(typename Property::value_type value) {
+        static_assert(!Property::readOnly, "Cannot set a read-only camera property");
+        return setProperty(Property::code, Property::encode(value));
+    }
+    
+    /**
+     * @brief Set a camera property value without blocking the calling thread
+     * 
+     * @param code The property code (from SCRSDK::CrDeviceProperty enum)
+     * @param value The value to set
+     * @return A future holding the SDK result of the write
+     */
+    std::future<CrError> setPropertyAsync(CrInt32u code, CrInt64u value);
+    
+    /**
+     * @brief Set a camera property value without blocking the calling thread
+     * 
+     * @param code The property code (from SCRSDK::CrDeviceProperty enum)
+     * @param value The value to set
+     * @param onComplete Called on the command thread with the SDK result
+     */
+    void setPropertyAsync(CrInt32u code, CrInt64u value, std::function<void(CrError)> onComplete);
+    
+    /**
+     * @brief Get several camera property values at once
+     * 
+     * Cached values are served from memory and all remaining codes are read
+     * with a single request to the camera.
+     * 
+     * @param codes The property codes (from SCRSDK::CrDeviceProperty enum)
+     * @param values Receives one value per code, in the same order
+     * @return true if every property was retrieved, false otherwise
+     */
+    bool getProperties(const std::vector<CrInt32u>& codes, std::vector<CrInt64u>& values);
+    
+    /**
+     * @brief Set several camera property values at once
+     * 
+     * Writes go through the same queue as setProperty() and are sent back to
+     * back without reading anything back in between; values the camera
+     * already holds are skipped. A value whose code still has an earlier
+     * write waiting for the camera's confirmation is held back and sent once
+     * that one is confirmed. Returns once the writes are sent or queued,
+     * without waiting for the camera to apply them; see
+     * setPropertiesAndWait().
+     * 
+     * @param values Pairs of property code and value to set
+     * @return true if every value was sent or queued, false if sending one failed
+     */
+    bool setProperties(const std::vector<std::pair<CrInt32u, CrInt64u>>& values);
+    
+    /**
+     * @brief Set several camera property values and wait until the camera reports them
+     * 
+     * Like setProperties(), then waits until the property cache holds every
+     * value and none of the codes has a write left in the queue. Not from
+     * the command thread, e.g. in an onComplete callback.
+     * 
+     * @param values Pairs of property code and value to set
+     * @param timeout How long to wait for the camera
+     * @return true if the camera holds every value, false if sending failed
+     *         or it didn't report them all in time
+     */
+    bool setPropertiesAndWait(const std::vector<std::pair<CrInt32u, CrInt64u>>& values,
+                              std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    
     /**
      * @brief Set ISO sensitivity
      * 
+     * Picks the closest ISO the camera currently accepts.
+     * 
      * @param isoValue The ISO value to set
      * @return true if successful, false otherwise
      */
@@ -149,6 +623,8 @@ public:
     /**
      * @brief Set shutter speed
      * 
+     * Picks the closest shutter speed the camera currently accepts.
+     * 
      * @param seconds The shutter speed in seconds
      * @return true if successful, false otherwise
      */
@@ -157,14 +633,59 @@ public:
     /**
      * @brief Set aperture (f-number)
      * 
+     * Picks the closest aperture the camera currently accepts.
+     * 
      * @param fNumber The aperture value (f-number)
      * @return true if successful, false otherwise
      */
     bool setAperture(double fNumber);
     
+    /**
+     * @brief Get the values the camera accepts for a property
+     * 
+     * Built from the possible values reported when the camera connects and
+     * rebuilt whenever the property changes, so stepping through values in a
+     * UI doesn't need a round trip to the camera.
+     * 
+     * @param code The property code
+     * @return The table, empty if the camera reported no possible values
+     */
+    ofxSonyCameraValueTable getValueTable(CrInt32u code) const;
+    
+    /**
+     * @brief Get an immutable copy of every property as last read from the camera
+     * 
+     * Once properties have been loaded or refreshed since the last call, a
+     * new snapshot with a higher generation is copied from the values the
+     * addon keeps; snapshots already handed out never change, so keep one
+     * and diff it against a later one to see what the camera changed in
+     * between.
+     * 
+     * @return The current snapshot, or nullptr before the first load
+     */
+    std::shared_ptr<const ofxSonyCameraPropertySnapshot> getSnapshot() const;
+    
+    /**
+     * @brief Dispatch queued camera events to the registered callbacks
+     * 
+     * The SDK reports events on its own thread; they are queued there and
+     * handled here, in the order they happened, on the thread that calls this.
+     * Call it once per frame from ofApp::update().
+     * 
+     * @return The number of events handled
+     */
+    size_t pollEvents();
+    
+    /**
+     * @brief Get the number of events dropped because pollEvents() wasn't called often enough
+     */
+    uint64_t getNumDroppedEvents() const;
+    
     /**
      * @brief Register a callback for camera connection events
      * 
+     * Called from pollEvents().
+     * 
      * @param callback The function to call when the camera connects
      */
     void registerConnectCallback(std::function<void()> callback);
@@ -172,17 +693,98 @@ public:
     /**
      * @brief Register a callback for camera disconnection events
      * 
+     * Called from pollEvents().
+     * 
      * @param callback The function to call when the camera disconnects
      */
     void registerDisconnectCallback(std::function<void(CrInt32u)> callback);
     
+    /**
+     * @brief Register a callback for connection state changes
+     * 
+     * Called from pollEvents().
+     * 
+     * @param callback The function to call with the new state
+     */
+    void registerConnectionStateCallback(std::function<void(ConnectionState)> callback);
+    
     /**
      * @brief Register a callback for camera error events
      * 
+     * Called from pollEvents().
+     * 
      * @param callback The function to call when a camera error occurs
      */
     void registerErrorCallback(std::function<void(CrInt32u)> callback);
     
+    /**
+     * @brief Register a callback for camera warning events
+     * 
+     * Called from pollEvents().
+     * 
+     * @param callback The function to call when the camera reports a warning
+     */
+    void registerWarningCallback(std::function<void(CrInt32u)> callback);
+    
+    /**
+     * @brief Register a callback for completed file downloads
+     * 
+     * Called from pollEvents(). Only fires when the camera saves captures to
+     * the host.
+     * 
+     * @param callback The function to call with the file name and type
+     */
+    void registerDownloadCallback(std::function<void(const std::string&, CrInt32u)> callback);
+    
+    /**
+     * @brief Register a callback for property changes
+     * 
+     * Called from pollEvents(), at most once per call, after the property
+     * cache holds the new values.
+     * 
+     * @param callback The function to call when any property changed
+     */
+    void registerPropertyChangeCallback(std::function<void()> callback);
+    
+    /**
+     * @brief Call a handler when a specific property changes
+     * 
+     * Changes are batched and delivered from pollEvents(): a handler runs at
+     * most once per call, and only for its own property.
+     * 
+     * @param code The property code (CrDeviceProperty_*)
+     * @param handler Called with the code and its new value
+     * @return An id for unsubscribe()
+     */
+    size_t subscribe(CrInt32u code, std::function<void(CrInt32u, CrInt64u)> handler);
+    
+    /**
+     * @brief Remove a property change handler
+     * 
+     * @param id The id returned by subscribe()
+     */
+    void unsubscribe(size_t id);
+    
+    /**
+     * @brief Register a callback receiving every event
+     * 
+     * Called from pollEvents() before the specific callbacks.
+     * 
+     * @param callback The function to call with each event
+     */
+    void registerEventCallback(std::function<void(const ofxSonyCameraEvent&)> callback);
+    
+    /**
+     * @brief Get the number of captures whose download hasn't completed
+     * 
+     * Counts successful shutter releases not yet matched by a completed
+     * download. Releases are only counted while the camera saves to the host,
+     * so this stays at zero when it saves to its memory card only.
+     * 
+     * @return The number of pending downloads
+     */
+    int getNumPendingDownloads() const;
+    
     /**
      * @brief Get the number of enumerated devices
      * 
@@ -198,6 +800,20 @@ public:
      */
     std::string getDeviceModel(int deviceIndex = 0) const;
     
+    /**
+     * @brief Get the model name of the connected camera
+     * 
+     * @return The model name, empty if never connected
+     */
+    std::string getModel() const;
+    
+    /**
+     * @brief Get the serial number of the connected camera
+     * 
+     * @return The serial number, empty if never connected
+     */
+    std::string getSerialNumber() const;
+    
     /**
      * @brief Get the Camera Remote SDK version
      *
@@ -229,36 +845,240 @@ public:
      */
     std::vector<std::string> getUsbErrors() const;
     
+    /**
+     * @brief Update the USB inventory and report what changed
+     * 
+     * Only devices with Sony's vendor ID are opened to read their strings;
+     * product IDs aren't checked, since they differ per model. Results are
+     * cached per bus, address and descriptor, so a device that stays plugged
+     * in is never opened again, unless opening it failed: it is then tried
+     * again on every scan until it opens.
+     * 
+     * @return The devices added and removed since the previous scan
+     */
+    UsbScanResult scanUsbDevices();
+    
+    /**
+     * @brief Watch the USB bus for Sony devices arriving and leaving
+     * 
+     * Replaces polling enumerateDevices(): once the bus has been quiet for
+     * kHotplugSettleMillis after an event, pollEvents() enumerates cameras
+     * again and calls the devices-changed callback. Devices already plugged
+     * in count as arrivals. Events seen while connected are held until the
+     * camera disconnects.
+     * 
+     * @return false if libusb could not be loaded or has no hotplug support
+     */
+    bool startHotplug();
+    
+    /**
+     * @brief Stop watching the USB bus
+     */
+    void stopHotplug();
+    
+    bool isHotplugActive() const;
+    
+    /**
+     * @brief Register a callback for when hotplug changed the enumerated devices
+     * 
+     * @param callback Called from pollEvents() with the new device count
+     */
+    void registerDevicesChangedCallback(std::function<void(int)> callback);
+    
+    /**
+     * @brief Get hotplug counters, and the latency from an arrival to enumeration and connection
+     */
+    HotplugStats getHotplugStats() const;
+    
+    static constexpr int kHotplugSettleMillis = 300;
+    
+    /**
+     * @brief Get the property cache backing getProperty()
+     *
+     * Useful to query per-property versions and hit/miss statistics.
+     *
+     * @return The property cache of the connected camera
+     */
+    const ofxSonyCameraPropertyCache& getPropertyCache() const;
+    
+    /**
+     * @brief Configure the property write queue
+     *
+     * @param settings In-flight limit, confirmation timeout and drain policy
+     */
+    void setWriteQueueSettings(const ofxSonyCameraWriteQueue::Settings& settings);
+    
+    /**
+     * @brief Get the property write queue counters
+     *
+     * @return Counts of writes submitted, dropped, sent and confirmed
+     */
+    ofxSonyCameraWriteQueue::Stats getWriteQueueStats() const;
+    
+    /**
+     * @brief Get the latency histograms of this camera's SDK calls
+     * 
+     * Labelled with the camera's serial number once connected.
+     */
+    ofxSonyCameraMetrics& getMetrics();
+    
+    /**
+     * @brief Get the stage-by-stage latency of recent captures
+     * 
+     * Every capturePhoto() and releaseShutter() is traced from the request
+     * to its file being downloaded; see ofxSonyCameraShotTracer for the
+     * stages, their percentiles and the Chrome trace export.
+     */
+    ofxSonyCameraShotTracer& getShotTracer();
+    
 private:
     // SDK handles
-    ICrEnumCameraObjectInfo* mEnumCameraObjInfo;
-    std::vector<const ICrCameraObjectInfo*> mDeviceInfoList;
+    std::shared_ptr<ofxSonyCameraBackend> mBackend;
+    std::vector<ofxSonyCameraBackend::CameraInfo> mDeviceInfoList;
+    mutable std::mutex mDeviceInfoMutex; // enumerated from pollEvents() and from the command thread
+    ofxSonyCameraBackend::CameraInfo mCamera; // the camera last opened, kept for reconnecting
     CrDeviceHandle mDeviceHandle;
     
     // Callback handler
     std::unique_ptr<ofxSonyCameraCallback> mCallback;
     
     // Connection status
-    bool mConnected;
+    std::atomic<bool> mConnected;
+    bool mSdkAcquired;
+    
+    // Startup diagnostics
+    bool mProbeLibraries;
+    StartupTiming mStartupTiming;
+    
+    // Captures waiting for OnCompleteDownload
+    std::atomic<int> mPendingDownloads;
+    
+    // Events from the SDK thread, dispatched by pollEvents()
+    ofxSonyCameraEventQueue mEvents;
+    std::function<void()> mConnectCallback;
+    std::function<void(CrInt32u)> mDisconnectCallback;
+    std::function<void(CrInt32u)> mErrorCallback;
+    std::function<void(CrInt32u)> mWarningCallback;
+    std::function<void(const std::string&, CrInt32u)> mDownloadCallback;
+    std::function<void(const ofxSonyCameraEvent&)> mEventCallback;
+    std::function<void()> mPropertyChangeCallback;
+    std::function<void(int)> mDevicesChangedCallback;
+    std::function<void(ConnectionState)> mConnectionStateCallback;
+    
+    // Per-code property handlers, dispatched once per pollEvents()
+    ofxSonyCameraPropertySubscriptions mSubscriptions;
+    
+    // Identity of the connected camera
+    std::string mModel;
+    std::string mSerialNumber;
+    
+    // Runs connect, disconnect, capture and property writes off the caller's thread
+    ofxSonyCameraCommandExecutor mExecutor;
+    
+    // Timing of every SDK call made for this camera
+    ofxSonyCameraMetrics mMetrics;
+    
+    // Stages of each capture, from capturePhoto() to the downloaded file
+    ofxSonyCameraShotTracer mShotTracer;
+    
+    // Shutter button state. releaseShutter() presses on the caller's thread
+    // and the command thread lets up at a deadline; mShutterMutex is held
+    // from taking the shutter over until Down is sent, and from checking
+    // the press until Up is sent, so the two are never reordered
+    std::atomic<bool> mFocusHeld;
+    std::atomic<uint64_t> mPressCount;
+    std::atomic<uint64_t> mHeldPress; // the press holding the shutter down, 0 if up
+    std::mutex mShutterMutex;
+    uint64_t mLiftPress;              // the press to let up at mLiftDue, 0 if none; command thread only
+    std::chrono::steady_clock::time_point mLiftDue;
+    ShutterSettings mShutterSettings;
+    mutable std::mutex mShutterSettingsMutex;
+    
+    // Connection state machine; the state is written by the command thread
+    // and, when the camera drops the connection, by the SDK thread
+    std::atomic<ConnectionState> mState;
+    ReconnectSettings mReconnectSettings;
+    std::vector<ReconnectIncident> mReconnectIncidents;
+    mutable std::mutex mReconnectMutex;
+    
+    // Reconnection progress, only touched on the command thread
+    std::chrono::steady_clock::time_point mLostTime;
+    std::chrono::steady_clock::time_point mNextReconnectTime;
+    int mReconnectAttempts;
+    CrInt32u mLostError;
+    
+    // Lost connections whose handleConnectionLost() hasn't run yet
+    std::atomic<int> mLossesPending;
+    
+    // Most recent failed SDK call, from whichever thread made it
+    ErrorReport mLastError;
+    mutable std::mutex mErrorMutex;
+    
+    // Values set through setProperty() or setProperties() since connect(), sent again after reconnecting
+    std::map<CrInt32u, CrInt64u> mAppliedSettings;
+    
+    void setConnectionState(ConnectionState state);
+    void onConnectionLost(CrInt32u error);
+    CrError handleConnectionLost(CrInt32u error);
+    void releaseDevice();
+    void tryReconnect();
+    CrError reconnectBySerialNumber();
+    void finishReconnect(bool recovered);
+    const ofxSonyCameraError::Info& recordError(const char* operation, CrError err);
+    
+    // Command implementations, run on the command thread
+    CrError doConnect(int deviceIndex);
+    CrError doConnectCamera(const ofxSonyCameraBackend::CameraInfo& camera);
+    CrError openCamera(const ofxSonyCameraBackend::CameraInfo& camera);
+    CrError doDisconnect();
+    CrError doCapturePhoto(uint64_t shot);
+    CrError doCaptureContinuous(uint64_t shot, uint64_t holdMs);
+    CrError doHoldFocus(bool hold);
+    CrError pressShutter(uint64_t shot, bool continuous, uint64_t& press);
+    void scheduleLift(uint64_t press, std::chrono::steady_clock::time_point due);
+    void liftDueShutter();
+    CrError sendRelease(CrCommandParam param);
+    void resetShutter();
+    CrError doSetProperty(CrInt32u code, CrInt64u value);
+    
+    std::future<CrError> submitCommand(std::function<CrError()> command);
+    void submitCommand(std::function<CrError()> command, std::function<void(CrError)> onComplete);
+    
+    // Property values, filled by loadProperties() and refreshed on change
+    ofxSonyCameraPropertyCache mPropertyCache;
+    
+    // Pending property writes, drained as the camera confirms earlier ones
+    ofxSonyCameraWriteQueue mWriteQueue;
+    
+    // Live view streaming
+    ofxSonyCameraLiveView mLiveView;
+    
+    // Legal values per property code, rebuilt as properties change
+    std::map<CrInt32u, ofxSonyCameraValueTable> mValueTables;
+    mutable std::mutex mValueTablesMutex;
+    
+    // Every property as last read, patched in place by each refresh, and the
+    // immutable copy getSnapshot() last handed out, made again only once the
+    // working one has changed
+    ofxSonyCameraPropertySnapshot mLiveSnapshot;
+    mutable bool mSnapshotStale;
+    mutable std::shared_ptr<const ofxSonyCameraPropertySnapshot> mSnapshot;
+    mutable std::mutex mSnapshotMutex;
     
     // Helper methods for SDK interaction
     void loadProperties();
+    void storeProperties(const std::vector<ofxSonyCameraBackend::Property>& properties, bool complete);
+    bool savesToHost();
+    bool setNearestValue(CrInt32u code, double quantity, const char* name);
+    void refreshProperties(const std::vector<CrInt32u>& codes);
+    CrError sendProperty(CrInt32u code, CrInt64u value);
+    void flushPropertyWrites(std::map<CrInt32u, CrError>* results = nullptr);
     
-    // USB debugging data structures
-    struct UsbDeviceInfo {
-        uint16_t vendorId;
-        uint16_t productId;
-        uint8_t busNumber;
-        uint8_t deviceAddress;
-        std::string manufacturer;
-        std::string product;
-        std::string serialNumber;
-        bool isSonyCamera;
-        bool isAccessible;
-    };
-    
-    // USB device list and error messages
+    // USB device list and error messages, in bus/address order
     std::vector<UsbDeviceInfo> mUsbDeviceInfoList;
+    
+    // Every device seen by the last scan, keyed by usbDeviceKey()
+    std::map<uint64_t, UsbDeviceInfo> mUsbInventory;
     std::vector<std::string> mUsbErrorMessages;
     
     // libusb function pointer types
@@ -275,6 +1095,13 @@ private:
     typedef int (*libusb_claim_interface_fn)(libusb_device_handle*, int);
     typedef int (*libusb_release_interface_fn)(libusb_device_handle*, int);
     typedef const char* (*libusb_error_name_fn)(int);
+    typedef int (*libusb_has_capability_fn)(uint32_t);
+    typedef int (*libusb_hotplug_callback_fn)(libusb_context*, libusb_device*, int, void*);
+    typedef int (*libusb_hotplug_register_callback_fn)(libusb_context*, int, int, int, int, int,
+                                                       libusb_hotplug_callback_fn, void*,
+                                                       libusb_hotplug_callback_handle*);
+    typedef void (*libusb_hotplug_deregister_callback_fn)(libusb_context*, libusb_hotplug_callback_handle);
+    typedef int (*libusb_handle_events_timeout_completed_fn)(libusb_context*, struct timeval*, int*);
     
     // libusb function pointers
     libusb_init_fn fn_libusb_init;
@@ -291,12 +1118,32 @@ private:
     libusb_release_interface_fn fn_libusb_release_interface;
     libusb_error_name_fn fn_libusb_error_name;
     
+    // Optional: missing in libusb builds without hotplug support
+    libusb_has_capability_fn fn_libusb_has_capability;
+    libusb_hotplug_register_callback_fn fn_libusb_hotplug_register_callback;
+    libusb_hotplug_deregister_callback_fn fn_libusb_hotplug_deregister_callback;
+    libusb_handle_events_timeout_completed_fn fn_libusb_handle_events_timeout_completed;
+    
     // libusb context
     libusb_context* mUsbContext;
     
     // Library handle
     void* mLibUsbHandle;
     
+    // Hotplug: libusb events are handled on their own thread and forwarded
+    // through mEvents; times are steady-clock microseconds, 0 when unset
+    libusb_hotplug_callback_handle mHotplugHandle;
+    std::thread mHotplugThread;
+    std::atomic<bool> mHotplugRunning;
+    std::atomic<int64_t> mHotplugFirstEventMicros;
+    std::atomic<int64_t> mHotplugLastEventMicros;
+    bool mHotplugEnumeratePending;
+    int64_t mHotplugArrivalMicros;
+    HotplugStats mHotplugStats;
+    
+    static int onHotplugEvent(libusb_context* context, libusb_device* device, int event, void* userData);
+    void updateHotplug();
+    
     // USB helper methods
     bool loadLibUsbFunctions();
     int enumerateAllUsbDevices();
@@ -304,6 +1151,7 @@ private:
     std::string getUsbDeviceString(libusb_device_handle* handle, uint8_t descIndex);
     bool isSonyCamera(uint16_t vendorId, uint16_t productId) const;
     void addUsbError(const std::string& message) const;
+    static uint64_t usbDeviceKey(uint8_t busNumber, uint8_t deviceAddress, const libusb_device_descriptor& desc);
     bool isAlpha7sIII(uint16_t vendorId, uint16_t productId, const std::string& productString) const;
     const char* getLibUsbErrorName(int code) const;
 };
@@ -0,0 +1,394 @@
+#include "ofxSonyCameraReplayBackend.h"
+#include "ofMain.h"
+#include "ofxSonyCameraLog.h"
+#include <algorithm>
+
+typedef ofxSonyCameraTrace::Record Record;
+
+ofxSonyCameraReplayBackend::ofxSonyCameraReplayBackend(const std::string& path)
+    : ofxSonyCameraReplayBackend(path, Settings()) {
+}
+
+ofxSonyCameraReplayBackend::ofxSonyCameraReplayBackend(const std::string& path, const Settings& settings)
+    : mSettings(settings)
+    , mLoaded(false)
+    , mNextCall(0)
+    , mReached(0)
+    , mNextNotification(0)
+    , mStart(std::chrono::steady_clock::now())
+    , mRunning(true) {
+    mLoaded = ofxSonyCameraTrace::load(path, mRecords);
+
+    size_t lastCall = kNone;
+    for (size_t i = 0; i < mRecords.size(); i++) {
+        if (mRecords[i].isCall()) {
+            Call call;
+            call.record = i;
+            lastCall = mCalls.size();
+            mCalls.push_back(call);
+        } else {
+            Notification notification;
+            notification.record = i;
+            notification.anchor = lastCall;
+            mNotifications.push_back(notification);
+        }
+    }
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraReplayBackend", "Replaying {} call(s) and {} notification(s) from {}",
+        mCalls.size(), mNotifications.size(), path);
+
+    mThread = std::thread(&ofxSonyCameraReplayBackend::threadedFunction, this);
+}
+
+ofxSonyCameraReplayBackend::~ofxSonyCameraReplayBackend() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRunning = false;
+    }
+    mCondition.notify_all();
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+bool ofxSonyCameraReplayBackend::isLoaded() const {
+    return mLoaded;
+}
+
+const std::vector<Record>& ofxSonyCameraReplayBackend::getRecords() const {
+    return mRecords;
+}
+
+bool ofxSonyCameraReplayBackend::isFinished() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mReached == mCalls.size() && mNextNotification == mNotifications.size();
+}
+
+bool ofxSonyCameraReplayBackend::waitUntilFinished(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    return mCondition.wait_for(lock, timeout, [this]() {
+        return mReached == mCalls.size() && mNextNotification == mNotifications.size();
+    });
+}
+
+ofxSonyCameraReplayBackend::Stats ofxSonyCameraReplayBackend::getStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    Stats stats = mStats;
+    for (size_t i = 0; i < mReached; i++) {
+        if (!mCalls[i].consumed) {
+            stats.skipped++;
+        }
+    }
+    return stats;
+}
+
+bool ofxSonyCameraReplayBackend::init() {
+    return mLoaded;
+}
+
+void ofxSonyCameraReplayBackend::release() {
+}
+
+CrInt32u ofxSonyCameraReplayBackend::getSdkVersion() {
+    const Record* record = replayCall(Record::TYPE_GET_SDK_VERSION, 0);
+    if (!record) {
+        return 0;
+    }
+    finishCall(*record);
+    return record->result;
+}
+
+SCRSDK::CrError ofxSonyCameraReplayBackend::enumerate(std::vector<CameraInfo>& cameras) {
+    cameras.clear();
+    const Record* record = replayCall(Record::TYPE_ENUMERATE, 0);
+    if (!record) {
+        return SCRSDK::CrError_Generic;
+    }
+
+    for (const CameraInfo& recorded : record->cameras) {
+        CameraInfo camera = recorded;
+        camera.handle = std::make_shared<std::string>(recorded.id);
+        cameras.push_back(camera);
+    }
+    return finishCall(*record);
+}
+
+SCRSDK::CrError ofxSonyCameraReplayBackend::connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) {
+    if (!callback || !deviceHandle) {
+        return SCRSDK::CrError_Generic_InvalidParameter;
+    }
+
+    const Record* record = replayCall(Record::TYPE_CONNECT, 0);
+    if (!record) {
+        return SCRSDK::CrError_Generic;
+    }
+    if (record->text != camera.id) {
+        mismatch("Connect to " + camera.id + " was recorded for " + record->text);
+    }
+
+    // Recorded connection numbers serve as handles. Like the SDK, the
+    // callback is set before Connect() returns, as OnConnected may come first
+    if (record->result == SCRSDK::CrError_None) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCallbacks[record->connection] = callback;
+        *deviceHandle = record->connection;
+    }
+    return finishCall(*record);
+}
+
+SCRSDK::CrError ofxSonyCameraReplayBackend::disconnect(SCRSDK::CrDeviceHandle deviceHandle) {
+    const Record* record = replayCall(Record::TYPE_DISCONNECT, deviceHandle);
+    return record ? finishCall(*record) : SCRSDK::CrError_Generic;
+}
+
+SCRSDK::CrError ofxSonyCameraReplayBackend::releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCallbacks.erase(static_cast<uint32_t>(deviceHandle));
+    }
+
+    // Wait for a notification already being delivered to this connection;
+    // from the notification thread itself there is none
+    if (std::this_thread::get_id() != mThread.get_id()) {
+        std::lock_guard<std::mutex> delivery(mDeliveryMutex);
+    }
+
+    const Record* record = replayCall(Record::TYPE_RELEASE_DEVICE, deviceHandle);
+    return record ? finishCall(*record) : SCRSDK::CrError_Generic;
+}
+
+SCRSDK::CrError ofxSonyCameraReplayBackend::sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) {
+    const Record* record = replayCall(Record::TYPE_SEND_COMMAND, deviceHandle);
+    if (!record) {
+        return SCRSDK::CrError_Generic;
+    }
+    if (record->args[0] != commandId || record->args[1] != commandParam) {
+        mismatch("SendCommand " + ofToString(commandId) + "/" + ofToString(commandParam) + " was recorded as " +
+                 ofToString(record->args[0]) + "/" + ofToString(record->args[1]));
+    }
+    return finishCall(*record);
+}
+
+SCRSDK::CrError ofxSonyCameraReplayBackend::getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) {
+    const Record* record = replayCall(Record::TYPE_GET_DEVICE_PROPERTIES, deviceHandle);
+    if (!record) {
+        return SCRSDK::CrError_Generic;
+    }
+    if (record->result == SCRSDK::CrError_None) {
+        properties = record->properties;
+    }
+    return finishCall(*record);
+}
+
+SCRSDK::CrError ofxSonyCameraReplayBackend::getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) {
+    if (numOfCodes > 0 && !codes) {
+        return SCRSDK::CrError_Generic_InvalidParameter;
+    }
+
+    const Record* record = replayCall(Record::TYPE_GET_SELECT_DEVICE_PROPERTIES, deviceHandle);
+    if (!record) {
+        return SCRSDK::CrError_Generic;
+    }
+    if (record->codes != std::vector<CrInt32u>(codes, codes + numOfCodes)) {
+        mismatch("GetSelectDeviceProperties was recorded for other codes");
+    }
+    if (record->result == SCRSDK::CrError_None) {
+        properties = record->properties;
+    }
+    return finishCall(*record);
+}
+
+SCRSDK::CrError ofxSonyCameraReplayBackend::setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) {
+    const Record* record = replayCall(Record::TYPE_SET_DEVICE_PROPERTY, deviceHandle);
+    if (!record) {
+        return SCRSDK::CrError_Generic;
+    }
+    if (record->args[0] != property.code || record->args[1] != property.value) {
+        mismatch("SetDeviceProperty " + ofToString(property.code) + " = " + ofToString(property.value) +
+                 " was recorded as " + ofToString(record->args[0]) + " = " + ofToString(record->args[1]));
+    }
+    return finishCall(*record);
+}
+
+std::unique_ptr<ofxSonyCameraLiveViewSource> ofxSonyCameraReplayBackend::createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) {
+    // Live view frames aren't recorded
+    return nullptr;
+}
+
+const Record* ofxSonyCameraReplayBackend::replayCall(Record::Type type, SCRSDK::CrDeviceHandle deviceHandle) {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    // Calls of one connection replay in recorded order; calls of different
+    // connections, as a rig makes them from several threads, may interleave
+    // differently than they were recorded
+    bool perConnection = type != Record::TYPE_GET_SDK_VERSION && type != Record::TYPE_ENUMERATE && type != Record::TYPE_CONNECT;
+    size_t found = kNone;
+    for (size_t i = mNextCall; i < mCalls.size(); i++) {
+        const Record& record = mRecords[mCalls[i].record];
+        if (!mCalls[i].consumed && record.type == type && (!perConnection || record.connection == deviceHandle)) {
+            found = i;
+            break;
+        }
+    }
+    if (found == kNone) {
+        lock.unlock();
+        mismatch("No recorded call left to answer call type " + ofToString(type));
+        return nullptr;
+    }
+
+    // Calls passed over count as reached, so the notifications following
+    // them aren't held back for good
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = mReached; i < found; i++) {
+        if (!mCalls[i].consumed) {
+            mCalls[i].started = now;
+            mCalls[i].returned = true;
+            mCalls[i].returnedAt = now;
+        }
+    }
+    mCalls[found].started = now;
+    mReached = std::max(mReached, found + 1);
+    mCalls[found].consumed = true;
+    while (mNextCall < mCalls.size() && mCalls[mNextCall].consumed) {
+        mNextCall++;
+    }
+    mStats.calls++;
+    mCondition.notify_all();
+    return &mRecords[mCalls[found].record];
+}
+
+SCRSDK::CrError ofxSonyCameraReplayBackend::finishCall(const Record& record) {
+    std::chrono::microseconds duration = scale(record.durationMicros);
+    if (duration.count() > 0) {
+        std::this_thread::sleep_for(duration);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        size_t index = &record - mRecords.data();
+        auto call = std::lower_bound(mCalls.begin(), mCalls.end(), index, [](const Call& call, size_t index) {
+            return call.record < index;
+        });
+        call->returned = true;
+        call->returnedAt = std::chrono::steady_clock::now();
+    }
+    mCondition.notify_all();
+    return static_cast<SCRSDK::CrError>(record.result);
+}
+
+void ofxSonyCameraReplayBackend::mismatch(const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.mismatches++;
+    }
+    OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraReplayBackend", "{}", message);
+}
+
+std::chrono::microseconds ofxSonyCameraReplayBackend::scale(uint64_t micros) const {
+    if (mSettings.speed <= 0) {
+        return std::chrono::microseconds(0);
+    }
+    return std::chrono::microseconds(static_cast<int64_t>(micros / mSettings.speed));
+}
+
+void ofxSonyCameraReplayBackend::deliver(const Record& record, SCRSDK::IDeviceCallback* callback) {
+    // The SDK passes mutable buffers; hand the callback copies
+    std::vector<CrInt32u> codes = record.codes;
+    std::string text = record.text;
+    CrInt32u value = static_cast<CrInt32u>(record.args[0]);
+
+    switch (record.type) {
+        case Record::TYPE_CONNECTED:
+            callback->OnConnected(value);
+            break;
+        case Record::TYPE_DISCONNECTED:
+            callback->OnDisconnected(value);
+            break;
+        case Record::TYPE_PROPERTY_CHANGED:
+            callback->OnPropertyChanged();
+            break;
+        case Record::TYPE_PROPERTY_CHANGED_CODES:
+            callback->OnPropertyChangedCodes(static_cast<CrInt32u>(codes.size()), codes.data());
+            break;
+        case Record::TYPE_LV_PROPERTY_CHANGED:
+            callback->OnLvPropertyChanged();
+            break;
+        case Record::TYPE_LV_PROPERTY_CHANGED_CODES:
+            callback->OnLvPropertyChangedCodes(static_cast<CrInt32u>(codes.size()), codes.data());
+            break;
+        case Record::TYPE_COMPLETE_DOWNLOAD:
+            callback->OnCompleteDownload(&text[0], value);
+            break;
+        case Record::TYPE_NOTIFY_CONTENTS_TRANSFER:
+            callback->OnNotifyContentsTransfer(value, static_cast<SCRSDK::CrContentHandle>(record.args[1]), &text[0]);
+            break;
+        case Record::TYPE_WARNING:
+            callback->OnWarning(value);
+            break;
+        case Record::TYPE_ERROR:
+            callback->OnError(value);
+            break;
+        default:
+            break;
+    }
+}
+
+void ofxSonyCameraReplayBackend::threadedFunction() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mRunning) {
+        if (mNextNotification >= mNotifications.size()) {
+            mCondition.wait(lock);
+            continue;
+        }
+
+        // A notification is due at its recorded offset from the call before
+        // it: from its start if it came while the call ran, otherwise from
+        // its return, so the application has seen the call's result first
+        const Notification& notification = mNotifications[mNextNotification];
+        const Record& record = mRecords[notification.record];
+        std::chrono::steady_clock::time_point due;
+        if (notification.anchor == kNone) {
+            due = mStart + scale(record.timeMicros);
+        } else {
+            const Call& call = mCalls[notification.anchor];
+            const Record& anchor = mRecords[call.record];
+            uint64_t anchorEnd = anchor.timeMicros + anchor.durationMicros;
+            if (notification.anchor < mReached && record.timeMicros < anchorEnd) {
+                due = call.started + scale(record.timeMicros - anchor.timeMicros);
+            } else if (call.returned) {
+                due = call.returnedAt + scale(record.timeMicros - anchorEnd);
+            } else {
+                mCondition.wait(lock);
+                continue;
+            }
+        }
+        if (std::chrono::steady_clock::now() < due) {
+            mCondition.wait_until(lock, due);
+            continue;
+        }
+        mNextNotification++;
+        lock.unlock();
+
+        // Look the connection up under the delivery lock, so a released
+        // connection's callback is never called
+        {
+            std::lock_guard<std::mutex> delivery(mDeliveryMutex);
+            SCRSDK::IDeviceCallback* callback = nullptr;
+            {
+                std::lock_guard<std::mutex> lookup(mMutex);
+                auto it = mCallbacks.find(record.connection);
+                if (it != mCallbacks.end()) {
+                    callback = it->second;
+                    mStats.callbacks++;
+                } else {
+                    mStats.dropped++;
+                }
+            }
+            if (callback) {
+                deliver(record, callback);
+            }
+        }
+
+        lock.lock();
+        mCondition.notify_all();
+    }
+}
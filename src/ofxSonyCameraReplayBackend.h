@@ -0,0 +1,140 @@
+#pragma once
+
+#include "ofxSonyCameraBackend.h"
+#include "ofxSonyCameraTrace.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Backend replaying a trace written by ofxSonyCameraRecordingBackend
+ *
+ * Each call is answered by the next recorded call of the same type and
+ * connection: it takes the recorded time, scaled by the replay speed, and
+ * returns the recorded result, cameras and properties. Notifications are
+ * delivered on a thread of their own, at the recorded offset from the call
+ * that preceded them, so a capture's download still arrives after its
+ * shutter release however the application paces its calls.
+ *
+ * Lets a recorded session be reproduced offline, with ofxSonyCameraRemote
+ * and ofxSonyCameraCallback going through the same calls and notifications
+ * as with the camera; at speed 0 nothing waits, which times the addon's own
+ * overhead. There is no live view.
+ */
+class ofxSonyCameraReplayBackend : public ofxSonyCameraBackend {
+public:
+    struct Settings {
+        double speed = 1.0; // 2 replays twice as fast; 0 doesn't wait at all
+    };
+
+    struct Stats {
+        uint64_t calls = 0;      // answered from the trace
+        uint64_t mismatches = 0; // calls with no recorded counterpart, or with other arguments
+        uint64_t skipped = 0;    // recorded calls passed over without being made
+        uint64_t callbacks = 0;  // notifications delivered
+        uint64_t dropped = 0;    // notifications for connections that weren't open
+    };
+
+    /**
+     * @param path A trace file; see isLoaded()
+     */
+    explicit ofxSonyCameraReplayBackend(const std::string& path);
+    ofxSonyCameraReplayBackend(const std::string& path, const Settings& settings);
+    ~ofxSonyCameraReplayBackend();
+
+    /**
+     * @brief Check whether the trace could be read
+     */
+    bool isLoaded() const;
+
+    const std::vector<ofxSonyCameraTrace::Record>& getRecords() const;
+
+    /**
+     * @brief Check whether every recorded call was reached and every notification delivered
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Wait for isFinished()
+     *
+     * @return false on timeout
+     */
+    bool waitUntilFinished(std::chrono::milliseconds timeout);
+
+    Stats getStats() const;
+
+    // ofxSonyCameraBackend
+    bool init() override;
+    void release() override;
+    CrInt32u getSdkVersion() override;
+    SCRSDK::CrError enumerate(std::vector<CameraInfo>& cameras) override;
+    SCRSDK::CrError connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) override;
+    SCRSDK::CrError disconnect(SCRSDK::CrDeviceHandle deviceHandle) override;
+    SCRSDK::CrError releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) override;
+    SCRSDK::CrError sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) override;
+    SCRSDK::CrError getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) override;
+    SCRSDK::CrError getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) override;
+    SCRSDK::CrError setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) override;
+    std::unique_ptr<ofxSonyCameraLiveViewSource> createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) override;
+
+private:
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    // Recorded calls, in order, and when each was replayed or passed over
+    struct Call {
+        size_t record = 0;
+        bool consumed = false;
+        bool returned = false;
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::time_point returnedAt;
+    };
+
+    // Recorded notifications, each following the call before it
+    struct Notification {
+        size_t record = 0;
+        size_t anchor = kNone; // index into mCalls
+    };
+
+    /**
+     * @brief Find the recorded call answering a call and mark it replayed
+     *
+     * @return The record, or nullptr if the trace has none to answer with
+     */
+    const ofxSonyCameraTrace::Record* replayCall(ofxSonyCameraTrace::Record::Type type, SCRSDK::CrDeviceHandle deviceHandle);
+
+    /**
+     * @brief Wait for a replayed call's recorded duration and mark it returned
+     *
+     * @return The recorded result
+     */
+    SCRSDK::CrError finishCall(const ofxSonyCameraTrace::Record& record);
+
+    void mismatch(const std::string& message);
+    std::chrono::microseconds scale(uint64_t micros) const;
+    void deliver(const ofxSonyCameraTrace::Record& record, SCRSDK::IDeviceCallback* callback);
+    void threadedFunction();
+
+    Settings mSettings;
+    Stats mStats;
+    bool mLoaded;
+
+    std::vector<ofxSonyCameraTrace::Record> mRecords;
+    std::vector<Call> mCalls;
+    std::vector<Notification> mNotifications;
+    size_t mNextCall;         // first call not yet replayed
+    size_t mReached;          // calls before this were replayed or passed over
+    size_t mNextNotification; // first notification not yet delivered
+    std::chrono::steady_clock::time_point mStart;
+
+    std::map<uint32_t, SCRSDK::IDeviceCallback*> mCallbacks; // by connection number
+    mutable std::mutex mMutex;
+
+    // Notification thread; mDeliveryMutex is held while one is delivered, so
+    // releaseDevice() can wait for the one in flight
+    std::mutex mDeliveryMutex;
+    std::condition_variable mCondition;
+    std::thread mThread;
+    bool mRunning;
+};
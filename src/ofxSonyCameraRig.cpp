@@ -0,0 +1,307 @@
+#include "ofxSonyCameraRig.h"
+#include "ofxSonyCameraLog.h"
+#include <chrono>
+#include <future>
+
+namespace {
+    uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    ofxSonyCameraRig::State toRigState(ofxSonyCameraRemote::ConnectionState state) {
+        switch (state) {
+            case ofxSonyCameraRemote::STATE_CONNECTING: return ofxSonyCameraRig::STATE_CONNECTING;
+            case ofxSonyCameraRemote::STATE_CONNECTED: return ofxSonyCameraRig::STATE_CONNECTED;
+            case ofxSonyCameraRemote::STATE_FAILED: return ofxSonyCameraRig::STATE_FAILED;
+            default: return ofxSonyCameraRig::STATE_DISCONNECTED; // including reconnecting
+        }
+    }
+}
+
+ofxSonyCameraRig::ofxSonyCameraRig()
+    : mBackend(std::make_shared<ofxSonyCameraSdkBackend>())
+    , mSdkAcquired(false)
+    , mMetrics("rig") {
+}
+
+ofxSonyCameraRig::~ofxSonyCameraRig() {
+    exit();
+}
+
+bool ofxSonyCameraRig::setup() {
+    if (mSdkAcquired) {
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (!mBackend->init()) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRig", "Failed to initialize Sony Camera Remote SDK");
+        return false;
+    }
+    mSdkAcquired = true;
+    mReport = BringUpReport();
+    mReport.sdkInitMicros = microsSince(start);
+    return true;
+}
+
+void ofxSonyCameraRig::exit() {
+    disconnectAll();
+
+    // Camera objects hold their own SDK reference; drop them first, which
+    // also releases the enumeration
+    mCameras.clear();
+
+    if (mSdkAcquired) {
+        mBackend->release();
+        mSdkAcquired = false;
+    }
+}
+
+size_t ofxSonyCameraRig::enumerate() {
+    if (!mSdkAcquired) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRig", "Cannot enumerate: setup() not called");
+        return 0;
+    }
+
+    // Connected cameras hold their own copy of their camera info, but one
+    // missing from a new enumeration would lose the entry's and couldn't be
+    // connected again, so only re-enumerate when nothing is connected
+    bool inUse = false;
+    for (const auto& entry : mCameras) {
+        State state = entry.second->state;
+        if (state == STATE_CONNECTED || state == STATE_CONNECTING) {
+            inUse = true;
+        }
+    }
+    if (inUse) {
+        OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraRig", "Cannot re-enumerate while cameras are connected");
+        return mCameras.size();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<ofxSonyCameraBackend::CameraInfo> found;
+    CrError err = OFX_SONY_CAMERA_TIMED(mMetrics, CALL_ENUM_CAMERA_OBJECTS, mBackend->enumerate(found));
+    mReport.enumerateMicros = microsSince(start);
+
+    for (auto& entry : mCameras) {
+        entry.second->info = ofxSonyCameraBackend::CameraInfo();
+    }
+
+    if (err != CrError_None) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRig", "Failed to enumerate camera devices: {}", err);
+        return 0;
+    }
+
+    size_t count = found.size();
+    for (size_t i = 0; i < count; i++) {
+        const ofxSonyCameraBackend::CameraInfo& info = found[i];
+        std::string serial = info.id;
+        if (serial.empty()) {
+            serial = "camera-" + ofToString(i);
+        }
+
+        auto& camera = mCameras[serial];
+        if (!camera) {
+            camera = std::make_unique<Camera>();
+            camera->serial = serial;
+        }
+        camera->model = info.model;
+        camera->info = info;
+
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRig", "Camera {}: Model={}", serial, camera->model);
+    }
+
+    mReport.camerasFound = count;
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRig", "Found {} camera(s) in {} ms", count, mReport.enumerateMicros / 1000.0);
+    return count;
+}
+
+size_t ofxSonyCameraRig::connectAll() {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<void>> pending;
+
+    for (auto& entry : mCameras) {
+        Camera* camera = entry.second.get();
+        State state = camera->state;
+        if (!camera->info.handle || state == STATE_CONNECTED || state == STATE_CONNECTING) {
+            continue;
+        }
+
+        // One camera object per body, each with its own command thread
+        if (!camera->remote) {
+            camera->remote = std::make_unique<ofxSonyCameraRemote>();
+            camera->remote->setBackend(mBackend);
+            if (!camera->remote->setup()) {
+                camera->state = STATE_FAILED;
+                continue;
+            }
+
+            std::string serial = camera->serial;
+            camera->remote->registerConnectCallback([this, serial]() {
+                if (mConnectCallback) mConnectCallback(serial);
+            });
+            camera->remote->registerDisconnectCallback([this, serial](CrInt32u error) {
+                if (mDisconnectCallback) mDisconnectCallback(serial, error);
+            });
+
+            // Follow the camera through drops and automatic reconnects. The
+            // event may be stale by the time it is polled, so the current
+            // state is read instead
+            camera->remote->registerConnectionStateCallback([camera](ofxSonyCameraRemote::ConnectionState) {
+                camera->state = toRigState(camera->remote->getConnectionState());
+            });
+            camera->remote->registerErrorCallback([this, serial](CrInt32u error) {
+                if (mErrorCallback) mErrorCallback(serial, error);
+            });
+        }
+
+        camera->state = STATE_CONNECTING;
+        auto done = std::make_shared<std::promise<void>>();
+        pending.push_back(done->get_future());
+
+        auto cameraStart = std::chrono::steady_clock::now();
+        camera->remote->connectAsync(camera->info, [camera, cameraStart, done](CrError err) {
+            camera->connectMicros = microsSince(cameraStart);
+            camera->lastError = err;
+            camera->state = err == CrError_None ? STATE_CONNECTED : STATE_FAILED;
+            done->set_value();
+        });
+    }
+
+    for (auto& future : pending) {
+        future.wait();
+    }
+
+    mReport.connectMicros = microsSince(start);
+    mReport.slowestConnectMicros = 0;
+    for (const auto& entry : mCameras) {
+        const Camera& camera = *entry.second;
+        mReport.slowestConnectMicros = std::max(mReport.slowestConnectMicros, camera.connectMicros);
+        if (camera.state == STATE_FAILED) {
+            OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRig", "Camera {} failed to connect: {}", camera.serial, camera.lastError);
+        }
+    }
+    mReport.camerasConnected = getNumConnected();
+
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraRig", "Connected {}/{} camera(s) in {} ms (slowest {} ms, enumerate {} ms, SDK init {} ms)",
+        mReport.camerasConnected, mCameras.size(), mReport.connectMicros / 1000.0,
+        mReport.slowestConnectMicros / 1000.0, mReport.enumerateMicros / 1000.0, mReport.sdkInitMicros / 1000.0);
+    return mReport.camerasConnected;
+}
+
+void ofxSonyCameraRig::update() {
+    for (auto& entry : mCameras) {
+        if (entry.second->remote) {
+            entry.second->remote->pollEvents();
+        }
+    }
+}
+
+void ofxSonyCameraRig::disconnectAll() {
+    std::vector<std::future<CrError>> pending;
+    for (auto& entry : mCameras) {
+        Camera& camera = *entry.second;
+        if (camera.remote && camera.remote->isConnected()) {
+            pending.push_back(camera.remote->disconnectAsync());
+        }
+    }
+    for (auto& future : pending) {
+        future.wait();
+    }
+
+    for (auto& entry : mCameras) {
+        if (entry.second->state == STATE_CONNECTED) {
+            entry.second->state = STATE_DISCONNECTED;
+        }
+    }
+}
+
+std::vector<std::string> ofxSonyCameraRig::getSerialNumbers() const {
+    std::vector<std::string> serials;
+    for (const auto& entry : mCameras) {
+        serials.push_back(entry.first);
+    }
+    return serials;
+}
+
+ofxSonyCameraRemote* ofxSonyCameraRig::getCamera(const std::string& serial) {
+    Camera* camera = findCamera(serial);
+    return camera ? camera->remote.get() : nullptr;
+}
+
+std::vector<ofxSonyCameraRemote*> ofxSonyCameraRig::getConnectedCameras() {
+    std::vector<ofxSonyCameraRemote*> cameras;
+    for (auto& entry : mCameras) {
+        if (entry.second->state == STATE_CONNECTED) {
+            cameras.push_back(entry.second->remote.get());
+        }
+    }
+    return cameras;
+}
+
+ofxSonyCameraRig::State ofxSonyCameraRig::getState(const std::string& serial) const {
+    Camera* camera = findCamera(serial);
+    return camera ? camera->state.load() : STATE_DISCONNECTED;
+}
+
+size_t ofxSonyCameraRig::getNumConnected() const {
+    size_t count = 0;
+    for (const auto& entry : mCameras) {
+        if (entry.second->state == STATE_CONNECTED) {
+            count++;
+        }
+    }
+    return count;
+}
+
+const ofxSonyCameraRig::BringUpReport& ofxSonyCameraRig::getBringUpReport() const {
+    return mReport;
+}
+
+ofxSonyCameraMetrics& ofxSonyCameraRig::getMetrics() {
+    return mMetrics;
+}
+
+void ofxSonyCameraRig::setBackend(std::shared_ptr<ofxSonyCameraBackend> backend) {
+    if (mSdkAcquired) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraRig", "Cannot change the backend after setup()");
+        return;
+    }
+    if (backend) {
+        mBackend = backend;
+    }
+}
+
+std::shared_ptr<ofxSonyCameraBackend> ofxSonyCameraRig::getBackend() const {
+    return mBackend;
+}
+
+void ofxSonyCameraRig::setConnectCallback(std::function<void(const std::string&)> callback) {
+    mConnectCallback = callback;
+}
+
+void ofxSonyCameraRig::setDisconnectCallback(std::function<void(const std::string&, CrInt32u)> callback) {
+    mDisconnectCallback = callback;
+}
+
+void ofxSonyCameraRig::setErrorCallback(std::function<void(const std::string&, CrInt32u)> callback) {
+    mErrorCallback = callback;
+}
+
+std::string ofxSonyCameraRig::getStateName(State state) {
+    switch (state) {
+        case STATE_DISCOVERED: return "Discovered";
+        case STATE_CONNECTING: return "Connecting";
+        case STATE_CONNECTED: return "Connected";
+        case STATE_DISCONNECTED: return "Disconnected";
+        case STATE_FAILED: return "Failed";
+        default: return "Unknown";
+    }
+}
+
+ofxSonyCameraRig::Camera* ofxSonyCameraRig::findCamera(const std::string& serial) const {
+    auto it = mCameras.find(serial);
+    return it == mCameras.end() ? nullptr : it->second.get();
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxSonyCameraRemote.h"
+#include <map>
+#include <atomic>
+
+/**
+ * @brief Manager for a rig of several Sony cameras
+ *
+ * The rig holds one reference to the Camera Remote SDK for its whole
+ * lifetime, enumerates all cameras with a single SDK call and drives one
+ * ofxSonyCameraRemote per body. Cameras are keyed by serial number
+ * (the camera id from enumeration), so state and callbacks follow a body no
+ * matter where it shows up in the enumeration order.
+ *
+ * Connections are made in parallel, each on its camera's command thread, and
+ * the time spent in each bring-up phase is recorded.
+ */
+class ofxSonyCameraRig {
+public:
+    enum State {
+        STATE_DISCOVERED,
+        STATE_CONNECTING,
+        STATE_CONNECTED,
+        STATE_DISCONNECTED,
+        STATE_FAILED
+    };
+
+    /**
+     * @brief Timing of the last setup/enumerate/connectAll sequence
+     */
+    struct BringUpReport {
+        uint64_t sdkInitMicros = 0;   // setup(): SDK initialization
+        uint64_t enumerateMicros = 0; // enumerate(): the backend's enumeration
+        uint64_t connectMicros = 0;   // connectAll(): wall time for all connections
+        uint64_t slowestConnectMicros = 0;
+        size_t camerasFound = 0;
+        size_t camerasConnected = 0;
+    };
+
+    ofxSonyCameraRig();
+    ~ofxSonyCameraRig();
+
+    /**
+     * @brief Initialize the SDK for the rig
+     *
+     * @return true if initialization was successful, false otherwise
+     */
+    bool setup();
+
+    /**
+     * @brief Disconnect every camera and release the SDK
+     */
+    void exit();
+
+    /**
+     * @brief Discover cameras with a single SDK enumeration
+     *
+     * Cameras already known by serial number keep their state; new ones are
+     * added in STATE_DISCOVERED.
+     *
+     * @return The number of cameras found
+     */
+    size_t enumerate();
+
+    /**
+     * @brief Connect every discovered camera in parallel
+     *
+     * Blocks until every connection attempt has finished.
+     *
+     * @return The number of connected cameras
+     */
+    size_t connectAll();
+
+    /**
+     * @brief Dispatch queued events of every camera
+     *
+     * Runs the rig and camera callbacks and picks up disconnections. Call
+     * once per frame.
+     */
+    void update();
+
+    /**
+     * @brief Disconnect every connected camera in parallel
+     */
+    void disconnectAll();
+
+    /**
+     * @brief Get the serial numbers of all known cameras, sorted
+     */
+    std::vector<std::string> getSerialNumbers() const;
+
+    /**
+     * @brief Get the camera with a serial number
+     *
+     * @return The camera, or nullptr if unknown
+     */
+    ofxSonyCameraRemote* getCamera(const std::string& serial);
+
+    /**
+     * @brief Get every connected camera, in serial number order
+     */
+    std::vector<ofxSonyCameraRemote*> getConnectedCameras();
+
+    /**
+     * @brief Get the state of the camera with a serial number
+     */
+    State getState(const std::string& serial) const;
+
+    /**
+     * @brief Get the number of connected cameras
+     */
+    size_t getNumConnected() const;
+
+    const BringUpReport& getBringUpReport() const;
+
+    /**
+     * @brief Get the timing of the rig's own SDK calls (enumeration)
+     *
+     * Each camera's calls are timed by its remote's getMetrics().
+     */
+    ofxSonyCameraMetrics& getMetrics();
+
+    /**
+     * @brief Replace the backend the rig and its cameras call the SDK through
+     *
+     * Must be called before setup(). One backend is shared by every camera.
+     *
+     * @param backend The backend, e.g. an ofxSonyCameraSimulatedBackend
+     */
+    void setBackend(std::shared_ptr<ofxSonyCameraBackend> backend);
+
+    std::shared_ptr<ofxSonyCameraBackend> getBackend() const;
+
+    // Rig-wide callbacks, called from update() with the serial number of the camera
+    void setConnectCallback(std::function<void(const std::string&)> callback);
+    void setDisconnectCallback(std::function<void(const std::string&, CrInt32u)> callback);
+    void setErrorCallback(std::function<void(const std::string&, CrInt32u)> callback);
+
+    static std::string getStateName(State state);
+
+private:
+    struct Camera {
+        std::string serial;
+        std::string model;
+        ofxSonyCameraBackend::CameraInfo info; // empty if missing from the last enumeration
+        std::unique_ptr<ofxSonyCameraRemote> remote;
+        std::atomic<State> state;
+        CrError lastError = CrError_None;
+        uint64_t connectMicros = 0;
+
+        Camera() : state(STATE_DISCOVERED) {}
+    };
+
+    Camera* findCamera(const std::string& serial) const;
+
+    std::map<std::string, std::unique_ptr<Camera>> mCameras;
+    std::shared_ptr<ofxSonyCameraBackend> mBackend;
+    bool mSdkAcquired;
+    BringUpReport mReport;
+    ofxSonyCameraMetrics mMetrics;
+
+    std::function<void(const std::string&)> mConnectCallback;
+    std::function<void(const std::string&, CrInt32u)> mDisconnectCallback;
+    std::function<void(const std::string&, CrInt32u)> mErrorCallback;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bounded lock-free multi-producer, single-consumer ring
+ *
+ * Every slot carries a sequence number (Vyukov's bounded queue), so a push is
+ * a compare-and-swap plus a copy into preallocated storage, without locks or
+ * allocation. A push into a full ring fails; what to do about it is up to the
+ * caller. Shared by ofxSonyCameraEventQueue and ofxSonyCameraLog.
+ *
+ * @tparam T The element type; slots are default-constructed once
+ * @tparam Capacity The number of slots; must be a power of two
+ */
+template<typename T, size_t Capacity>
+class ofxSonyCameraRing {
+public:
+    ofxSonyCameraRing()
+        : mEnqueuePos(0)
+        , mDequeuePos(0) {
+        for (size_t i = 0; i < Capacity; i++) {
+            mSlots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ofxSonyCameraRing(const ofxSonyCameraRing&) = delete;
+    ofxSonyCameraRing& operator=(const ofxSonyCameraRing&) = delete;
+
+    /**
+     * @brief Claim a slot from any thread and fill it with write(T& slot)
+     *
+     * @return false if the ring was full; write is not called then
+     */
+    template<typename Write>
+    bool push(Write write) {
+        size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &mSlots[pos & kMask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                // Slot is free for this position; claim it
+                if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The consumer hasn't freed this slot yet: full
+                return false;
+            } else {
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        write(slot->value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Hand the oldest element to read(const T& slot), then free its slot
+     *
+     * Only call from the consuming thread.
+     *
+     * @return false if the ring is empty
+     */
+    template<typename Read>
+    bool pop(Read read) {
+        Slot& slot = mSlots[mDequeuePos & kMask];
+        if (slot.sequence.load(std::memory_order_acquire) != mDequeuePos + 1) {
+            return false;
+        }
+
+        read(static_cast<const T&>(slot.value));
+        slot.sequence.store(mDequeuePos + Capacity, std::memory_order_release);
+        mDequeuePos++;
+        return true;
+    }
+
+    /**
+     * @brief Get the number of slots claimed so far, including pushes still being written
+     */
+    uint64_t getNumPushed() const {
+        return mEnqueuePos.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+    static_assert(Capacity > 0 && (Capacity & kMask) == 0, "Capacity must be a power of two");
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    Slot mSlots[Capacity];
+    std::atomic<size_t> mEnqueuePos;
+    size_t mDequeuePos; // consumer only
+};
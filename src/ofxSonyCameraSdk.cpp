@@ -0,0 +1,132 @@
+#include "ofxSonyCameraSdk.h"
+#include "ofMain.h"
+#include "ofxSonyCameraLog.h"
+#include <dlfcn.h>
+#include <map>
+#include <mutex>
+
+namespace {
+    std::mutex sdkMutex;
+    int sdkReferences = 0;
+
+    // Library locations, resolved on first use
+    std::mutex libraryMutex;
+    std::vector<std::string> librarySearchPaths = {
+        "",
+        "../../../../../libs/CRSDK/lib",
+        "../../../../../libs/CRSDK/lib/CrAdapter"
+    };
+    std::map<std::string, std::string> libraryLocations;
+
+    // Everything SCRSDK::Init() loads, directly or through its adapters
+    const char* const sdkLibraries[] = {
+        "libCr_Core.dylib",
+        "libCr_PTP_IP.dylib",
+        "libCr_PTP_USB.dylib",
+        "libusb-1.0.dylib",
+        "libmonitor_protocol.dylib",
+        "libmonitor_protocol_pf.dylib",
+        "libssh2.dylib",
+        "libusb-1.0.0.dylib"
+    };
+}
+
+bool ofxSonyCameraSdk::acquire() {
+    std::lock_guard<std::mutex> lock(sdkMutex);
+    if (sdkReferences > 0) {
+        sdkReferences++;
+        return true;
+    }
+
+#ifdef OFX_SONY_CAMERA_NO_SDK
+    OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraSdk", "Built without the Camera Remote SDK (OFX_SONY_CAMERA_NO_SDK)");
+    return false;
+#else
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraSdk", "Initializing Sony Camera Remote SDK...");
+    if (!SCRSDK::Init()) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraSdk", "Failed to initialize Sony Camera Remote SDK");
+        return false;
+    }
+
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraSdk", "SDK initialized successfully");
+    sdkReferences = 1;
+    return true;
+#endif
+}
+
+void ofxSonyCameraSdk::release() {
+    std::lock_guard<std::mutex> lock(sdkMutex);
+    if (sdkReferences == 0) {
+        return;
+    }
+    if (--sdkReferences == 0) {
+#ifndef OFX_SONY_CAMERA_NO_SDK
+        SCRSDK::Release();
+#endif
+        OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraSdk", "SDK released");
+    }
+}
+
+std::string ofxSonyCameraSdk::getCameraId(const SCRSDK::ICrCameraObjectInfo* cameraInfo) {
+    if (!cameraInfo || !cameraInfo->GetId()) {
+        return "";
+    }
+
+    // The id is a byte string; trim any trailing terminator
+    std::string id(reinterpret_cast<const char*>(cameraInfo->GetId()), cameraInfo->GetIdSize());
+    size_t end = id.find('\0');
+    if (end != std::string::npos) {
+        id.resize(end);
+    }
+    return id;
+}
+
+void ofxSonyCameraSdk::setLibrarySearchPaths(const std::vector<std::string>& paths) {
+    std::lock_guard<std::mutex> lock(libraryMutex);
+    librarySearchPaths = paths;
+    libraryLocations.clear();
+}
+
+std::vector<std::string> ofxSonyCameraSdk::getLibrarySearchPaths() {
+    std::lock_guard<std::mutex> lock(libraryMutex);
+    return librarySearchPaths;
+}
+
+std::string ofxSonyCameraSdk::findLibrary(const std::string& name) {
+    std::lock_guard<std::mutex> lock(libraryMutex);
+    auto it = libraryLocations.find(name);
+    if (it != libraryLocations.end()) {
+        return it->second;
+    }
+
+    // Misses are cached too, so a missing library costs one search per process
+    std::string& location = libraryLocations[name];
+    for (const std::string& directory : librarySearchPaths) {
+        std::string path = directory.empty() ? name : directory + "/" + name;
+        void* handle = dlopen(path.c_str(), RTLD_LAZY);
+        if (handle) {
+            dlclose(handle);
+            location = path;
+            break;
+        }
+        OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraSdk", "Could not load {}: {}", path, dlerror());
+    }
+    return location;
+}
+
+bool ofxSonyCameraSdk::probeLibraries() {
+    size_t found = 0;
+    for (const char* name : sdkLibraries) {
+        std::string path = findLibrary(name);
+        if (path.empty()) {
+            OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraSdk", "Failed to load {} from any search path", name);
+        } else {
+            OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraSdk", "Found {} at {}", name, path);
+            found++;
+        }
+    }
+
+    size_t total = sizeof(sdkLibraries) / sizeof(sdkLibraries[0]);
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraSdk", "Found {} of {} SDK libraries", found, total);
+    return found == total;
+}
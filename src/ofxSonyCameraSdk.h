@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CameraRemote_SDK.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Process-wide Camera Remote SDK lifetime
+ *
+ * SCRSDK::Init() and SCRSDK::Release() act on global SDK state, so every
+ * object that needs the SDK acquires a reference here instead of calling them
+ * directly. The SDK is initialized by the first acquire() and released by the
+ * last matching release().
+ */
+namespace ofxSonyCameraSdk {
+    /**
+     * @brief Initialize the SDK if this is the first reference
+     *
+     * @return true if the SDK is initialized, false otherwise
+     */
+    bool acquire();
+
+    /**
+     * @brief Drop a reference, releasing the SDK after the last one
+     */
+    void release();
+
+    /**
+     * @brief Get the identifier of a camera (its serial number over USB)
+     *
+     * @param cameraInfo The camera object info from enumeration
+     * @return The identifier as a string
+     */
+    std::string getCameraId(const SCRSDK::ICrCameraObjectInfo* cameraInfo);
+
+    /**
+     * @brief Set the directories searched for the SDK's dynamic libraries
+     *
+     * An empty entry stands for the system loader's own search. Clears the
+     * locations already resolved.
+     *
+     * @param paths Directories, tried in order
+     */
+    void setLibrarySearchPaths(const std::vector<std::string>& paths);
+
+    std::vector<std::string> getLibrarySearchPaths();
+
+    /**
+     * @brief Resolve a library against the search paths
+     *
+     * Each name is resolved once per process; later calls return the cached
+     * location without touching the file system.
+     *
+     * @param name The library file name, e.g. "libusb-1.0.dylib"
+     * @return The path that loaded, or an empty string if none did
+     */
+    std::string findLibrary(const std::string& name);
+
+    /**
+     * @brief Check that every library the SDK depends on can be loaded
+     *
+     * A diagnostic for setups where SCRSDK::Init() fails; not needed otherwise.
+     *
+     * @return true if all libraries were found, false otherwise
+     */
+    bool probeLibraries();
+}
@@ -0,0 +1,322 @@
+#include "ofxSonyCameraShotTracer.h"
+#include "ofMain.h"
+#include "ofxSonyCameraLog.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace {
+    void appendJsonString(std::string& json, const std::string& text) {
+        json += '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                json += '\\';
+                json += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                json += escaped;
+            } else {
+                json += c;
+            }
+        }
+        json += '"';
+    }
+
+    void appendSpan(std::string& json, const char* name, const char* category, uint64_t sequence, uint64_t start, uint64_t end) {
+        char event[256];
+        snprintf(event, sizeof(event),
+            ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu64 ",\"ts\":%" PRIu64 ",\"dur\":%" PRIu64,
+            name, category, sequence, start, end - start);
+        json += event;
+    }
+}
+
+ofxSonyCameraShotTracer::ofxSonyCameraShotTracer()
+    : mStart(std::chrono::steady_clock::now())
+    , mNextSequence(1) {
+}
+
+uint64_t ofxSonyCameraShotTracer::begin() {
+    Shot shot;
+    shot.stageMicros[STAGE_SUBMITTED] = now();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    shot.sequence = mNextSequence++;
+    if (mInFlight.size() >= kMaxInFlight) {
+        // Most likely the camera saves to its card only, so nothing downloads
+        mInFlight.front().abandoned = true;
+        finish(mInFlight.front());
+        mInFlight.pop_front();
+    }
+    mInFlight.push_back(shot);
+    return shot.sequence;
+}
+
+void ofxSonyCameraShotTracer::mark(uint64_t sequence, Stage stage) {
+    uint64_t time = now();
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (Shot* shot = findShot(sequence)) {
+        shot->stageMicros[stage] = time;
+    }
+}
+
+void ofxSonyCameraShotTracer::setMode(uint64_t sequence, int mode) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (Shot* shot = findShot(sequence)) {
+        shot->mode = mode;
+    }
+}
+
+void ofxSonyCameraShotTracer::markReturned(uint64_t sequence, bool failed) {
+    uint64_t time = now();
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto it = mInFlight.begin(); it != mInFlight.end(); ++it) {
+        if (it->sequence == sequence) {
+            it->stageMicros[STAGE_RETURNED] = time;
+            if (failed) {
+                it->failed = true;
+                finish(*it);
+                mInFlight.erase(it);
+            }
+            return;
+        }
+    }
+
+    // The download can complete before SendCommand returns
+    if (Shot* shot = findShot(sequence)) {
+        shot->stageMicros[STAGE_RETURNED] = time;
+    }
+}
+
+void ofxSonyCameraShotTracer::markNext(Stage stage) {
+    uint64_t time = now();
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = findFirstSent(stage);
+    if (it != mInFlight.end()) {
+        it->stageMicros[stage] = time;
+    }
+}
+
+void ofxSonyCameraShotTracer::markDownloaded(const std::string& filename) {
+    uint64_t time = now();
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = findFirstSent(STAGE_DOWNLOADED);
+    if (it == mInFlight.end()) {
+        return;
+    }
+    it->stageMicros[STAGE_DOWNLOADED] = time;
+    it->filename = filename;
+    finish(*it);
+    OFX_SONY_CAMERA_LOG_VERBOSE("ofxSonyCameraShotTracer", "Shot {} downloaded {} ms after it was submitted",
+        it->sequence, (time - it->stageMicros[STAGE_SUBMITTED]) / 1000.0);
+    mInFlight.erase(it);
+}
+
+void ofxSonyCameraShotTracer::abandonAll() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (Shot& shot : mInFlight) {
+        shot.abandoned = true;
+        finish(shot);
+    }
+    mInFlight.clear();
+}
+
+std::vector<ofxSonyCameraShotTracer::Shot> ofxSonyCameraShotTracer::getShots() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return std::vector<Shot>(mFinished.begin(), mFinished.end());
+}
+
+size_t ofxSonyCameraShotTracer::getNumInFlight() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mInFlight.size();
+}
+
+ofxSonyCameraShotTracer::StageStats ofxSonyCameraShotTracer::getStageStats(Stage stage) const {
+    std::vector<uint64_t> micros;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        micros.reserve(mFinished.size());
+        for (const Shot& shot : mFinished) {
+            if (stage == STAGE_SUBMITTED || !shot.reached(stage)) {
+                continue;
+            }
+            micros.push_back(shot.stageMicros[stage] - shot.stageMicros[getPreviousStage(shot, stage)]);
+        }
+    }
+    return computeStats(micros);
+}
+
+ofxSonyCameraShotTracer::StageStats ofxSonyCameraShotTracer::getTotalStats() const {
+    std::vector<uint64_t> micros;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        micros.reserve(mFinished.size());
+        for (const Shot& shot : mFinished) {
+            if (shot.reached(STAGE_DOWNLOADED)) {
+                micros.push_back(shot.stageMicros[STAGE_DOWNLOADED] - shot.stageMicros[STAGE_SUBMITTED]);
+            }
+        }
+    }
+    return computeStats(micros);
+}
+
+ofxSonyCameraShotTracer::StageStats ofxSonyCameraShotTracer::getShutterLagStats(int mode) const {
+    std::vector<uint64_t> micros;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        micros.reserve(mFinished.size());
+        for (const Shot& shot : mFinished) {
+            if (shot.mode != mode || !shot.reached(STAGE_SENT)) {
+                continue;
+            }
+            // The earliest notification, whichever stage it was matched to
+            uint64_t first = 0;
+            for (Stage stage : { STAGE_CAPTURED, STAGE_TRANSFER_NOTIFIED, STAGE_DOWNLOADED }) {
+                if (shot.reached(stage) && (first == 0 || shot.stageMicros[stage] < first)) {
+                    first = shot.stageMicros[stage];
+                }
+            }
+            if (first >= shot.stageMicros[STAGE_SENT]) {
+                micros.push_back(first - shot.stageMicros[STAGE_SENT]);
+            }
+        }
+    }
+    return computeStats(micros);
+}
+
+void ofxSonyCameraShotTracer::reset() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mInFlight.clear();
+    mFinished.clear();
+}
+
+bool ofxSonyCameraShotTracer::writeChromeTrace(const std::string& path, const std::string& label) const {
+    std::vector<Shot> shots = getShots();
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":";
+    appendJsonString(json, label.empty() ? "ofxSonyCameraRemote" : label);
+    json += "}}";
+
+    for (const Shot& shot : shots) {
+        char name[64];
+        snprintf(name, sizeof(name), "shot %" PRIu64 "%s", shot.sequence,
+            shot.failed ? " (failed)" : shot.abandoned ? " (abandoned)" : "");
+
+        // The row, then a span for the whole capture and one per stage reached
+        char event[160];
+        snprintf(event, sizeof(event), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu64 ",\"args\":{\"name\":\"%s\"}}",
+            shot.sequence, name);
+        json += event;
+
+        uint64_t end = *std::max_element(shot.stageMicros, shot.stageMicros + STAGE_COUNT);
+        appendSpan(json, "shot", "shot", shot.sequence, shot.stageMicros[STAGE_SUBMITTED], end);
+        json += ",\"args\":{\"mode\":" + std::to_string(shot.mode) + ",\"filename\":";
+        appendJsonString(json, shot.filename);
+        json += "}}";
+
+        for (int stage = STAGE_SENT; stage < STAGE_COUNT; stage++) {
+            if (shot.reached(static_cast<Stage>(stage))) {
+                appendSpan(json, getStageName(static_cast<Stage>(stage)), "stage", shot.sequence,
+                    shot.stageMicros[getPreviousStage(shot, static_cast<Stage>(stage))], shot.stageMicros[stage]);
+                json += "}";
+            }
+        }
+    }
+    json += "\n]}\n";
+
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraShotTracer", "Cannot write {}", path);
+        return false;
+    }
+    bool written = fwrite(json.data(), 1, json.size(), file) == json.size();
+    if (fclose(file) != 0 || !written) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraShotTracer", "Cannot write {}", path);
+        return false;
+    }
+    return true;
+}
+
+const char* ofxSonyCameraShotTracer::getStageName(Stage stage) {
+    switch (stage) {
+        case STAGE_SUBMITTED: return "submitted";
+        case STAGE_SENT: return "sent";
+        case STAGE_RETURNED: return "returned";
+        case STAGE_CAPTURED: return "captured";
+        case STAGE_TRANSFER_NOTIFIED: return "transfer notified";
+        case STAGE_DOWNLOADED: return "downloaded";
+        default: return "unknown";
+    }
+}
+
+uint64_t ofxSonyCameraShotTracer::now() const {
+    // 0 means a stage wasn't reached
+    return std::max<uint64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - mStart).count());
+}
+
+ofxSonyCameraShotTracer::Shot* ofxSonyCameraShotTracer::findShot(uint64_t sequence) {
+    for (Shot& shot : mInFlight) {
+        if (shot.sequence == sequence) {
+            return &shot;
+        }
+    }
+    for (auto it = mFinished.rbegin(); it != mFinished.rend(); ++it) {
+        if (it->sequence == sequence) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+std::deque<ofxSonyCameraShotTracer::Shot>::iterator ofxSonyCameraShotTracer::findFirstSent(Stage stage) {
+    // By when it was sent: releaseShutter() sends on the caller's thread,
+    // possibly ahead of captures queued earlier on the command thread
+    auto first = mInFlight.end();
+    for (auto it = mInFlight.begin(); it != mInFlight.end(); ++it) {
+        if (it->reached(STAGE_SENT) && !it->reached(stage)
+            && (first == mInFlight.end() || it->stageMicros[STAGE_SENT] < first->stageMicros[STAGE_SENT])) {
+            first = it;
+        }
+    }
+    return first;
+}
+
+ofxSonyCameraShotTracer::Stage ofxSonyCameraShotTracer::getPreviousStage(const Shot& shot, Stage stage) {
+    // The latest stage reached before this one, in time rather than in order:
+    // the camera may notify before SendCommand returns
+    int previous = STAGE_SUBMITTED;
+    for (int i = STAGE_SENT; i < STAGE_COUNT; i++) {
+        if (i != stage && shot.reached(static_cast<Stage>(i)) && shot.stageMicros[i] <= shot.stageMicros[stage]
+            && shot.stageMicros[i] >= shot.stageMicros[previous]) {
+            previous = i;
+        }
+    }
+    return static_cast<Stage>(previous);
+}
+
+void ofxSonyCameraShotTracer::finish(Shot& shot) {
+    mFinished.push_back(shot);
+    if (mFinished.size() > kWindow) {
+        mFinished.pop_front();
+    }
+}
+
+ofxSonyCameraShotTracer::StageStats ofxSonyCameraShotTracer::computeStats(std::vector<uint64_t>& micros) {
+    StageStats stats;
+    if (micros.empty()) {
+        return stats;
+    }
+    std::sort(micros.begin(), micros.end());
+    auto percentile = [&micros](double fraction) {
+        size_t rank = static_cast<size_t>(fraction * micros.size() + 0.5);
+        return static_cast<double>(micros[std::min(micros.size() - 1, rank > 0 ? rank - 1 : 0)]);
+    };
+    stats.count = micros.size();
+    stats.p50Micros = percentile(0.50);
+    stats.p90Micros = percentile(0.90);
+    stats.p99Micros = percentile(0.99);
+    stats.maxMicros = static_cast<double>(micros.back());
+    return stats;
+}
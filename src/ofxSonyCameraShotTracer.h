@@ -0,0 +1,179 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Shutter-to-file latency of each capture, stage by stage
+ *
+ * Every capture gets a sequence number when it is requested, and each stage
+ * it passes through is timestamped:
+ *
+ * - submitted: capturePhoto() was called
+ * - sent: the command thread started SendCommand
+ * - returned: SendCommand returned
+ * - captured: the camera's first notification after the release, usually the
+ *   property change that comes with a new picture
+ * - transfer notified: OnNotifyContentsTransfer, if the camera sends it
+ * - downloaded: OnCompleteDownload
+ *
+ * The camera doesn't say which capture a notification belongs to, so they
+ * are matched in order: each goes to the capture sent first among those in
+ * flight that haven't reached that stage yet. The last kWindow finished captures are
+ * kept, for percentiles of the time spent reaching each stage and for a
+ * Chrome trace-event export (chrome://tracing or ui.perfetto.dev).
+ *
+ * Thread-safe: stages are reported from the caller's, the command and the
+ * SDK's threads.
+ */
+class ofxSonyCameraShotTracer {
+public:
+    enum Stage {
+        STAGE_SUBMITTED,
+        STAGE_SENT,
+        STAGE_RETURNED,
+        STAGE_CAPTURED,
+        STAGE_TRANSFER_NOTIFIED,
+        STAGE_DOWNLOADED,
+        STAGE_COUNT
+    };
+
+    /**
+     * @brief One capture, from request to file
+     */
+    struct Shot {
+        uint64_t sequence = 0;
+        uint64_t stageMicros[STAGE_COUNT] = {}; // since the tracer started; 0 if not reached
+        int mode = 0;            // how the shutter was pressed, as the caller numbers it
+        bool failed = false;     // SendCommand returned an error
+        bool abandoned = false;  // never downloaded: the connection dropped, or too many in flight
+        std::string filename;
+
+        bool reached(Stage stage) const { return stageMicros[stage] != 0; }
+    };
+
+    /**
+     * @brief Percentiles of the time to reach one stage from the one before
+     *
+     * Each stage counts from the latest stage the shot reached before it in
+     * time, so skipped stages are left out and notifications arriving before
+     * SendCommand returned don't count negative.
+     */
+    struct StageStats {
+        uint64_t count = 0;
+        double p50Micros = 0;
+        double p90Micros = 0;
+        double p99Micros = 0;
+        double maxMicros = 0;
+    };
+
+    static constexpr size_t kWindow = 256;   // finished shots kept for statistics
+    static constexpr size_t kMaxInFlight = 64; // older ones are abandoned
+
+    ofxSonyCameraShotTracer();
+
+    /**
+     * @brief Start tracing a capture at STAGE_SUBMITTED
+     *
+     * @return Its sequence number, starting at 1
+     */
+    uint64_t begin();
+
+    /**
+     * @brief Record a stage of a capture known by its sequence number
+     */
+    void mark(uint64_t sequence, Stage stage);
+
+    /**
+     * @brief Tag a capture with how the shutter was pressed, for getShutterLagStats()
+     */
+    void setMode(uint64_t sequence, int mode);
+
+    /**
+     * @brief Record that SendCommand returned
+     *
+     * @param failed Whether it returned an error; the capture then ends
+     */
+    void markReturned(uint64_t sequence, bool failed);
+
+    /**
+     * @brief Record a camera notification for the first sent capture still waiting for it
+     */
+    void markNext(Stage stage);
+
+    /**
+     * @brief Record a finished download, ending the first sent capture waiting for one
+     */
+    void markDownloaded(const std::string& filename);
+
+    /**
+     * @brief End every capture in flight, e.g. when the connection is lost
+     */
+    void abandonAll();
+
+    /**
+     * @brief Get the finished captures, in the order they finished
+     */
+    std::vector<Shot> getShots() const;
+
+    /**
+     * @brief Get the number of captures sent but not downloaded yet
+     */
+    size_t getNumInFlight() const;
+
+    /**
+     * @brief Get the percentiles of the time to reach a stage, over the recent window
+     */
+    StageStats getStageStats(Stage stage) const;
+
+    /**
+     * @brief Get the percentiles of the time from submitted to downloaded
+     */
+    StageStats getTotalStats() const;
+
+    /**
+     * @brief Get the percentiles of the shutter lag of captures in one mode
+     *
+     * From sent to the camera's first notification about the capture,
+     * whether it was matched as captured, transfer notified or downloaded.
+     */
+    StageStats getShutterLagStats(int mode) const;
+
+    /**
+     * @brief Forget all captures, finished or not
+     */
+    void reset();
+
+    /**
+     * @brief Write the finished captures as Chrome trace events
+     *
+     * Each capture is one row, named after its sequence number, with a span
+     * for the whole capture and one for each stage it reached.
+     *
+     * @param path The JSON file to write
+     * @param label Process name shown for these captures, e.g. the camera's serial number
+     * @return true if the file was written, false otherwise
+     */
+    bool writeChromeTrace(const std::string& path, const std::string& label = "") const;
+
+    static const char* getStageName(Stage stage);
+
+private:
+    uint64_t now() const;
+    Shot* findShot(uint64_t sequence);
+    std::deque<Shot>::iterator findFirstSent(Stage stage);
+    void finish(Shot& shot);
+    static Stage getPreviousStage(const Shot& shot, Stage stage);
+    static StageStats computeStats(std::vector<uint64_t>& micros);
+
+    std::chrono::steady_clock::time_point mStart;
+    uint64_t mNextSequence;
+    std::deque<Shot> mInFlight; // in sequence order
+    std::deque<Shot> mFinished;
+    mutable std::mutex mMutex;
+};
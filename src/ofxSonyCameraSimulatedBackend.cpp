@@ -0,0 +1,556 @@
+#include "ofxSonyCameraSimulatedBackend.h"
+#include "ofxSonyCameraPropertyTraits.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // The 99th percentile of a standard normal distribution
+    const double kNormalP99 = 2.3263478740;
+
+    // Exposure and focus values as the SDK encodes them
+    const CrInt64u kExposureManual = 0x00000001;
+    const CrInt64u kExposureProgram = 0x00010002;
+    const CrInt64u kExposureAperture = 0x00020003;
+    const CrInt64u kExposureShutter = 0x00030004;
+    const CrInt64u kWhiteBalanceAuto = 0x0000;
+    const CrInt64u kWhiteBalanceDaylight = 0x0011;
+    const CrInt64u kWhiteBalanceShade = 0x0012;
+    const CrInt64u kWhiteBalanceCloudy = 0x0013;
+    const CrInt64u kWhiteBalanceTungsten = 0x0014;
+    const CrInt64u kFocusManual = 0x0001;
+    const CrInt64u kFocusSingle = 0x0002;
+    const CrInt64u kFocusContinuous = 0x0003;
+
+    CrInt64u shutterSpeed(CrInt64u numerator, CrInt64u denominator) {
+        return (numerator << 16) | denominator;
+    }
+}
+
+ofxSonyCameraSimulatedBackend::ofxSonyCameraSimulatedBackend()
+    : ofxSonyCameraSimulatedBackend(Settings()) {
+}
+
+ofxSonyCameraSimulatedBackend::ofxSonyCameraSimulatedBackend(const Settings& settings)
+    : mSettings(settings)
+    , mNextHandle(1)
+    , mRandom(settings.seed)
+    , mNextOrder(0)
+    , mRunning(true) {
+    mThread = std::thread(&ofxSonyCameraSimulatedBackend::threadedFunction, this);
+}
+
+ofxSonyCameraSimulatedBackend::~ofxSonyCameraSimulatedBackend() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRunning = false;
+    }
+    mCondition.notify_all();
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+ofxSonyCameraSimulatedBackend::Property ofxSonyCameraSimulatedBackend::makeProperty(CrInt32u code, CrInt64u value, const std::vector<CrInt64u>& possible) {
+    Property property;
+    property.code = code;
+    property.value = value;
+    property.possible = possible;
+
+    const ofxSonyCameraProperty::Info* info = ofxSonyCameraProperty::find(code);
+    if (info) {
+        property.type = info->type;
+        property.writable = !info->readOnly;
+    }
+    return property;
+}
+
+ofxSonyCameraSimulatedBackend::Camera ofxSonyCameraSimulatedBackend::makeCamera(const std::string& id, const std::string& model) {
+    Camera camera;
+    camera.model = model;
+    camera.id = id;
+    camera.properties = {
+        makeProperty(SCRSDK::CrDeviceProperty_FNumber, 400, { 280, 400, 560, 800, 1100, 1600 }),
+        makeProperty(SCRSDK::CrDeviceProperty_ShutterSpeed, shutterSpeed(1, 125), {
+            shutterSpeed(1, 30), shutterSpeed(1, 60), shutterSpeed(1, 125),
+            shutterSpeed(1, 250), shutterSpeed(1, 500), shutterSpeed(1, 1000) }),
+        makeProperty(SCRSDK::CrDeviceProperty_IsoSensitivity, 100, { 100, 200, 400, 800, 1600, 3200, 6400 }),
+        makeProperty(SCRSDK::CrDeviceProperty_ExposureProgramMode, kExposureManual, {
+            kExposureManual, kExposureProgram, kExposureAperture, kExposureShutter }),
+        makeProperty(SCRSDK::CrDeviceProperty_WhiteBalance, kWhiteBalanceAuto, {
+            kWhiteBalanceAuto, kWhiteBalanceDaylight, kWhiteBalanceShade, kWhiteBalanceCloudy, kWhiteBalanceTungsten }),
+        makeProperty(SCRSDK::CrDeviceProperty_FocusMode, kFocusSingle, { kFocusManual, kFocusSingle, kFocusContinuous }),
+        makeProperty(SCRSDK::CrDeviceProperty_Colortemp, 5500),
+        makeProperty(SCRSDK::CrDeviceProperty_RecordingState, 0),
+        makeProperty(SCRSDK::CrDeviceProperty_LiveViewStatus, 1),
+        makeProperty(SCRSDK::CrDeviceProperty_BatteryRemain, 80)
+    };
+    return camera;
+}
+
+void ofxSonyCameraSimulatedBackend::addCamera(const Camera& camera) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCameras[camera.id] = camera;
+    mOfflineUntil.erase(camera.id);
+}
+
+void ofxSonyCameraSimulatedBackend::removeCamera(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    dropConnections(id, SCRSDK::CrError_Connect);
+    mCameras.erase(id);
+    mOfflineUntil.erase(id);
+}
+
+void ofxSonyCameraSimulatedBackend::setLatency(ofxSonyCameraMetrics::Call call, const Latency& latency) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCalls[call].latency = latency;
+}
+
+void ofxSonyCameraSimulatedBackend::setFailureRate(ofxSonyCameraMetrics::Call call, double probability, SCRSDK::CrError error) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCalls[call].failureRate = probability;
+    mCalls[call].failureError = error;
+}
+
+void ofxSonyCameraSimulatedBackend::failNext(ofxSonyCameraMetrics::Call call, SCRSDK::CrError error, int count) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCalls[call].failNextCount = count;
+    mCalls[call].failNextError = error;
+}
+
+void ofxSonyCameraSimulatedBackend::injectDisconnect(const std::string& id, CrInt32u error, std::chrono::milliseconds offline) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mCameras.find(id) == mCameras.end()) {
+        return;
+    }
+    mOfflineUntil[id] = std::chrono::steady_clock::now() + offline;
+    mStats.injectedDisconnects++;
+    dropConnections(id, error);
+}
+
+void ofxSonyCameraSimulatedBackend::changeProperty(const std::string& id, CrInt32u code, CrInt64u value) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mCameras.find(id);
+    Property* property = it != mCameras.end() ? findProperty(it->second, code) : nullptr;
+    if (!property) {
+        return;
+    }
+    property->value = value;
+    notifyCamera(id, [code](SCRSDK::IDeviceCallback* callback) {
+        CrInt32u codes[] = { code };
+        callback->OnPropertyChangedCodes(1, codes);
+    });
+}
+
+bool ofxSonyCameraSimulatedBackend::getPropertyValue(const std::string& id, CrInt32u code, CrInt64u& value) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mCameras.find(id);
+    if (it == mCameras.end()) {
+        return false;
+    }
+    for (const Property& property : it->second.properties) {
+        if (property.code == code) {
+            value = property.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+ofxSonyCameraSimulatedBackend::Stats ofxSonyCameraSimulatedBackend::getStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+bool ofxSonyCameraSimulatedBackend::init() {
+    // Nothing to load; the cameras live as long as the backend
+    return true;
+}
+
+void ofxSonyCameraSimulatedBackend::release() {
+}
+
+CrInt32u ofxSonyCameraSimulatedBackend::getSdkVersion() {
+    return kSdkVersion;
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::enumerate(std::vector<CameraInfo>& cameras) {
+    cameras.clear();
+    SCRSDK::CrError err = simulateCall(ofxSonyCameraMetrics::CALL_ENUM_CAMERA_OBJECTS);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& entry : mCameras) {
+        auto offline = mOfflineUntil.find(entry.first);
+        if (offline != mOfflineUntil.end() && now < offline->second) {
+            continue;
+        }
+
+        CameraInfo camera;
+        camera.model = entry.second.model;
+        camera.id = entry.second.id;
+        camera.handle = std::make_shared<std::string>(entry.second.id);
+        cameras.push_back(camera);
+    }
+
+    // Like the SDK, finding nothing is an error
+    return cameras.empty() ? SCRSDK::CrError_Adaptor_EnumDevice : SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) {
+    if (!callback || !deviceHandle) {
+        return SCRSDK::CrError_Generic_InvalidParameter;
+    }
+
+    SCRSDK::CrError err = simulateCall(ofxSonyCameraMetrics::CALL_CONNECT);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto offline = mOfflineUntil.find(camera.id);
+    if (mCameras.find(camera.id) == mCameras.end() ||
+        (offline != mOfflineUntil.end() && std::chrono::steady_clock::now() < offline->second)) {
+        return SCRSDK::CrError_Connect;
+    }
+
+    // A body takes one remote connection at a time
+    for (const auto& entry : mDevices) {
+        if (entry.second.id == camera.id && entry.second.connected) {
+            return SCRSDK::CrError_Connect_FailBusy;
+        }
+    }
+
+    SCRSDK::CrDeviceHandle handle = mNextHandle++;
+    Device& device = mDevices[handle];
+    device.id = camera.id;
+    device.callback = callback;
+    device.connected = true;
+    *deviceHandle = handle;
+
+    notify(handle, 0, [](SCRSDK::IDeviceCallback* callback) {
+        callback->OnConnected(0);
+    });
+    return SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::disconnect(SCRSDK::CrDeviceHandle deviceHandle) {
+    SCRSDK::CrError err = simulateCall(ofxSonyCameraMetrics::CALL_DISCONNECT);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mDevices.find(deviceHandle);
+    if (it == mDevices.end() || !it->second.connected) {
+        return SCRSDK::CrError_Connect;
+    }
+    it->second.connected = false;
+    notify(deviceHandle, 0, [](SCRSDK::IDeviceCallback* callback) {
+        callback->OnDisconnected(0);
+    });
+    return SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mDevices.erase(deviceHandle) == 0) {
+            return SCRSDK::CrError_Generic_InvalidParameter;
+        }
+    }
+
+    // Wait for a notification already being delivered to this connection;
+    // from the callback thread itself there is none
+    if (std::this_thread::get_id() != mThread.get_id()) {
+        std::lock_guard<std::mutex> delivery(mDeliveryMutex);
+    }
+    return SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) {
+    SCRSDK::CrError err = simulateCall(ofxSonyCameraMetrics::CALL_SEND_COMMAND);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    Camera* camera = nullptr;
+    err = findConnected(deviceHandle, camera);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    if (commandId != SCRSDK::CrCommandId_Release) {
+        return SCRSDK::CrError_None;
+    }
+
+    // Pressing the shutter produces a file, delivered once the capture is
+    // done; it fires once focused, at once if the half-press has focused
+    Device& device = mDevices[deviceHandle];
+    auto now = std::chrono::steady_clock::now();
+    if (commandParam == SCRSDK::CrCommandParam_Down) {
+        if (!device.pressed) {
+            device.pressed = true;
+            device.firstFrameAt = device.halfPressed ? std::max(now, device.focusedAt)
+                                                     : now + std::chrono::microseconds(mSettings.focusMicros);
+            captureFrame(deviceHandle, device.firstFrameAt);
+        }
+    } else if (device.pressed) {
+        // Held long enough for a burst: the frames fired while it was down
+        device.pressed = false;
+        if (mSettings.burstIntervalMicros > 0) {
+            std::chrono::microseconds interval(mSettings.burstIntervalMicros);
+            for (auto at = device.firstFrameAt + interval; at < now; at += interval) {
+                captureFrame(deviceHandle, at);
+            }
+        }
+    }
+    return SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) {
+    SCRSDK::CrError err = simulateCall(ofxSonyCameraMetrics::CALL_GET_DEVICE_PROPERTIES);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    Camera* camera = nullptr;
+    err = findConnected(deviceHandle, camera);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    properties = camera->properties;
+    return SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) {
+    SCRSDK::CrError err = simulateCall(ofxSonyCameraMetrics::CALL_GET_SELECT_DEVICE_PROPERTIES);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+    if (numOfCodes > 0 && !codes) {
+        return SCRSDK::CrError_Generic_InvalidParameter;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    Camera* camera = nullptr;
+    err = findConnected(deviceHandle, camera);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    // Codes the camera doesn't have are left out, as the SDK does
+    properties.clear();
+    for (CrInt32u i = 0; i < numOfCodes; i++) {
+        const Property* property = findProperty(*camera, codes[i]);
+        if (property) {
+            properties.push_back(*property);
+        }
+    }
+    return SCRSDK::CrError_None;
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) {
+    SCRSDK::CrError err = simulateCall(ofxSonyCameraMetrics::CALL_SET_DEVICE_PROPERTY);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    Camera* camera = nullptr;
+    err = findConnected(deviceHandle, camera);
+    if (err != SCRSDK::CrError_None) {
+        return err;
+    }
+
+    // The half-press is a button rather than a property: it focuses, and
+    // the focus holds until it is let go
+    CrInt32u code = property.code;
+    if (code == SCRSDK::CrDeviceProperty_S1) {
+        Device& device = mDevices[deviceHandle];
+        device.halfPressed = property.value == SCRSDK::CrLockIndicator_Locked;
+        device.focusedAt = std::chrono::steady_clock::now() + std::chrono::microseconds(mSettings.focusMicros);
+        return SCRSDK::CrError_None;
+    }
+
+    Property* target = findProperty(*camera, code);
+    if (!target || !target->writable) {
+        return SCRSDK::CrError_Generic_InvalidParameter;
+    }
+
+    // The camera takes a while to apply the value, then reports the change;
+    // values it doesn't offer are ignored without a notification
+    CrInt64u value = property.value;
+    std::string id = camera->id;
+    notify(deviceHandle, mSettings.propertyApplyMicros, [this, id, code, value](SCRSDK::IDeviceCallback* callback) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mCameras.find(id);
+            Property* target = it != mCameras.end() ? findProperty(it->second, code) : nullptr;
+            if (!target || (!target->possible.empty() &&
+                            std::find(target->possible.begin(), target->possible.end(), value) == target->possible.end())) {
+                return;
+            }
+            target->value = value;
+        }
+        CrInt32u codes[] = { code };
+        callback->OnPropertyChangedCodes(1, codes);
+    });
+    return SCRSDK::CrError_None;
+}
+
+std::unique_ptr<ofxSonyCameraLiveViewSource> ofxSonyCameraSimulatedBackend::createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    Camera* camera = nullptr;
+    if (findConnected(deviceHandle, camera) != SCRSDK::CrError_None || mSettings.liveViewFrames.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<ofxSonyCameraSyntheticLiveViewSource>(mSettings.liveViewFrames, mSettings.liveViewFps);
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::simulateCall(ofxSonyCameraMetrics::Call call) {
+    SCRSDK::CrError err = SCRSDK::CrError_None;
+    uint64_t latencyMicros = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        CallBehavior& behavior = mCalls[call];
+        mStats.calls++;
+
+        // Log-normal around the median, with the spread set by the 99th percentile
+        if (behavior.latency.medianMicros > 0) {
+            double sigma = 0;
+            if (behavior.latency.p99Micros > behavior.latency.medianMicros) {
+                sigma = std::log(double(behavior.latency.p99Micros) / behavior.latency.medianMicros) / kNormalP99;
+            }
+            std::lognormal_distribution<double> distribution(std::log(double(behavior.latency.medianMicros)), sigma);
+            latencyMicros = static_cast<uint64_t>(distribution(mRandom));
+        }
+
+        if (behavior.failNextCount > 0) {
+            behavior.failNextCount--;
+            err = behavior.failNextError;
+        } else if (behavior.failureRate > 0 && std::uniform_real_distribution<double>(0, 1)(mRandom) < behavior.failureRate) {
+            err = behavior.failureError;
+        }
+        if (err != SCRSDK::CrError_None) {
+            mStats.injectedErrors++;
+        }
+    }
+
+    if (latencyMicros > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(latencyMicros));
+    }
+    return err;
+}
+
+SCRSDK::CrError ofxSonyCameraSimulatedBackend::findConnected(SCRSDK::CrDeviceHandle deviceHandle, Camera*& camera) {
+    auto device = mDevices.find(deviceHandle);
+    if (device == mDevices.end() || !device->second.connected) {
+        return SCRSDK::CrError_Connect;
+    }
+    auto it = mCameras.find(device->second.id);
+    if (it == mCameras.end()) {
+        return SCRSDK::CrError_Connect;
+    }
+    camera = &it->second;
+    return SCRSDK::CrError_None;
+}
+
+ofxSonyCameraSimulatedBackend::Property* ofxSonyCameraSimulatedBackend::findProperty(Camera& camera, CrInt32u code) {
+    for (Property& property : camera.properties) {
+        if (property.code == code) {
+            return &property;
+        }
+    }
+    return nullptr;
+}
+
+void ofxSonyCameraSimulatedBackend::notify(SCRSDK::CrDeviceHandle handle, uint64_t delayMicros, std::function<void(SCRSDK::IDeviceCallback*)> deliver) {
+    // Called with mMutex held
+    Notification notification;
+    notification.due = std::chrono::steady_clock::now() + std::chrono::microseconds(delayMicros);
+    notification.order = mNextOrder++;
+    notification.handle = handle;
+    notification.deliver = deliver;
+    mNotifications.push(notification);
+    mCondition.notify_all();
+}
+
+void ofxSonyCameraSimulatedBackend::captureFrame(SCRSDK::CrDeviceHandle handle, std::chrono::steady_clock::time_point at) {
+    // Called with mMutex held
+    char filename[32];
+    snprintf(filename, sizeof(filename), "DSC%05llu.JPG", static_cast<unsigned long long>(++mStats.captures));
+    std::string name = filename;
+    auto delay = std::chrono::duration_cast<std::chrono::microseconds>(at - std::chrono::steady_clock::now());
+    notify(handle, std::max<int64_t>(0, delay.count()) + mSettings.captureMicros, [name](SCRSDK::IDeviceCallback* callback) {
+        std::string copy = name;
+        callback->OnCompleteDownload(&copy[0], 0);
+    });
+}
+
+void ofxSonyCameraSimulatedBackend::notifyCamera(const std::string& id, std::function<void(SCRSDK::IDeviceCallback*)> deliver) {
+    // Called with mMutex held
+    for (const auto& entry : mDevices) {
+        if (entry.second.id == id && entry.second.connected) {
+            notify(entry.first, 0, deliver);
+        }
+    }
+}
+
+void ofxSonyCameraSimulatedBackend::dropConnections(const std::string& id, CrInt32u error) {
+    // Called with mMutex held
+    notifyCamera(id, [error](SCRSDK::IDeviceCallback* callback) {
+        callback->OnDisconnected(error);
+    });
+    for (auto& entry : mDevices) {
+        if (entry.second.id == id) {
+            entry.second.connected = false;
+        }
+    }
+}
+
+void ofxSonyCameraSimulatedBackend::threadedFunction() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mRunning) {
+        if (mNotifications.empty()) {
+            mCondition.wait(lock);
+            continue;
+        }
+        // A copy: the heap may grow, and move its entries, during the wait
+        std::chrono::steady_clock::time_point due = mNotifications.top().due;
+        if (std::chrono::steady_clock::now() < due) {
+            mCondition.wait_until(lock, due);
+            continue;
+        }
+
+        Notification notification = mNotifications.top();
+        mNotifications.pop();
+        lock.unlock();
+
+        // Look the connection up under the delivery lock, so a released
+        // connection's callback is never called
+        {
+            std::lock_guard<std::mutex> delivery(mDeliveryMutex);
+            SCRSDK::IDeviceCallback* callback = nullptr;
+            {
+                std::lock_guard<std::mutex> lookup(mMutex);
+                auto it = mDevices.find(notification.handle);
+                if (it != mDevices.end()) {
+                    callback = it->second.callback;
+                    mStats.callbacks++;
+                }
+            }
+            if (callback) {
+                notification.deliver(callback);
+            }
+        }
+
+        lock.lock();
+    }
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxSonyCameraBackend.h"
+#include "ofxSonyCameraMetrics.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+
+/**
+ * @brief Backend simulating cameras without hardware
+ *
+ * Each simulated camera has its own property set. Calls take a log-normal
+ * latency per call type and can fail at a configurable rate or on demand.
+ * Like the real SDK, notifications arrive on a thread of their own:
+ * OnConnected after connecting, OnPropertyChangedCodes once a written value
+ * has been applied, OnCompleteDownload some time after the shutter is
+ * released and OnDisconnected when a disconnect is injected. The shutter
+ * focuses before it fires unless it is held half-pressed through
+ * CrDeviceProperty_S1, and keeps firing while held down if bursts are on.
+ *
+ * Lets ofxSonyCameraRemote and ofxSonyCameraRig run, and their hot paths be
+ * benchmarked, on a machine with no camera attached.
+ */
+class ofxSonyCameraSimulatedBackend : public ofxSonyCameraBackend {
+public:
+    struct Camera {
+        std::string model;
+        std::string id;
+        std::vector<Property> properties;
+    };
+
+    /**
+     * @brief Log-normal latency of one call type
+     */
+    struct Latency {
+        uint64_t medianMicros = 0;
+        uint64_t p99Micros = 0; // at or below the median for a fixed latency
+    };
+
+    struct Settings {
+        uint64_t propertyApplyMicros = 20000; // SetDeviceProperty until the value changes and is notified
+        uint64_t focusMicros = 100000;        // autofocus, on half-press or on a release without it
+        uint64_t captureMicros = 200000;      // shutter release, once focused, until OnCompleteDownload
+        uint64_t burstIntervalMicros = 0;     // between frames while the shutter is held; 0 for single shots
+        std::vector<ofBuffer> liveViewFrames; // JPEG frames for live view; none disables it
+        double liveViewFps = 30.0;
+        uint32_t seed = 1;                    // for latencies and random failures
+    };
+
+    struct Stats {
+        uint64_t calls = 0;
+        uint64_t injectedErrors = 0;
+        uint64_t injectedDisconnects = 0;
+        uint64_t callbacks = 0; // notifications delivered
+        uint64_t captures = 0;
+    };
+
+    ofxSonyCameraSimulatedBackend();
+    explicit ofxSonyCameraSimulatedBackend(const Settings& settings);
+    ~ofxSonyCameraSimulatedBackend();
+
+    /**
+     * @brief Describe a property, with its type and writability from ofxSonyCameraProperty
+     */
+    static Property makeProperty(CrInt32u code, CrInt64u value, const std::vector<CrInt64u>& possible = {});
+
+    /**
+     * @brief Describe a camera with a typical set of exposure, focus and status properties
+     */
+    static Camera makeCamera(const std::string& id, const std::string& model = "ILCE-7M4");
+
+    /**
+     * @brief Plug in a camera; it shows up in the next enumeration
+     */
+    void addCamera(const Camera& camera);
+
+    /**
+     * @brief Unplug a camera, dropping its connection
+     */
+    void removeCamera(const std::string& id);
+
+    void setLatency(ofxSonyCameraMetrics::Call call, const Latency& latency);
+
+    /**
+     * @brief Fail a share of the calls of one type
+     *
+     * @param call The call type
+     * @param probability The share of calls to fail, 0 to 1
+     * @param error The error they return
+     */
+    void setFailureRate(ofxSonyCameraMetrics::Call call, double probability, SCRSDK::CrError error);
+
+    /**
+     * @brief Fail the next calls of one type
+     */
+    void failNext(ofxSonyCameraMetrics::Call call, SCRSDK::CrError error, int count = 1);
+
+    /**
+     * @brief Drop a camera's connection as if its cable was pulled
+     *
+     * @param id The camera
+     * @param error The reason passed to OnDisconnected
+     * @param offline How long the camera stays out of enumerations and refuses connections
+     */
+    void injectDisconnect(const std::string& id, CrInt32u error, std::chrono::milliseconds offline);
+
+    /**
+     * @brief Change a value on the camera side, as a turned dial would
+     */
+    void changeProperty(const std::string& id, CrInt32u code, CrInt64u value);
+
+    /**
+     * @brief Read a value as the camera currently holds it
+     */
+    bool getPropertyValue(const std::string& id, CrInt32u code, CrInt64u& value) const;
+
+    Stats getStats() const;
+
+    // ofxSonyCameraBackend
+    bool init() override;
+    void release() override;
+    CrInt32u getSdkVersion() override;
+    SCRSDK::CrError enumerate(std::vector<CameraInfo>& cameras) override;
+    SCRSDK::CrError connect(const CameraInfo& camera, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle) override;
+    SCRSDK::CrError disconnect(SCRSDK::CrDeviceHandle deviceHandle) override;
+    SCRSDK::CrError releaseDevice(SCRSDK::CrDeviceHandle deviceHandle) override;
+    SCRSDK::CrError sendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam) override;
+    SCRSDK::CrError getDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, std::vector<Property>& properties) override;
+    SCRSDK::CrError getSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, std::vector<Property>& properties) override;
+    SCRSDK::CrError setDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, const Property& property) override;
+    std::unique_ptr<ofxSonyCameraLiveViewSource> createLiveViewSource(SCRSDK::CrDeviceHandle deviceHandle) override;
+
+    static constexpr CrInt32u kSdkVersion = 0x01000000;
+
+private:
+    struct CallBehavior {
+        Latency latency;
+        double failureRate = 0;
+        SCRSDK::CrError failureError = SCRSDK::CrError_None;
+        int failNextCount = 0;
+        SCRSDK::CrError failNextError = SCRSDK::CrError_None;
+    };
+
+    struct Device {
+        std::string id;
+        SCRSDK::IDeviceCallback* callback = nullptr;
+        bool connected = false;
+        bool halfPressed = false;
+        bool pressed = false;
+        std::chrono::steady_clock::time_point focusedAt; // when the half-press has focused
+        std::chrono::steady_clock::time_point firstFrameAt; // of the current press
+    };
+
+    // A notification for one connection, delivered on the callback thread
+    struct Notification {
+        std::chrono::steady_clock::time_point due;
+        uint64_t order = 0; // keeps notifications due at the same time in order
+        SCRSDK::CrDeviceHandle handle = 0;
+        std::function<void(SCRSDK::IDeviceCallback*)> deliver;
+
+        bool operator>(const Notification& other) const {
+            return due != other.due ? due > other.due : order > other.order;
+        }
+    };
+
+    SCRSDK::CrError simulateCall(ofxSonyCameraMetrics::Call call);
+    SCRSDK::CrError findConnected(SCRSDK::CrDeviceHandle deviceHandle, Camera*& camera);
+    Property* findProperty(Camera& camera, CrInt32u code);
+    void notify(SCRSDK::CrDeviceHandle handle, uint64_t delayMicros, std::function<void(SCRSDK::IDeviceCallback*)> deliver);
+    void captureFrame(SCRSDK::CrDeviceHandle handle, std::chrono::steady_clock::time_point at);
+    void notifyCamera(const std::string& id, std::function<void(SCRSDK::IDeviceCallback*)> deliver);
+    void dropConnections(const std::string& id, CrInt32u error);
+    void threadedFunction();
+
+    Settings mSettings;
+    Stats mStats;
+
+    std::map<std::string, Camera> mCameras;
+    std::map<std::string, std::chrono::steady_clock::time_point> mOfflineUntil;
+    std::map<SCRSDK::CrDeviceHandle, Device> mDevices;
+    SCRSDK::CrDeviceHandle mNextHandle;
+    CallBehavior mCalls[ofxSonyCameraMetrics::CALL_COUNT];
+    std::mt19937 mRandom;
+    mutable std::mutex mMutex;
+
+    // Callback thread; mDeliveryMutex is held while a notification runs, so
+    // releaseDevice() can wait for the one in flight
+    std::priority_queue<Notification, std::vector<Notification>, std::greater<Notification>> mNotifications;
+    uint64_t mNextOrder;
+    std::mutex mDeliveryMutex;
+    std::condition_variable mCondition;
+    std::thread mThread;
+    bool mRunning;
+};
@@ -0,0 +1,226 @@
+#include "ofxSonyCameraSyncTrigger.h"
+#include "ofxSonyCameraLog.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    uint64_t nowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Spin this many times before yielding, so more cameras than cores still
+    // make progress
+    const int kSpinsBeforeYield = 1000;
+
+    template<typename Condition>
+    void spinUntil(Condition condition) {
+        int spins = 0;
+        while (!condition()) {
+            if (++spins > kSpinsBeforeYield) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    ofxSonyCameraSyncTrigger::SkewStats summarize(const std::deque<uint64_t>& skews) {
+        ofxSonyCameraSyncTrigger::SkewStats stats;
+        if (skews.empty()) {
+            return stats;
+        }
+
+        std::vector<uint64_t> sorted(skews.begin(), skews.end());
+        std::sort(sorted.begin(), sorted.end());
+
+        uint64_t total = 0;
+        for (uint64_t skew : sorted) {
+            total += skew;
+        }
+        stats.minMicros = sorted.front();
+        stats.maxMicros = sorted.back();
+        stats.avgMicros = total / sorted.size();
+        stats.p99Micros = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+        return stats;
+    }
+}
+
+ofxSonyCameraSyncTrigger::ofxSonyCameraSyncTrigger()
+    : mRunning(false)
+    , mArmed(false)
+    , mArmGeneration(0)
+    , mReleaseGeneration(0)
+    , mArrived(0)
+    , mDone(0)
+    , mShots(0)
+    , mFailedShots(0) {
+}
+
+ofxSonyCameraSyncTrigger::~ofxSonyCameraSyncTrigger() {
+    close();
+}
+
+bool ofxSonyCameraSyncTrigger::setup(const std::vector<ofxSonyCameraRemote*>& cameras) {
+    close();
+
+    if (cameras.empty() || std::find(cameras.begin(), cameras.end(), nullptr) != cameras.end()) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraSyncTrigger", "Cannot set up trigger: no cameras or null camera");
+        return false;
+    }
+
+    mCameras = cameras;
+    mTimings.assign(cameras.size(), CameraTiming());
+    mArmGeneration = 0;
+    mReleaseGeneration = 0;
+    mArmed = false;
+    mRunning = true;
+
+    for (size_t i = 0; i < mCameras.size(); i++) {
+        mThreads.emplace_back(&ofxSonyCameraSyncTrigger::threadedFunction, this, i);
+    }
+
+    OFX_SONY_CAMERA_LOG_NOTICE("ofxSonyCameraSyncTrigger", "Started {} trigger threads", mThreads.size());
+    return true;
+}
+
+void ofxSonyCameraSyncTrigger::close() {
+    {
+        std::lock_guard<std::mutex> lock(mArmMutex);
+        if (!mRunning) {
+            return;
+        }
+        mRunning = false;
+    }
+    mArmCondition.notify_all();
+
+    for (auto& thread : mThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    mThreads.clear();
+    mCameras.clear();
+    mArmed = false;
+}
+
+void ofxSonyCameraSyncTrigger::arm() {
+    if (mArmed || !mRunning) {
+        return;
+    }
+
+    mArrived = 0;
+    mDone = 0;
+    {
+        std::lock_guard<std::mutex> lock(mArmMutex);
+        mArmGeneration++;
+    }
+    mArmCondition.notify_all();
+
+    size_t count = mCameras.size();
+    spinUntil([this, count]() { return mArrived.load(std::memory_order_acquire) == count; });
+    mArmed = true;
+}
+
+bool ofxSonyCameraSyncTrigger::isArmed() const {
+    return mArmed;
+}
+
+ofxSonyCameraSyncTrigger::Shot ofxSonyCameraSyncTrigger::fire() {
+    Shot shot;
+    if (!mRunning) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraSyncTrigger", "Cannot fire: trigger not set up");
+        return shot;
+    }
+
+    arm();
+
+    // Open the barrier
+    mReleaseGeneration.store(mArmGeneration.load(), std::memory_order_release);
+
+    size_t count = mCameras.size();
+    spinUntil([this, count]() { return mDone.load(std::memory_order_acquire) == count; });
+    mArmed = false;
+
+    shot.cameras = mTimings;
+    uint64_t firstSend = UINT64_MAX, lastSend = 0;
+    uint64_t firstReturn = UINT64_MAX, lastReturn = 0;
+    for (const auto& timing : shot.cameras) {
+        firstSend = std::min(firstSend, timing.sendMicros);
+        lastSend = std::max(lastSend, timing.sendMicros);
+        firstReturn = std::min(firstReturn, timing.returnMicros);
+        lastReturn = std::max(lastReturn, timing.returnMicros);
+        if (timing.error != CrError_None) {
+            shot.failed++;
+        }
+    }
+    shot.sendSkewMicros = lastSend - firstSend;
+    shot.returnSkewMicros = lastReturn - firstReturn;
+
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    shot.shotNumber = ++mShots;
+    if (shot.failed > 0) {
+        mFailedShots++;
+    }
+    mSendSkews.push_back(shot.sendSkewMicros);
+    mReturnSkews.push_back(shot.returnSkewMicros);
+    if (mSendSkews.size() > kHistorySize) {
+        mSendSkews.pop_front();
+        mReturnSkews.pop_front();
+    }
+    return shot;
+}
+
+size_t ofxSonyCameraSyncTrigger::getNumCameras() const {
+    return mCameras.size();
+}
+
+ofxSonyCameraSyncTrigger::Stats ofxSonyCameraSyncTrigger::getStats() const {
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    Stats stats;
+    stats.shots = mShots;
+    stats.failedShots = mFailedShots;
+    stats.send = summarize(mSendSkews);
+    stats.returned = summarize(mReturnSkews);
+    return stats;
+}
+
+void ofxSonyCameraSyncTrigger::resetStats() {
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    mShots = 0;
+    mFailedShots = 0;
+    mSendSkews.clear();
+    mReturnSkews.clear();
+}
+
+void ofxSonyCameraSyncTrigger::threadedFunction(size_t index) {
+    ofxSonyCameraRemote* camera = mCameras[index];
+    uint64_t generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mArmMutex);
+            mArmCondition.wait(lock, [this, generation]() {
+                return !mRunning || mArmGeneration.load() != generation;
+            });
+            if (!mRunning) {
+                return;
+            }
+            generation = mArmGeneration.load();
+        }
+
+        // Armed: wait in the barrier without sleeping
+        mArrived.fetch_add(1, std::memory_order_release);
+        spinUntil([this, generation]() {
+            return mReleaseGeneration.load(std::memory_order_acquire) == generation || !mRunning;
+        });
+        if (!mRunning) {
+            return;
+        }
+
+        CameraTiming& timing = mTimings[index];
+        timing.sendMicros = nowMicros();
+        timing.error = camera->releaseShutter();
+        timing.returnMicros = nowMicros();
+
+        mDone.fetch_add(1, std::memory_order_release);
+    }
+}
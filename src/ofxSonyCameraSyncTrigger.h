@@ -0,0 +1,119 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxSonyCameraRemote.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+/**
+ * @brief Fires the shutter of several cameras as close together as possible
+ *
+ * Each camera gets its own trigger thread. Arming wakes every thread and
+ * parks it in a spin barrier; firing opens the barrier so all threads call
+ * SendCommand at once, instead of one after the other as a capturePhoto()
+ * loop would.
+ *
+ * The host time just before and just after every SendCommand is recorded, and
+ * the spread of those times across cameras (the skew) is kept per shot and
+ * summarized over the last shots.
+ */
+class ofxSonyCameraSyncTrigger {
+public:
+    /**
+     * @brief Host timestamps of one camera's release, in steady clock microseconds
+     */
+    struct CameraTiming {
+        CrError error = CrError_None;
+        uint64_t sendMicros = 0;   // just before SendCommand
+        uint64_t returnMicros = 0; // just after SendCommand returned
+    };
+
+    struct Shot {
+        uint64_t shotNumber = 0;
+        std::vector<CameraTiming> cameras; // in setup() order
+        uint64_t sendSkewMicros = 0;       // latest minus earliest send
+        uint64_t returnSkewMicros = 0;     // latest minus earliest return
+        size_t failed = 0;                 // cameras whose command failed
+    };
+
+    struct SkewStats {
+        uint64_t minMicros = 0;
+        uint64_t maxMicros = 0;
+        uint64_t avgMicros = 0;
+        uint64_t p99Micros = 0;
+    };
+
+    struct Stats {
+        uint64_t shots = 0;
+        uint64_t failedShots = 0; // shots where at least one camera failed
+        SkewStats send;           // over the last kHistorySize shots
+        SkewStats returned;
+    };
+
+    static constexpr size_t kHistorySize = 1000;
+
+    ofxSonyCameraSyncTrigger();
+    ~ofxSonyCameraSyncTrigger();
+
+    /**
+     * @brief Start one trigger thread per camera
+     *
+     * @param cameras The connected cameras to fire together
+     * @return false if the list is empty or contains a null camera
+     */
+    bool setup(const std::vector<ofxSonyCameraRemote*>& cameras);
+
+    /**
+     * @brief Stop the trigger threads
+     */
+    void close();
+
+    /**
+     * @brief Park every trigger thread in the spin barrier
+     *
+     * The threads busy-wait while armed, so arm shortly before firing. Blocks
+     * until every thread has reached the barrier.
+     */
+    void arm();
+
+    bool isArmed() const;
+
+    /**
+     * @brief Release all shutters at once
+     *
+     * Arms first if needed, and blocks until every camera's command returned.
+     *
+     * @return The timings of this shot
+     */
+    Shot fire();
+
+    size_t getNumCameras() const;
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    void threadedFunction(size_t index);
+
+    std::vector<ofxSonyCameraRemote*> mCameras;
+    std::vector<std::thread> mThreads;
+    std::vector<CameraTiming> mTimings; // written by thread i, read after mDone
+
+    std::atomic<bool> mRunning;
+    bool mArmed;
+    std::atomic<uint64_t> mArmGeneration;
+    std::atomic<uint64_t> mReleaseGeneration;
+    std::atomic<size_t> mArrived;
+    std::atomic<size_t> mDone;
+    std::mutex mArmMutex;
+    std::condition_variable mArmCondition;
+
+    uint64_t mShots;
+    uint64_t mFailedShots;
+    std::deque<uint64_t> mSendSkews;
+    std::deque<uint64_t> mReturnSkews;
+    mutable std::mutex mStatsMutex;
+};
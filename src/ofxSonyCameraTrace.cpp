@@ -0,0 +1,326 @@
+#include "ofxSonyCameraTrace.h"
+#include "ofMain.h"
+#include "ofxSonyCameraLog.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const char kMagic[8] = { 'O', 'F', 'X', 'S', 'C', 'T', 'R', 'C' };
+    const size_t kHeaderSize = 24;
+    const size_t kRecordHeaderSize = 14; // type, fields, size, time
+
+    // Which optional fields follow a record header
+    enum Field : uint8_t {
+        FIELD_DURATION = 1 << 0,
+        FIELD_CONNECTION = 1 << 1,
+        FIELD_RESULT = 1 << 2,
+        FIELD_ARGS = 1 << 3,
+        FIELD_CODES = 1 << 4,
+        FIELD_PROPERTIES = 1 << 5,
+        FIELD_TEXT = 1 << 6,
+        FIELD_CAMERAS = 1 << 7
+    };
+
+    template<typename T>
+    void put(std::vector<uint8_t>& buffer, T value) {
+        size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(T));
+        memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    void putString(std::vector<uint8_t>& buffer, const std::string& text) {
+        uint16_t length = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+        put(buffer, length);
+        buffer.insert(buffer.end(), text.begin(), text.begin() + length);
+    }
+
+    // Bounds-checked reads from one record; any overrun fails the rest
+    struct Reader {
+        const uint8_t* data;
+        size_t size;
+        size_t offset = 0;
+        bool ok = true;
+
+        template<typename T>
+        T get() {
+            T value = T();
+            if (!ok || size - offset < sizeof(T)) {
+                ok = false;
+                return value;
+            }
+            memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        std::string getString() {
+            uint16_t length = get<uint16_t>();
+            if (!ok || size - offset < length) {
+                ok = false;
+                return "";
+            }
+            std::string text(reinterpret_cast<const char*>(data + offset), length);
+            offset += length;
+            return text;
+        }
+
+        // A count of items of at least minSize bytes each, checked against what's left
+        uint32_t getCount(size_t minSize) {
+            uint32_t count = get<uint32_t>();
+            if (ok && count > (size - offset) / minSize) {
+                ok = false;
+                return 0;
+            }
+            return count;
+        }
+    };
+}
+
+ofxSonyCameraTrace::ofxSonyCameraTrace()
+    : mFile(nullptr)
+    , mStart(std::chrono::steady_clock::now())
+    , mNumRecords(0)
+    , mNumBytes(0) {
+}
+
+ofxSonyCameraTrace::~ofxSonyCameraTrace() {
+    close();
+}
+
+bool ofxSonyCameraTrace::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mFile) {
+        fclose(mFile);
+    }
+
+    mFile = fopen(path.c_str(), "wb");
+    if (!mFile) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraTrace", "Cannot write {}", path);
+        return false;
+    }
+    mStart = std::chrono::steady_clock::now();
+    mNumRecords = 0;
+
+    std::vector<uint8_t> header(kMagic, kMagic + sizeof(kMagic));
+    put<uint32_t>(header, kVersion);
+    put<uint32_t>(header, 0);
+    put<uint64_t>(header, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    fwrite(header.data(), 1, header.size(), mFile);
+    fflush(mFile);
+    mNumBytes = header.size();
+    return true;
+}
+
+void ofxSonyCameraTrace::close() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mFile) {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+bool ofxSonyCameraTrace::isOpen() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFile != nullptr;
+}
+
+void ofxSonyCameraTrace::write(const Record& record) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mFile) {
+        return;
+    }
+
+    uint8_t fields = 0;
+    fields |= record.durationMicros ? FIELD_DURATION : 0;
+    fields |= record.connection ? FIELD_CONNECTION : 0;
+    fields |= record.result ? FIELD_RESULT : 0;
+    fields |= (record.args[0] || record.args[1]) ? FIELD_ARGS : 0;
+    fields |= !record.codes.empty() ? FIELD_CODES : 0;
+    fields |= !record.properties.empty() ? FIELD_PROPERTIES : 0;
+    fields |= !record.text.empty() ? FIELD_TEXT : 0;
+    fields |= !record.cameras.empty() ? FIELD_CAMERAS : 0;
+
+    std::vector<uint8_t>& buffer = mBuffer;
+    buffer.clear();
+    put<uint8_t>(buffer, static_cast<uint8_t>(record.type));
+    put<uint8_t>(buffer, fields);
+    put<uint32_t>(buffer, 0); // size, filled in below
+    put<uint64_t>(buffer, record.timeMicros);
+
+    if (fields & FIELD_DURATION) {
+        put<uint32_t>(buffer, static_cast<uint32_t>(std::min<uint64_t>(record.durationMicros, UINT32_MAX)));
+    }
+    if (fields & FIELD_CONNECTION) {
+        put<uint32_t>(buffer, record.connection);
+    }
+    if (fields & FIELD_RESULT) {
+        put<uint32_t>(buffer, record.result);
+    }
+    if (fields & FIELD_ARGS) {
+        put<uint64_t>(buffer, record.args[0]);
+        put<uint64_t>(buffer, record.args[1]);
+    }
+    if (fields & FIELD_CODES) {
+        put<uint32_t>(buffer, static_cast<uint32_t>(record.codes.size()));
+        for (CrInt32u code : record.codes) {
+            put<uint32_t>(buffer, code);
+        }
+    }
+    if (fields & FIELD_PROPERTIES) {
+        put<uint32_t>(buffer, static_cast<uint32_t>(record.properties.size()));
+        for (const ofxSonyCameraBackend::Property& property : record.properties) {
+            put<uint32_t>(buffer, property.code);
+            put<uint32_t>(buffer, property.type);
+            put<uint64_t>(buffer, property.value);
+            put<uint8_t>(buffer, property.writable ? 1 : 0);
+            put<uint32_t>(buffer, static_cast<uint32_t>(property.possible.size()));
+            for (CrInt64u value : property.possible) {
+                put<uint64_t>(buffer, value);
+            }
+        }
+    }
+    if (fields & FIELD_TEXT) {
+        putString(buffer, record.text);
+    }
+    if (fields & FIELD_CAMERAS) {
+        put<uint32_t>(buffer, static_cast<uint32_t>(record.cameras.size()));
+        for (const ofxSonyCameraBackend::CameraInfo& camera : record.cameras) {
+            putString(buffer, camera.model);
+            putString(buffer, camera.id);
+        }
+    }
+
+    uint32_t size = static_cast<uint32_t>(buffer.size() - kRecordHeaderSize);
+    memcpy(buffer.data() + 2, &size, sizeof(size));
+
+    if (fwrite(buffer.data(), 1, buffer.size(), mFile) != buffer.size()) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraTrace", "Cannot append to the trace, closing it");
+        fclose(mFile);
+        mFile = nullptr;
+        return;
+    }
+    fflush(mFile);
+    mNumRecords++;
+    mNumBytes += buffer.size();
+}
+
+uint64_t ofxSonyCameraTrace::getMicros() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - mStart).count();
+}
+
+uint64_t ofxSonyCameraTrace::getNumRecords() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumRecords;
+}
+
+uint64_t ofxSonyCameraTrace::getNumBytes() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumBytes;
+}
+
+bool ofxSonyCameraTrace::load(const std::string& path, std::vector<Record>& records) {
+    records.clear();
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraTrace", "Cannot read {}", path);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+    fclose(file);
+
+    if (data.size() < kHeaderSize || memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraTrace", "{} is not a trace", path);
+        return false;
+    }
+    uint32_t version;
+    memcpy(&version, data.data() + sizeof(kMagic), sizeof(version));
+    if (version != kVersion) {
+        OFX_SONY_CAMERA_LOG_ERROR("ofxSonyCameraTrace", "{} has unsupported version {}", path, version);
+        return false;
+    }
+
+    size_t offset = kHeaderSize;
+    while (data.size() - offset >= kRecordHeaderSize) {
+        Reader header{ data.data() + offset, kRecordHeaderSize };
+        uint8_t type = header.get<uint8_t>();
+        uint8_t fields = header.get<uint8_t>();
+        uint32_t size = header.get<uint32_t>();
+        uint64_t time = header.get<uint64_t>();
+        if (data.size() - offset - kRecordHeaderSize < size) {
+            OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraTrace", "{} ends with a partial record", path);
+            break;
+        }
+
+        Reader reader{ data.data() + offset + kRecordHeaderSize, size };
+        offset += kRecordHeaderSize + size;
+
+        Record record;
+        record.type = static_cast<Record::Type>(type);
+        record.timeMicros = time;
+        if (fields & FIELD_DURATION) {
+            record.durationMicros = reader.get<uint32_t>();
+        }
+        if (fields & FIELD_CONNECTION) {
+            record.connection = reader.get<uint32_t>();
+        }
+        if (fields & FIELD_RESULT) {
+            record.result = reader.get<uint32_t>();
+        }
+        if (fields & FIELD_ARGS) {
+            record.args[0] = reader.get<uint64_t>();
+            record.args[1] = reader.get<uint64_t>();
+        }
+        if (fields & FIELD_CODES) {
+            uint32_t count = reader.getCount(sizeof(uint32_t));
+            for (uint32_t i = 0; i < count; i++) {
+                record.codes.push_back(reader.get<uint32_t>());
+            }
+        }
+        if (fields & FIELD_PROPERTIES) {
+            uint32_t count = reader.getCount(21);
+            record.properties.resize(count);
+            for (ofxSonyCameraBackend::Property& property : record.properties) {
+                property.code = reader.get<uint32_t>();
+                property.type = static_cast<SCRSDK::CrDataType>(reader.get<uint32_t>());
+                property.value = reader.get<uint64_t>();
+                property.writable = reader.get<uint8_t>() != 0;
+                uint32_t possible = reader.getCount(sizeof(uint64_t));
+                for (uint32_t i = 0; i < possible; i++) {
+                    property.possible.push_back(reader.get<uint64_t>());
+                }
+            }
+        }
+        if (fields & FIELD_TEXT) {
+            record.text = reader.getString();
+        }
+        if (fields & FIELD_CAMERAS) {
+            uint32_t count = reader.getCount(2 * sizeof(uint16_t));
+            record.cameras.resize(count);
+            for (ofxSonyCameraBackend::CameraInfo& camera : record.cameras) {
+                camera.model = reader.getString();
+                camera.id = reader.getString();
+            }
+        }
+
+        if (!reader.ok) {
+            OFX_SONY_CAMERA_LOG_WARNING("ofxSonyCameraTrace", "Skipping a malformed record in {}", path);
+            continue;
+        }
+        records.push_back(std::move(record));
+    }
+
+    // Calls are written when they return, after notifications that arrived
+    // meanwhile; order everything by when it happened
+    std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return a.timeMicros < b.timeMicros;
+    });
+    return true;
+}
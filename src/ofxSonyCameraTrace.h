@@ -0,0 +1,121 @@
+#pragma once
+
+#include "ofxSonyCameraBackend.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Append-only binary trace of SDK calls and camera notifications
+ *
+ * Written by ofxSonyCameraRecordingBackend and read back by
+ * ofxSonyCameraReplayBackend. The file starts with a 24-byte header (the
+ * magic "OFXSCTRC", a format version and the wall clock time the trace was
+ * opened, in microseconds since the epoch), followed by records of
+ *
+ *     u8 type, u8 fields, u32 size, u64 time, then `size` bytes of fields
+ *
+ * where `fields` flags which of the optional fields follow, so a record only
+ * takes the space its type needs. Integers are in host byte order. Each
+ * record is flushed as soon as it is written, so a trace survives the
+ * application crashing; a record cut short at the end is ignored on load.
+ */
+class ofxSonyCameraTrace {
+public:
+    /**
+     * @brief One SDK call or camera notification
+     */
+    struct Record {
+        enum Type {
+            // Calls, recorded when they return
+            TYPE_GET_SDK_VERSION = 1,
+            TYPE_ENUMERATE,
+            TYPE_CONNECT,
+            TYPE_DISCONNECT,
+            TYPE_RELEASE_DEVICE,
+            TYPE_SEND_COMMAND,
+            TYPE_GET_DEVICE_PROPERTIES,
+            TYPE_GET_SELECT_DEVICE_PROPERTIES,
+            TYPE_SET_DEVICE_PROPERTY,
+
+            // IDeviceCallback notifications
+            TYPE_CONNECTED = 64,
+            TYPE_DISCONNECTED,
+            TYPE_PROPERTY_CHANGED,
+            TYPE_PROPERTY_CHANGED_CODES,
+            TYPE_LV_PROPERTY_CHANGED,
+            TYPE_LV_PROPERTY_CHANGED_CODES,
+            TYPE_COMPLETE_DOWNLOAD,
+            TYPE_NOTIFY_CONTENTS_TRANSFER,
+            TYPE_WARNING,
+            TYPE_ERROR
+        };
+
+        Type type = TYPE_GET_SDK_VERSION;
+        uint64_t timeMicros = 0;     // since the trace was opened; when a call started
+        uint64_t durationMicros = 0; // calls only
+        uint32_t connection = 0;     // numbered per trace, from 1; 0 for calls without one
+        CrInt32u result = 0;         // what a call returned
+
+        // Command id and parameter, property code and value, or the values
+        // passed with a notification
+        CrInt64u args[2] = { 0, 0 };
+
+        std::vector<CrInt32u> codes;                            // asked for or notified
+        std::vector<ofxSonyCameraBackend::Property> properties; // returned by a call
+        std::vector<ofxSonyCameraBackend::CameraInfo> cameras;  // enumerated, without handles
+        std::string text;                                       // connected camera id or filename
+
+        bool isCall() const { return type < TYPE_CONNECTED; }
+    };
+
+    static constexpr uint32_t kVersion = 1;
+
+    ofxSonyCameraTrace();
+    ~ofxSonyCameraTrace();
+
+    ofxSonyCameraTrace(const ofxSonyCameraTrace&) = delete;
+    ofxSonyCameraTrace& operator=(const ofxSonyCameraTrace&) = delete;
+
+    /**
+     * @brief Start a trace, replacing any file at the path
+     *
+     * @return true if the file was created, false otherwise
+     */
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Append a record; safe to call from any thread
+     */
+    void write(const Record& record);
+
+    /**
+     * @brief Get the trace clock, in microseconds since open()
+     */
+    uint64_t getMicros() const;
+
+    uint64_t getNumRecords() const;
+    uint64_t getNumBytes() const;
+
+    /**
+     * @brief Read a trace
+     *
+     * @param path The trace file
+     * @param records Receives the records, sorted by time
+     * @return false if the file can't be read or isn't a trace
+     */
+    static bool load(const std::string& path, std::vector<Record>& records);
+
+private:
+    FILE* mFile;
+    std::chrono::steady_clock::time_point mStart;
+    uint64_t mNumRecords;
+    uint64_t mNumBytes;
+    std::vector<uint8_t> mBuffer; // reused for encoding, guarded by mMutex
+    mutable std::mutex mMutex;
+};
@@ -0,0 +1,145 @@
+#include "ofxSonyCameraValueTable.h"
+#include "ofxSonyCameraPropertyTraits.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    using namespace ofxSonyCameraProperty;
+
+    Packing getPacking(CrInt32u code) {
+        const Info* info = find(code);
+        return info ? info->packing : PACKING_ENUM;
+    }
+
+    bool usesLogScale(CrInt32u code) {
+        Packing packing = getPacking(code);
+        return packing == PACKING_ISO || packing == PACKING_FRACTION || packing == PACKING_HUNDREDTHS;
+    }
+
+    template<Packing P>
+    bool decode(CrInt64u value, double& quantity) {
+        if (!Codec<P>::isNumeric(value)) {
+            return false;
+        }
+        quantity = static_cast<double>(Codec<P>::decode(value));
+        return true;
+    }
+}
+
+ofxSonyCameraValueTable::ofxSonyCameraValueTable()
+    : mCode(0)
+    , mLogScale(false) {
+}
+
+ofxSonyCameraValueTable::ofxSonyCameraValueTable(CrInt32u code, const std::vector<CrInt64u>& values)
+    : mCode(code)
+    , mLogScale(usesLogScale(code)) {
+    mEntries.reserve(values.size());
+    for (CrInt64u value : values) {
+        double quantity;
+        if (toQuantity(code, value, quantity)) {
+            mEntries.push_back({ quantity, value });
+        }
+    }
+
+    std::sort(mEntries.begin(), mEntries.end(), [](const Entry& a, const Entry& b) {
+        return a.quantity < b.quantity || (a.quantity == b.quantity && a.value < b.value);
+    });
+    mEntries.erase(std::unique(mEntries.begin(), mEntries.end(), [](const Entry& a, const Entry& b) {
+        return a.value == b.value;
+    }), mEntries.end());
+}
+
+bool ofxSonyCameraValueTable::nearest(double quantity, CrInt64u& value) const {
+    if (mEntries.empty()) {
+        return false;
+    }
+    value = mEntries[nearestIndex(quantity)].value;
+    return true;
+}
+
+bool ofxSonyCameraValueTable::step(CrInt64u current, int steps, CrInt64u& value) const {
+    if (mEntries.empty()) {
+        return false;
+    }
+
+    size_t index;
+    auto it = std::find_if(mEntries.begin(), mEntries.end(), [current](const Entry& entry) {
+        return entry.value == current;
+    });
+    double quantity;
+    if (it != mEntries.end()) {
+        index = it - mEntries.begin();
+    } else if (toQuantity(mCode, current, quantity)) {
+        index = nearestIndex(quantity);
+    } else {
+        index = steps >= 0 ? 0 : mEntries.size() - 1;
+    }
+
+    long target = static_cast<long>(index) + steps;
+    target = std::max(0L, std::min(target, static_cast<long>(mEntries.size()) - 1));
+    value = mEntries[target].value;
+    return true;
+}
+
+bool ofxSonyCameraValueTable::contains(CrInt64u value) const {
+    return std::any_of(mEntries.begin(), mEntries.end(), [value](const Entry& entry) {
+        return entry.value == value;
+    });
+}
+
+CrInt32u ofxSonyCameraValueTable::getCode() const {
+    return mCode;
+}
+
+const std::vector<ofxSonyCameraValueTable::Entry>& ofxSonyCameraValueTable::getEntries() const {
+    return mEntries;
+}
+
+size_t ofxSonyCameraValueTable::size() const {
+    return mEntries.size();
+}
+
+bool ofxSonyCameraValueTable::empty() const {
+    return mEntries.empty();
+}
+
+bool ofxSonyCameraValueTable::toQuantity(CrInt32u code, CrInt64u value, double& quantity) {
+    switch (getPacking(code)) {
+        case PACKING_INTEGER:     return decode<PACKING_INTEGER>(value, quantity);
+        case PACKING_HUNDREDTHS:  return decode<PACKING_HUNDREDTHS>(value, quantity);
+        case PACKING_THOUSANDTHS: return decode<PACKING_THOUSANDTHS>(value, quantity);
+        case PACKING_FRACTION:    return decode<PACKING_FRACTION>(value, quantity);
+        case PACKING_ISO:         return decode<PACKING_ISO>(value, quantity);
+        case PACKING_KELVIN:      return decode<PACKING_KELVIN>(value, quantity);
+        case PACKING_PERCENT:     return decode<PACKING_PERCENT>(value, quantity);
+        case PACKING_ENUM:
+        default:                  return decode<PACKING_ENUM>(value, quantity);
+    }
+}
+
+size_t ofxSonyCameraValueTable::nearestIndex(double quantity) const {
+    auto it = std::lower_bound(mEntries.begin(), mEntries.end(), quantity, [](const Entry& entry, double q) {
+        return entry.quantity < q;
+    });
+    if (it == mEntries.begin()) {
+        return 0;
+    }
+    if (it == mEntries.end()) {
+        return mEntries.size() - 1;
+    }
+
+    // Closest of the two neighbours, in stops for exposure settings
+    size_t upper = it - mEntries.begin();
+    double below = mEntries[upper - 1].quantity;
+    double above = it->quantity;
+    double distanceBelow, distanceAbove;
+    if (mLogScale && quantity > 0) {
+        distanceBelow = std::log2(quantity / below);
+        distanceAbove = std::log2(above / quantity);
+    } else {
+        distanceBelow = quantity - below;
+        distanceAbove = above - quantity;
+    }
+    return distanceBelow <= distanceAbove ? upper - 1 : upper;
+}
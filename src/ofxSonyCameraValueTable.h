@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CrTypes.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief The values a camera accepts for one property, sorted for lookup
+ *
+ * Built from the possible-values list the camera reports with each property.
+ * Every encoded value is paired with the quantity it stands for (ISO number,
+ * exposure time in seconds, f-number) and the table is sorted by that
+ * quantity, so a requested quantity maps to the nearest legal encoding with a
+ * binary search and UIs can step through the values without asking the camera.
+ *
+ * Values are decoded with the property's ofxSonyCameraProperty::Codec, so
+ * exposure compensation is in EV and enumerations use their encoded value.
+ * ISO, shutter speed and aperture are compared in stops (log2). Special
+ * values such as ISO AUTO and BULB are left out of the table.
+ */
+class ofxSonyCameraValueTable {
+public:
+    struct Entry {
+        double quantity;
+        CrInt64u value;
+    };
+
+    ofxSonyCameraValueTable();
+
+    /**
+     * @brief Build a table from a property's possible values
+     *
+     * @param code The property code
+     * @param values The encoded values reported by the camera, in any order
+     */
+    ofxSonyCameraValueTable(CrInt32u code, const std::vector<CrInt64u>& values);
+
+    /**
+     * @brief Find the legal value closest to a quantity
+     *
+     * @param quantity The requested ISO number, seconds or f-number
+     * @param value Receives the encoded value
+     * @return false if the table is empty
+     */
+    bool nearest(double quantity, CrInt64u& value) const;
+
+    /**
+     * @brief Move a number of entries up or down from an encoded value
+     *
+     * Clamps at both ends of the table. A value missing from the table steps
+     * from its nearest entry.
+     *
+     * @param current The current encoded value
+     * @param steps Entries to move; positive for larger quantities
+     * @param value Receives the encoded value
+     * @return false if the table is empty
+     */
+    bool step(CrInt64u current, int steps, CrInt64u& value) const;
+
+    /**
+     * @brief Check if the camera accepts an encoded value
+     */
+    bool contains(CrInt64u value) const;
+
+    CrInt32u getCode() const;
+    const std::vector<Entry>& getEntries() const;
+    size_t size() const;
+    bool empty() const;
+
+    /**
+     * @brief Decode a value of a property into the quantity it stands for
+     *
+     * @return false for special values that have no quantity (AUTO, BULB...)
+     */
+    static bool toQuantity(CrInt32u code, CrInt64u value, double& quantity);
+
+private:
+    // Index of the entry closest to a quantity; the table must not be empty
+    size_t nearestIndex(double quantity) const;
+
+    CrInt32u mCode;
+    bool mLogScale;
+    std::vector<Entry> mEntries; // sorted by quantity
+};
@@ -0,0 +1,151 @@
+#include "ofxSonyCameraWriteQueue.h"
+
+ofxSonyCameraWriteQueue::ofxSonyCameraWriteQueue()
+    : mInFlightCount(0) {
+}
+
+void ofxSonyCameraWriteQueue::setSettings(const Settings& settings) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSettings = settings;
+    if (mSettings.maxInFlight == 0) {
+        mSettings.maxInFlight = 1;
+    }
+}
+
+ofxSonyCameraWriteQueue::Settings ofxSonyCameraWriteQueue::getSettings() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSettings;
+}
+
+void ofxSonyCameraWriteQueue::submit(CrInt32u code, CrInt64u value) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.submitted++;
+
+    Entry* entry = findEntry(code);
+    if (!entry) {
+        Entry newEntry;
+        newEntry.code = code;
+        newEntry.pendingValue = value;
+        newEntry.hasPending = true;
+        newEntry.inFlight = false;
+        mEntries.push_back(newEntry);
+        return;
+    }
+
+    // Latest wins: an unsent older value is simply overwritten
+    if (entry->hasPending) {
+        mStats.dropped++;
+    }
+    entry->pendingValue = value;
+    entry->hasPending = true;
+}
+
+size_t ofxSonyCameraWriteQueue::takeReady(std::vector<std::pair<CrInt32u, CrInt64u>>& ready) {
+    ready.clear();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    Clock::time_point now = Clock::now();
+    std::chrono::milliseconds timeout(mSettings.confirmTimeoutMs);
+
+    // Release writes the camera never confirmed, e.g. because the value
+    // did not actually change
+    for (auto& entry : mEntries) {
+        if (entry.inFlight && now - entry.sentTime >= timeout) {
+            releaseInFlight(entry);
+            mStats.timedOut++;
+        }
+    }
+
+    for (auto& entry : mEntries) {
+        if (mInFlightCount >= mSettings.maxInFlight) {
+            break;
+        }
+        if (!entry.hasPending || entry.inFlight) {
+            continue;
+        }
+
+        ready.push_back(std::make_pair(entry.code, entry.pendingValue));
+        entry.hasPending = false;
+        mStats.sent++;
+
+        if (mSettings.waitForConfirm) {
+            entry.inFlight = true;
+            entry.sentTime = now;
+            mInFlightCount++;
+        }
+    }
+
+    // Forget idle entries so the vector stays small
+    for (size_t i = mEntries.size(); i-- > 0;) {
+        if (!mEntries[i].hasPending && !mEntries[i].inFlight) {
+            mEntries.erase(mEntries.begin() + i);
+        }
+    }
+
+    return ready.size();
+}
+
+void ofxSonyCameraWriteQueue::fail(CrInt32u code) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.failed++;
+
+    Entry* entry = findEntry(code);
+    if (entry && entry->inFlight) {
+        releaseInFlight(*entry);
+    }
+}
+
+void ofxSonyCameraWriteQueue::confirm(CrInt32u num, const CrInt32u* codes) {
+    if (!codes) return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (CrInt32u i = 0; i < num; i++) {
+        Entry* entry = findEntry(codes[i]);
+        if (entry && entry->inFlight) {
+            releaseInFlight(*entry);
+            mStats.confirmed++;
+        }
+    }
+}
+
+bool ofxSonyCameraWriteQueue::isBusy(CrInt32u code) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& entry : mEntries) {
+        if (entry.code == code) {
+            return entry.hasPending || entry.inFlight;
+        }
+    }
+    return false;
+}
+
+void ofxSonyCameraWriteQueue::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+    mInFlightCount = 0;
+}
+
+ofxSonyCameraWriteQueue::Stats ofxSonyCameraWriteQueue::getStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void ofxSonyCameraWriteQueue::resetStats() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats = Stats();
+}
+
+ofxSonyCameraWriteQueue::Entry* ofxSonyCameraWriteQueue::findEntry(CrInt32u code) {
+    for (auto& entry : mEntries) {
+        if (entry.code == code) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void ofxSonyCameraWriteQueue::releaseInFlight(Entry& entry) {
+    entry.inFlight = false;
+    if (mInFlightCount > 0) {
+        mInFlightCount--;
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "../libs/CRSDK/include/CrTypes.h"
+#include <vector>
+#include <utility>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Coalescing latest-wins queue for property writes
+ *
+ * Each property code has at most one pending value: submitting a new value
+ * replaces an older one that has not been sent yet, so dragging a slider
+ * only sends the values the camera can keep up with.
+ *
+ * The queue does not talk to the camera itself. The owner submits values,
+ * takes the writes that are ready to go, sends them and reports back
+ * failures and confirmations (property change notifications). A write stays
+ * in flight until it is confirmed or times out, and no more than
+ * Settings::maxInFlight writes are in flight at once.
+ *
+ * All methods are thread-safe.
+ */
+class ofxSonyCameraWriteQueue {
+public:
+    struct Settings {
+        size_t maxInFlight = 4;          // writes sent but not yet confirmed
+        uint64_t confirmTimeoutMs = 500; // in-flight writes older than this are released
+        bool waitForConfirm = true;      // false releases a write as soon as it is sent
+    };
+
+    struct Stats {
+        uint64_t submitted = 0; // values passed to submit()
+        uint64_t dropped = 0;   // pending values replaced by a newer one
+        uint64_t sent = 0;      // writes handed out by takeReady()
+        uint64_t confirmed = 0; // in-flight writes confirmed by the camera
+        uint64_t timedOut = 0;  // in-flight writes released without confirmation
+        uint64_t failed = 0;    // writes the SDK rejected
+    };
+
+    ofxSonyCameraWriteQueue();
+
+    void setSettings(const Settings& settings);
+    Settings getSettings() const;
+
+    /**
+     * @brief Queue a value, replacing any unsent value for the same code
+     */
+    void submit(CrInt32u code, CrInt64u value);
+
+    /**
+     * @brief Move pending writes that may be sent now into flight
+     *
+     * @param ready Receives the code/value pairs the caller must send
+     * @return The number of writes returned
+     */
+    size_t takeReady(std::vector<std::pair<CrInt32u, CrInt64u>>& ready);
+
+    /**
+     * @brief Report that sending a write failed
+     */
+    void fail(CrInt32u code);
+
+    /**
+     * @brief Report property change notifications from the camera
+     *
+     * @param num Number of codes in the array
+     * @param codes The changed property codes
+     */
+    void confirm(CrInt32u num, const CrInt32u* codes);
+
+    /**
+     * @brief Check if a code has a write pending or in flight
+     */
+    bool isBusy(CrInt32u code) const;
+
+    /**
+     * @brief Drop every pending and in-flight write
+     */
+    void clear();
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        CrInt32u code;
+        CrInt64u pendingValue;
+        bool hasPending;
+        bool inFlight;
+        Clock::time_point sentTime;
+    };
+
+    // Must be called with mMutex held
+    Entry* findEntry(CrInt32u code);
+    void releaseInFlight(Entry& entry);
+
+    // Only a handful of properties are written at a time, so a flat
+    // vector beats any map here
+    std::vector<Entry> mEntries;
+    size_t mInFlightCount;
+
+    Settings mSettings;
+    Stats mStats;
+    mutable std::mutex mMutex;
+};